@@ -29,11 +29,26 @@
  * operations over time so as not to interrupt animations or interactivity.
  *
  * Operations added to the #MxActorManager will strictly be performed in the
- * order in which they were added.
+ * order in which they were added, unless their priority is changed with
+ * mx_actor_manager_set_operation_priority().
+ *
+ * Actor creation can be split in two phases with
+ * mx_actor_manager_create_actor_prepared(). Expensive preparation, such as
+ * loading images or parsing data, is then done on a worker thread and only
+ * the creation of the actor itself is done on the main thread.
+ *
+ * By default, the amount of time spent performing operations each frame
+ * adapts to the measured frame time of the stage, so that animations keep
+ * running at the default frame rate. Consecutive additions to the same
+ * container are performed in the same frame, even when that runs past the
+ * time slice, so that the container is not laid out again on every frame
+ * while its children trickle in.
  *
  * Since: 1.2
  */
 
+#include <string.h>
+
 #include "mx-actor-manager.h"
 #include "mx-enum-types.h"
 #include "mx-marshal.h"
@@ -53,7 +68,8 @@ enum
 
   PROP_STAGE,
   PROP_TIME_SLICE,
-  PROP_N_OPERATIONS
+  PROP_N_OPERATIONS,
+  PROP_ADAPTIVE_TIME_SLICE
 };
 
 enum
@@ -77,15 +93,47 @@ typedef enum
   MX_ACTOR_MANAGER_UNREF
 } MxActorManagerOperationType;
 
+/* The maximum number of consecutive additions to the same container that are
+ * performed together, regardless of the time slice */
+#define MX_ACTOR_MANAGER_MAX_BATCH 32
+
+/* The smallest the time slice will shrink to when frames are being dropped,
+ * in ms */
+#define MX_ACTOR_MANAGER_MIN_TIME_SLICE 1.0
+
+/* Shared between an operation and the worker thread preparing it */
+typedef struct
+{
+  volatile gint                ref_count;
+  GMutex                       lock;
+
+  MxActorManager              *manager;
+
+  MxActorManagerPrepareFunc    prepare_func;
+  gpointer                     userdata;
+  GDestroyNotify               destroy_func;
+
+  gpointer                     prepared;
+  GDestroyNotify               prepared_free;
+
+  guint                        complete  : 1;
+  guint                        cancelled : 1;
+} MxActorManagerPrepareData;
+
 typedef struct
 {
   MxActorManager              *manager;
   gulong                       id;
   MxActorManagerOperationType  type;
+  gint                         priority;
+  gint64                       queue_time;
 
   MxActorManagerCreateFunc     create_func;
   gpointer                     userdata;
 
+  MxActorManagerCreatePreparedFunc  create_prepared_func;
+  MxActorManagerPrepareData        *prepare_data;
+
   ClutterActor                *actor;
   ClutterActor                *container;
 } MxActorManagerOperation;
@@ -101,14 +149,26 @@ struct _MxActorManagerPrivate
 
   GTimer       *timer;
   guint         time_slice;
+  gdouble       current_time_slice;
+
+  gulong        next_id;
+
+  gint64        last_paint_time;
+  gdouble       frame_time;
+
+  MxActorManagerStats stats;
+  gdouble       total_latency;
 
   ClutterStage *stage;
 
   guint         quark_set   : 1;
+  guint         adaptive    : 1;
 };
 
 static guint signals[LAST_SIGNAL] = { 0, };
 
+static GThreadPool *mx_actor_manager_threads = NULL;
+
 static void mx_actor_manager_handle_op (MxActorManager *manager);
 
 static guint mx_actor_manager_increment_count (MxActorManager *manager,
@@ -142,6 +202,10 @@ mx_actor_manager_get_property (GObject    *object,
       g_value_set_uint (value, g_queue_get_length (priv->ops));
       break;
 
+    case PROP_ADAPTIVE_TIME_SLICE:
+      g_value_set_boolean (value, priv->adaptive);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -178,6 +242,11 @@ mx_actor_manager_set_property (GObject      *object,
       mx_actor_manager_set_time_slice (self, g_value_get_uint (value));
       break;
 
+    case PROP_ADAPTIVE_TIME_SLICE:
+      mx_actor_manager_set_adaptive_time_slice (self,
+                                                g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -280,6 +349,24 @@ mx_actor_manager_class_init (MxActorManagerClass *klass)
                              MX_PARAM_READABLE);
   g_object_class_install_property (object_class, PROP_N_OPERATIONS, pspec);
 
+  /**
+   * MxActorManager:adaptive-time-slice:
+   *
+   * Whether to adapt the amount of time spent performing operations to the
+   * measured frame time of the stage. When set, #MxActorManager:time-slice
+   * is the most time that will be spent per frame.
+   *
+   * Since: 2.0
+   */
+  pspec = g_param_spec_boolean ("adaptive-time-slice",
+                                "Adaptive time slice",
+                                "Whether to adapt the time slice to the "
+                                "measured frame time",
+                                TRUE,
+                                MX_PARAM_READWRITE);
+  g_object_class_install_property (object_class, PROP_ADAPTIVE_TIME_SLICE,
+                                   pspec);
+
   /**
    * MxActorManager::actor-created:
    * @manager: the object that received the signal
@@ -433,6 +520,9 @@ mx_actor_manager_init (MxActorManager *self)
   priv->actor_op_links = g_hash_table_new (NULL, NULL);
   priv->timer = g_timer_new ();
   priv->time_slice = 5;
+  priv->current_time_slice = priv->time_slice;
+  priv->adaptive = TRUE;
+  priv->next_id = 1;
 }
 
 /**
@@ -570,6 +660,128 @@ mx_actor_manager_container_destroyed (gpointer  data,
   op->container = NULL;
 }
 
+/* Inserts @op_link into @ops after all the operations with the same or a
+ * higher priority. The link itself is inserted, rather than its data, as
+ * links are referenced from actor_op_links.
+ */
+static void
+mx_actor_manager_insert_link (GQueue *ops,
+                              GList  *op_link)
+{
+  MxActorManagerOperation *op = op_link->data;
+  GList *sibling;
+
+  for (sibling = ops->tail; sibling; sibling = sibling->prev)
+    {
+      MxActorManagerOperation *sibling_op = sibling->data;
+
+      if (sibling_op->priority <= op->priority)
+        break;
+    }
+
+  if (sibling)
+    {
+      op_link->prev = sibling;
+      op_link->next = sibling->next;
+
+      if (sibling->next)
+        sibling->next->prev = op_link;
+      else
+        ops->tail = op_link;
+
+      sibling->next = op_link;
+    }
+  else
+    {
+      op_link->prev = NULL;
+      op_link->next = ops->head;
+
+      if (ops->head)
+        ops->head->prev = op_link;
+      else
+        ops->tail = op_link;
+
+      ops->head = op_link;
+    }
+
+  ops->length++;
+}
+
+static void
+mx_actor_manager_prepare_data_unref (MxActorManagerPrepareData *data)
+{
+  if (!g_atomic_int_dec_and_test (&data->ref_count))
+    return;
+
+  if (data->prepared && data->prepared_free)
+    data->prepared_free (data->prepared);
+
+  if (data->destroy_func)
+    data->destroy_func (data->userdata);
+
+  g_mutex_clear (&data->lock);
+  g_slice_free (MxActorManagerPrepareData, data);
+}
+
+static gboolean
+mx_actor_manager_prepared_cb (MxActorManagerPrepareData *data)
+{
+  /* Operations are only cancelled on the main thread, so the manager can't
+   * go away while this runs */
+  if (data->manager)
+    mx_actor_manager_ensure_processing (data->manager);
+
+  return FALSE;
+}
+
+static void
+mx_actor_manager_prepare_cb (gpointer task_data,
+                             gpointer user_data)
+{
+  MxActorManagerPrepareData *data = task_data;
+  gpointer prepared;
+  gboolean cancelled;
+
+  g_mutex_lock (&data->lock);
+  cancelled = data->cancelled;
+  g_mutex_unlock (&data->lock);
+
+  if (!cancelled)
+    {
+      prepared = data->prepare_func (data->userdata);
+
+      g_mutex_lock (&data->lock);
+      data->prepared = prepared;
+      data->complete = TRUE;
+      g_mutex_unlock (&data->lock);
+    }
+
+  /* wake up the manager, the idle keeps the reference of the worker on
+   * the data, so that the data is always freed on the main thread, where
+   * the destroy functions can use Clutter */
+  clutter_threads_add_idle_full (G_PRIORITY_HIGH,
+                                 (GSourceFunc) mx_actor_manager_prepared_cb,
+                                 data,
+                                 (GDestroyNotify)
+                                 mx_actor_manager_prepare_data_unref);
+}
+
+/* Whether the operation is still waiting for its data to be prepared */
+static gboolean
+mx_actor_manager_op_is_preparing (MxActorManagerOperation *op)
+{
+  gboolean complete;
+
+  if (!op->prepare_data)
+    return FALSE;
+
+  g_mutex_lock (&op->prepare_data->lock);
+  complete = op->prepare_data->complete;
+  g_mutex_unlock (&op->prepare_data->lock);
+
+  return !complete;
+}
+
 static MxActorManagerOperation *
 mx_actor_manager_op_new (MxActorManager              *manager,
                          MxActorManagerOperationType  type,
@@ -583,20 +795,21 @@ mx_actor_manager_op_new (MxActorManager              *manager,
   MxActorManagerOperation *op = g_slice_new0 (MxActorManagerOperation);
 
   op->manager = manager;
-
-  if (g_queue_peek_tail (priv->ops))
-    op->id = ((MxActorManagerOperation *)g_queue_peek_tail (priv->ops))->id + 1;
-  else
-    op->id = 1;
-
+  op->id = priv->next_id++;
   op->type = type;
+  op->priority = G_PRIORITY_DEFAULT;
+  op->queue_time = g_get_monotonic_time ();
   op->create_func = create_func;
   op->userdata = userdata;
   op->actor = actor;
   op->container = container;
 
-  g_queue_push_tail (priv->ops, op);
-  op_link = g_queue_peek_tail_link (priv->ops);
+  op_link = g_list_alloc ();
+  op_link->data = op;
+  mx_actor_manager_insert_link (priv->ops, op_link);
+
+  priv->stats.max_n_operations = MAX (priv->stats.max_n_operations,
+                                      g_queue_get_length (priv->ops));
 
   if (actor)
     {
@@ -647,6 +860,20 @@ mx_actor_manager_op_free (MxActorManager *manager,
                            op);
     }
 
+  if (op->prepare_data)
+    {
+      MxActorManagerPrepareData *data = op->prepare_data;
+
+      /* the worker thread may still be using the data, it will be freed by
+       * whichever side drops the last reference */
+      g_mutex_lock (&data->lock);
+      data->cancelled = TRUE;
+      data->manager = NULL;
+      g_mutex_unlock (&data->lock);
+
+      mx_actor_manager_prepare_data_unref (data);
+    }
+
   if (_remove)
     g_queue_delete_link (priv->ops, op_link);
 
@@ -658,6 +885,7 @@ mx_actor_manager_handle_op (MxActorManager *manager)
 {
   ClutterActor *actor;
   MxActorManagerOperation *op;
+  gdouble latency;
 
   GError *error = NULL;
   MxActorManagerPrivate *priv = manager->priv;
@@ -680,7 +908,17 @@ mx_actor_manager_handle_op (MxActorManager *manager)
   switch (op->type)
     {
     case MX_ACTOR_MANAGER_CREATE:
-      actor = op->create_func (manager, op->userdata);
+      if (op->prepare_data)
+        {
+          /* the creation function takes ownership of the prepared data */
+          gpointer prepared = op->prepare_data->prepared;
+
+          op->prepare_data->prepared = NULL;
+          actor = op->create_prepared_func (manager, prepared,
+                                            op->prepare_data->userdata);
+        }
+      else
+        actor = op->create_func (manager, op->userdata);
 
       if (CLUTTER_IS_ACTOR (actor))
         g_signal_emit (manager, signals[ACTOR_CREATED], 0,
@@ -759,6 +997,11 @@ mx_actor_manager_handle_op (MxActorManager *manager)
   else
     g_signal_emit (manager, signals[OP_COMPLETED], 0, op->id);
 
+  latency = (g_get_monotonic_time () - op->queue_time) / 1000.0;
+  priv->stats.n_processed++;
+  priv->stats.max_latency = MAX (priv->stats.max_latency, latency);
+  priv->total_latency += latency;
+
   if (op->actor)
     g_object_unref (op->actor);
 
@@ -768,22 +1011,76 @@ mx_actor_manager_handle_op (MxActorManager *manager)
   mx_actor_manager_op_free (manager, op_link, TRUE);
 }
 
+static void
+mx_actor_manager_update_time_slice (MxActorManager *manager)
+{
+  MxActorManagerPrivate *priv = manager->priv;
+  gdouble target;
+
+  if (!priv->adaptive)
+    {
+      priv->current_time_slice = priv->time_slice;
+      return;
+    }
+
+  target = 1000.0 / MAX (1, clutter_get_default_frame_rate ());
+
+  /* Halve the time slice when frames are being dropped and grow it back
+   * slowly while they aren't, up to the set time slice */
+  if (priv->frame_time > target * 1.2)
+    priv->current_time_slice = MAX (MX_ACTOR_MANAGER_MIN_TIME_SLICE,
+                                    priv->current_time_slice / 2.0);
+  else
+    priv->current_time_slice = MIN (priv->time_slice,
+                                    priv->current_time_slice + 0.5);
+}
+
 static void
 mx_actor_manager_post_paint_cb (ClutterActor   *stage,
                                 MxActorManager *manager)
 {
   MxActorManagerPrivate *priv = manager->priv;
+  gint64 now;
 
   g_signal_handler_disconnect (stage, priv->post_paint_handler);
   priv->post_paint_handler = 0;
 
+  /* Measure the time between the frames painted while there are operations
+   * pending, the time in-between includes our own time slice */
+  now = g_get_monotonic_time ();
+  if (priv->last_paint_time)
+    {
+      gdouble frame_time = (now - priv->last_paint_time) / 1000.0;
+
+      if (priv->frame_time > 0)
+        priv->frame_time = (priv->frame_time * 3.0 + frame_time) / 4.0;
+      else
+        priv->frame_time = frame_time;
+
+      mx_actor_manager_update_time_slice (manager);
+    }
+  priv->last_paint_time = now;
+
   mx_actor_manager_ensure_processing (manager);
 }
 
+/* Whether the operation at the head of the queue continues a batch of
+ * additions to @container */
+static gboolean
+mx_actor_manager_continues_batch (MxActorManager *manager,
+                                  ClutterActor   *container)
+{
+  MxActorManagerOperation *op = g_queue_peek_head (manager->priv->ops);
+
+  return (container && op && op->type == MX_ACTOR_MANAGER_ADD &&
+          op->container == container);
+}
+
 static gboolean
 mx_actor_manager_process_operations (MxActorManager *manager)
 {
   MxActorManagerPrivate *priv = manager->priv;
+  gint batch = 0;
 
   priv->source = 0;
 
@@ -791,16 +1088,43 @@ mx_actor_manager_process_operations (MxActorManager *manager)
 
   while (!g_queue_is_empty (priv->ops))
     {
+      MxActorManagerOperation *op = g_queue_peek_head (priv->ops);
+      ClutterActor *container;
+
+      /* Operations are performed in order, so wait for the data to be
+       * prepared; processing resumes once the worker thread is done */
+      if (mx_actor_manager_op_is_preparing (op))
+        {
+          g_timer_stop (priv->timer);
+          priv->last_paint_time = 0;
+          return FALSE;
+        }
+
+      /* only used for comparison, the operation is freed once handled */
+      container = (op->type == MX_ACTOR_MANAGER_ADD) ? op->container : NULL;
+
       mx_actor_manager_handle_op (manager);
 
+      if (mx_actor_manager_continues_batch (manager, container) &&
+          ++batch < MX_ACTOR_MANAGER_MAX_BATCH)
+        continue;
+
+      batch = 0;
+
       if (priv->stage &&
-          g_timer_elapsed (priv->timer, NULL) * 1000 >= priv->time_slice)
+          g_timer_elapsed (priv->timer, NULL) * 1000 >=
+          priv->current_time_slice)
         break;
     }
 
   g_timer_stop (priv->timer);
 
-  if (!g_queue_is_empty (priv->ops))
+  if (g_queue_is_empty (priv->ops))
+    {
+      /* don't count the time spent idle as frame time */
+      priv->last_paint_time = 0;
+    }
+  else
     {
       if (!priv->post_paint_handler)
         priv->post_paint_handler =
@@ -867,6 +1191,91 @@ mx_actor_manager_create_actor (MxActorManager           *manager,
   return op->id;
 }
 
+/**
+ * mx_actor_manager_create_actor_prepared:
+ * @manager: A #MxActorManager
+ * @prepare_func: A function to prepare the data for the actor, called on a
+ *   worker thread
+ * @create_func: A #ClutterActor creation function, called on the main
+ *   thread with the prepared data
+ * @userdata: data to be passed to the functions, or %NULL
+ * @destroy_func: callback to invoke before the operation is removed
+ * @prepared_free: callback to free the prepared data if the operation is
+ *   cancelled after it was prepared, or %NULL
+ *
+ * Creates a #ClutterActor in two phases. @prepare_func is called on a worker
+ * thread as soon as possible, and should do any expensive work that doesn't
+ * involve Clutter, such as decoding images, and return it as plain data.
+ * @create_func is then called on the main thread, in the order the
+ * operation was added, and creates the actor from the prepared data, of
+ * which it takes ownership.
+ *
+ * @prepare_func must not call any Clutter functions, and @userdata must be
+ * safe to use from another thread.
+ *
+ * On successful completion, the #MxActorManager::actor_created signal will
+ * be fired.
+ *
+ * Returns: The ID for this operation.
+ *
+ * Since: 2.0
+ */
+gulong
+mx_actor_manager_create_actor_prepared (MxActorManager                   *manager,
+                                        MxActorManagerPrepareFunc         prepare_func,
+                                        MxActorManagerCreatePreparedFunc  create_func,
+                                        gpointer                          userdata,
+                                        GDestroyNotify                    destroy_func,
+                                        GDestroyNotify                    prepared_free)
+{
+  MxActorManagerPrepareData *data;
+  MxActorManagerOperation *op;
+
+  g_return_val_if_fail (MX_IS_ACTOR_MANAGER (manager), 0);
+  g_return_val_if_fail (prepare_func != NULL, 0);
+  g_return_val_if_fail (create_func != NULL, 0);
+
+  if (!mx_actor_manager_threads)
+    {
+      mx_actor_manager_threads =
+        g_thread_pool_new (mx_actor_manager_prepare_cb, NULL,
+                           g_get_num_processors (),
+                           FALSE, NULL);
+
+      if (!mx_actor_manager_threads)
+        {
+          g_warning (G_STRLOC ": Unable to create worker threads");
+          return 0;
+        }
+    }
+
+  data = g_slice_new0 (MxActorManagerPrepareData);
+  g_mutex_init (&data->lock);
+  data->manager = manager;
+  data->prepare_func = prepare_func;
+  data->userdata = userdata;
+  data->destroy_func = destroy_func;
+  data->prepared_free = prepared_free;
+
+  /* one reference for the operation, one for the worker thread */
+  data->ref_count = 2;
+
+  op = mx_actor_manager_op_new (manager,
+                                MX_ACTOR_MANAGER_CREATE,
+                                NULL,
+                                userdata,
+                                NULL,
+                                NULL);
+  op->create_prepared_func = create_func;
+  op->prepare_data = data;
+
+  g_thread_pool_push (mx_actor_manager_threads, data, NULL);
+
+  mx_actor_manager_ensure_processing (manager);
+
+  return op->id;
+}
+
 /**
  * mx_actor_manager_add_actor:
  * @manager: A #MxActorManager
@@ -1103,7 +1512,9 @@ mx_actor_manager_cancel_operations (MxActorManager *manager,
  * @msecs: A time, in milliseconds
  *
  * Sets the amount of time the actor manager will spend performing operations,
- * before yielding to allow any necessary redrawing to occur.
+ * before yielding to allow any necessary redrawing to occur. If
+ * #MxActorManager:adaptive-time-slice is set, this is the most time that
+ * will be spent.
  *
  * Lower times will lead to smoother performance, but will increase the amount
  * of time it takes for operations to complete.
@@ -1123,6 +1534,7 @@ mx_actor_manager_set_time_slice (MxActorManager *manager,
   if (priv->time_slice != msecs)
     {
       priv->time_slice = msecs;
+      priv->current_time_slice = msecs;
       g_object_notify (G_OBJECT (manager), "time-slice");
     }
 }
@@ -1160,3 +1572,176 @@ mx_actor_manager_get_n_operations (MxActorManager *manager)
   g_return_val_if_fail (MX_IS_ACTOR_MANAGER (manager), 0);
   return g_queue_get_length (manager->priv->ops);
 }
+
+/**
+ * mx_actor_manager_set_adaptive_time_slice:
+ * @manager: A #MxActorManager
+ * @adaptive: %TRUE to adapt the time slice to the frame time
+ *
+ * Sets whether the amount of time spent performing operations each frame
+ * should adapt to the measured frame time of the stage. When the frame time
+ * exceeds that of the default frame rate, the time slice is reduced, and it
+ * grows back up to #MxActorManager:time-slice when it doesn't.
+ *
+ * Since: 2.0
+ */
+void
+mx_actor_manager_set_adaptive_time_slice (MxActorManager *manager,
+                                          gboolean        adaptive)
+{
+  MxActorManagerPrivate *priv;
+
+  g_return_if_fail (MX_IS_ACTOR_MANAGER (manager));
+
+  priv = manager->priv;
+
+  if (priv->adaptive != adaptive)
+    {
+      priv->adaptive = adaptive;
+      priv->current_time_slice = priv->time_slice;
+      g_object_notify (G_OBJECT (manager), "adaptive-time-slice");
+    }
+}
+
+/**
+ * mx_actor_manager_get_adaptive_time_slice:
+ * @manager: A #MxActorManager
+ *
+ * Retrieves whether the time slice adapts to the measured frame time.
+ *
+ * Returns: %TRUE if the time slice is adaptive
+ *
+ * Since: 2.0
+ */
+gboolean
+mx_actor_manager_get_adaptive_time_slice (MxActorManager *manager)
+{
+  g_return_val_if_fail (MX_IS_ACTOR_MANAGER (manager), FALSE);
+  return manager->priv->adaptive;
+}
+
+/**
+ * mx_actor_manager_set_operation_priority:
+ * @manager: A #MxActorManager
+ * @id: An operation ID
+ * @priority: The priority of the operation, lower values are performed first
+ *
+ * Sets the priority of the given operation. Operations are performed in
+ * order of priority, and in the order in which they were added within the
+ * same priority. Operations have a priority of %G_PRIORITY_DEFAULT when
+ * added.
+ *
+ * Since: 2.0
+ */
+void
+mx_actor_manager_set_operation_priority (MxActorManager *manager,
+                                         gulong          id,
+                                         gint            priority)
+{
+  GList *op_link;
+  MxActorManagerOperation *op;
+  MxActorManagerPrivate *priv;
+
+  g_return_if_fail (MX_IS_ACTOR_MANAGER (manager));
+  g_return_if_fail (id > 0);
+
+  priv = manager->priv;
+
+  op_link = g_queue_find_custom (priv->ops, &id, mx_actor_manager_find_by_id);
+
+  if (!op_link)
+    {
+      g_warning (G_STRLOC ": Unknown operation (%lu)", id);
+      return;
+    }
+
+  op = op_link->data;
+  if (op->priority == priority)
+    return;
+
+  g_queue_unlink (priv->ops, op_link);
+  op->priority = priority;
+  mx_actor_manager_insert_link (priv->ops, op_link);
+}
+
+/**
+ * mx_actor_manager_get_operation_priority:
+ * @manager: A #MxActorManager
+ * @id: An operation ID
+ *
+ * Retrieves the priority of the given operation.
+ *
+ * Returns: The priority of the operation
+ *
+ * Since: 2.0
+ */
+gint
+mx_actor_manager_get_operation_priority (MxActorManager *manager,
+                                         gulong          id)
+{
+  GList *op_link;
+
+  g_return_val_if_fail (MX_IS_ACTOR_MANAGER (manager), G_PRIORITY_DEFAULT);
+
+  op_link = g_queue_find_custom (manager->priv->ops, &id,
+                                 mx_actor_manager_find_by_id);
+
+  if (!op_link)
+    {
+      g_warning (G_STRLOC ": Unknown operation (%lu)", id);
+      return G_PRIORITY_DEFAULT;
+    }
+
+  return ((MxActorManagerOperation *) op_link->data)->priority;
+}
+
+/**
+ * mx_actor_manager_get_stats:
+ * @manager: A #MxActorManager
+ * @stats: (out): return location for the statistics
+ *
+ * Retrieves statistics about the operations performed by @manager since it
+ * was created, or since the last call to mx_actor_manager_reset_stats().
+ *
+ * Since: 2.0
+ */
+void
+mx_actor_manager_get_stats (MxActorManager      *manager,
+                            MxActorManagerStats *stats)
+{
+  MxActorManagerPrivate *priv;
+
+  g_return_if_fail (MX_IS_ACTOR_MANAGER (manager));
+  g_return_if_fail (stats != NULL);
+
+  priv = manager->priv;
+
+  *stats = priv->stats;
+  stats->n_operations = g_queue_get_length (priv->ops);
+  stats->mean_latency = (priv->stats.n_processed) ?
+    priv->total_latency / priv->stats.n_processed : 0;
+  stats->frame_time = priv->frame_time;
+  stats->time_slice = priv->current_time_slice;
+}
+
+/**
+ * mx_actor_manager_reset_stats:
+ * @manager: A #MxActorManager
+ *
+ * Resets the statistics returned by mx_actor_manager_get_stats().
+ *
+ * Since: 2.0
+ */
+void
+mx_actor_manager_reset_stats (MxActorManager *manager)
+{
+  MxActorManagerPrivate *priv;
+
+  g_return_if_fail (MX_IS_ACTOR_MANAGER (manager));
+
+  priv = manager->priv;
+
+  memset (&priv->stats, 0, sizeof (MxActorManagerStats));
+  priv->stats.max_n_operations = g_queue_get_length (priv->ops);
+  priv->total_latency = 0;
+}
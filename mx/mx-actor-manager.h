@@ -57,6 +57,35 @@ typedef struct _MxActorManagerPrivate MxActorManagerPrivate;
 typedef ClutterActor * (*MxActorManagerCreateFunc) (MxActorManager *manager,
                                                     gpointer        userdata);
 
+/**
+ * MxActorManagerPrepareFunc:
+ * @userdata: user data
+ *
+ * Prepares the data used to create an actor. This is called on a worker
+ * thread and must not use Clutter.
+ *
+ * Returns: the prepared data
+ *
+ * Since: 2.0
+ */
+typedef gpointer (*MxActorManagerPrepareFunc) (gpointer userdata);
+
+/**
+ * MxActorManagerCreatePreparedFunc:
+ * @manager: A #MxActorManager
+ * @prepared: the data returned by the #MxActorManagerPrepareFunc
+ * @userdata: user data
+ *
+ * Creates an actor from prepared data, taking ownership of it.
+ *
+ * Returns: the new #ClutterActor
+ *
+ * Since: 2.0
+ */
+typedef ClutterActor * (*MxActorManagerCreatePreparedFunc) (MxActorManager *manager,
+                                                            gpointer        prepared,
+                                                            gpointer        userdata);
+
 typedef enum
 {
   MX_ACTOR_MANAGER_CONTAINER_DESTROYED,
@@ -65,6 +94,34 @@ typedef enum
   MX_ACTOR_MANAGER_UNKNOWN_OPERATION
 } MxActorManagerError;
 
+/**
+ * MxActorManagerStats:
+ * @n_operations: the number of operations in the queue
+ * @max_n_operations: the largest number of operations that have been queued
+ * @n_processed: the number of operations performed
+ * @mean_latency: the mean time between an operation being queued and
+ *   performed, in milliseconds
+ * @max_latency: the longest time between an operation being queued and
+ *   performed, in milliseconds
+ * @frame_time: the measured frame time while operations are pending, in
+ *   milliseconds
+ * @time_slice: the current time slice, in milliseconds
+ *
+ * Statistics about the operations performed by an #MxActorManager.
+ *
+ * Since: 2.0
+ */
+typedef struct
+{
+  guint   n_operations;
+  guint   max_n_operations;
+  guint   n_processed;
+  gdouble mean_latency;
+  gdouble max_latency;
+  gdouble frame_time;
+  gdouble time_slice;
+} MxActorManagerStats;
+
 struct _MxActorManager
 {
   GObject parent;
@@ -121,6 +178,13 @@ gulong mx_actor_manager_create_actor (MxActorManager           *manager,
                                       gpointer                  userdata,
                                       GDestroyNotify            destroy_func);
 
+gulong mx_actor_manager_create_actor_prepared (MxActorManager                   *manager,
+                                               MxActorManagerPrepareFunc         prepare_func,
+                                               MxActorManagerCreatePreparedFunc  create_func,
+                                               gpointer                          userdata,
+                                               GDestroyNotify                    destroy_func,
+                                               GDestroyNotify                    prepared_free);
+
 gulong mx_actor_manager_add_actor (MxActorManager *manager,
                                    ClutterActor   *container,
                                    ClutterActor   *actor);
@@ -144,6 +208,20 @@ guint mx_actor_manager_get_time_slice (MxActorManager *manager);
 
 guint mx_actor_manager_get_n_operations (MxActorManager *manager);
 
+void     mx_actor_manager_set_adaptive_time_slice (MxActorManager *manager,
+                                                   gboolean        adaptive);
+gboolean mx_actor_manager_get_adaptive_time_slice (MxActorManager *manager);
+
+void mx_actor_manager_set_operation_priority (MxActorManager *manager,
+                                              gulong          id,
+                                              gint            priority);
+gint mx_actor_manager_get_operation_priority (MxActorManager *manager,
+                                              gulong          id);
+
+void mx_actor_manager_get_stats   (MxActorManager      *manager,
+                                   MxActorManagerStats *stats);
+void mx_actor_manager_reset_stats (MxActorManager      *manager);
+
 G_END_DECLS
 
 #endif /* _MX_ACTOR_MANAGER_H */
@@ -62,14 +62,10 @@ struct _MxAdjustmentPrivate
   gdouble  page_increment;
   gdouble  page_size;
 
-  /* For signal emission/notification */
-  guint lower_source;
-  guint upper_source;
-  guint value_source;
-  guint step_inc_source;
-  guint page_inc_source;
-  guint page_size_source;
-  guint changed_source;
+  /* For signal emission/notification, see mx_adjustment_queue_flush() */
+  guint dirty;
+  guint flush_repaint_id;
+  guint flush_idle_id;
 
   /* For interpolation */
   ClutterTimeline *interpolation;
@@ -103,6 +99,19 @@ enum
 
 static guint signals[LAST_SIGNAL] = { 0, };
 
+/* The notifications, and the "changed" emission, waiting for the next
+ * flush */
+typedef enum
+{
+  MX_ADJUSTMENT_DIRTY_VALUE     = 1 << 0,
+  MX_ADJUSTMENT_DIRTY_LOWER     = 1 << 1,
+  MX_ADJUSTMENT_DIRTY_UPPER     = 1 << 2,
+  MX_ADJUSTMENT_DIRTY_STEP_INC  = 1 << 3,
+  MX_ADJUSTMENT_DIRTY_PAGE_INC  = 1 << 4,
+  MX_ADJUSTMENT_DIRTY_PAGE_SIZE = 1 << 5,
+  MX_ADJUSTMENT_DIRTY_CHANGED   = 1 << 6
+} MxAdjustmentDirty;
+
 static gboolean _mx_adjustment_set_lower          (MxAdjustment *adjustment,
                                                    gdouble       lower);
 static gboolean _mx_adjustment_set_upper          (MxAdjustment *adjustment,
@@ -118,6 +127,9 @@ static void mx_adjustment_clamp_page (MxAdjustment *adjustment,
                                       gdouble       upper);
 
 static void mx_adjustment_emit_changed (MxAdjustment *adjustment);
+static void mx_adjustment_queue_flush  (MxAdjustment *adjustment,
+                                        guint         dirty);
+static void mx_adjustment_remove_flush (MxAdjustment *adjustment);
 
 static void
 mx_adjustment_constructed (GObject *object)
@@ -247,16 +259,6 @@ stop_interpolation (MxAdjustment *adjustment)
     }
 }
 
-static void
-mx_adjustment_remove_idle (guint *source)
-{
-  if (*source)
-    {
-      g_source_remove (*source);
-      *source = 0;
-    }
-}
-
 static void
 mx_adjustment_dispose (GObject *object)
 {
@@ -264,14 +266,9 @@ mx_adjustment_dispose (GObject *object)
 
   stop_interpolation (MX_ADJUSTMENT (object));
 
-  /* Remove idle handlers */
-  mx_adjustment_remove_idle (&priv->value_source);
-  mx_adjustment_remove_idle (&priv->lower_source);
-  mx_adjustment_remove_idle (&priv->upper_source);
-  mx_adjustment_remove_idle (&priv->page_inc_source);
-  mx_adjustment_remove_idle (&priv->step_inc_source);
-  mx_adjustment_remove_idle (&priv->page_size_source);
-  mx_adjustment_remove_idle (&priv->changed_source);
+  /* Drop any pending notifications */
+  mx_adjustment_remove_flush (MX_ADJUSTMENT (object));
+  priv->dirty = 0;
 
   G_OBJECT_CLASS (mx_adjustment_parent_class)->dispose (object);
 }
@@ -387,8 +384,10 @@ mx_adjustment_class_init (MxAdjustmentClass *klass)
   /**
    * MxAdjustment::changed:
    *
-   * Emitted when any of the adjustment values have changed at the
-   * next iteration of the GLib mainloop.
+   * Emitted when any of the adjustment values have changed, at most once
+   * per frame and before the stage is laid out. The notifications for the
+   * properties that changed, other than #MxAdjustment:value when it is
+   * set directly, are sent just before.
    */
   signals[CHANGED] =
     g_signal_new ("changed",
@@ -487,82 +486,114 @@ mx_adjustment_get_value (MxAdjustment *adjustment)
   return priv->value;
 }
 
-static gboolean
-mx_adjustment_value_notify_cb (MxAdjustment *adjustment)
+static void
+mx_adjustment_remove_flush (MxAdjustment *adjustment)
 {
   MxAdjustmentPrivate *priv = adjustment->priv;
 
-  priv->value_source = 0;
-
-  g_object_notify (G_OBJECT (adjustment), "value");
+  if (priv->flush_repaint_id)
+    {
+      clutter_threads_remove_repaint_func (priv->flush_repaint_id);
+      priv->flush_repaint_id = 0;
+    }
 
-  return FALSE;
+  if (priv->flush_idle_id)
+    {
+      g_source_remove (priv->flush_idle_id);
+      priv->flush_idle_id = 0;
+    }
 }
 
-static gboolean
-mx_adjustment_lower_notify_cb (MxAdjustment *adjustment)
+static void
+mx_adjustment_flush (MxAdjustment *adjustment)
 {
   MxAdjustmentPrivate *priv = adjustment->priv;
+  GObject *object = G_OBJECT (adjustment);
+  guint dirty;
 
-  priv->lower_source = 0;
-  g_object_notify (G_OBJECT (adjustment), "lower");
+  mx_adjustment_remove_flush (adjustment);
 
-  return FALSE;
-}
+  dirty = priv->dirty;
+  priv->dirty = 0;
 
-static gboolean
-mx_adjustment_upper_notify_cb (MxAdjustment *adjustment)
-{
-  MxAdjustmentPrivate *priv = adjustment->priv;
+  if (!dirty)
+    return;
 
-  priv->upper_source = 0;
-  g_object_notify (G_OBJECT (adjustment), "upper");
+  g_object_ref (adjustment);
 
-  return FALSE;
-}
+  g_object_freeze_notify (object);
 
-static gboolean
-mx_adjustment_step_inc_notify_cb (MxAdjustment *adjustment)
-{
-  MxAdjustmentPrivate *priv = adjustment->priv;
+  if (dirty & MX_ADJUSTMENT_DIRTY_LOWER)
+    g_object_notify (object, "lower");
+  if (dirty & MX_ADJUSTMENT_DIRTY_UPPER)
+    g_object_notify (object, "upper");
+  if (dirty & MX_ADJUSTMENT_DIRTY_VALUE)
+    g_object_notify (object, "value");
+  if (dirty & MX_ADJUSTMENT_DIRTY_STEP_INC)
+    g_object_notify (object, "step-increment");
+  if (dirty & MX_ADJUSTMENT_DIRTY_PAGE_INC)
+    g_object_notify (object, "page-increment");
+  if (dirty & MX_ADJUSTMENT_DIRTY_PAGE_SIZE)
+    g_object_notify (object, "page-size");
 
-  priv->step_inc_source = 0;
-  g_object_notify (G_OBJECT (adjustment), "step-increment");
+  g_object_thaw_notify (object);
 
-  return FALSE;
+  if (dirty & MX_ADJUSTMENT_DIRTY_CHANGED)
+    g_signal_emit (adjustment, signals[CHANGED], 0);
+
+  g_object_unref (adjustment);
 }
 
 static gboolean
-mx_adjustment_page_inc_notify_cb (MxAdjustment *adjustment)
+mx_adjustment_flush_repaint_cb (gpointer data)
 {
-  MxAdjustmentPrivate *priv = adjustment->priv;
+  MxAdjustment *adjustment = data;
 
-  priv->page_inc_source = 0;
-  g_object_notify (G_OBJECT (adjustment), "page-increment");
+  /* the repaint function is removed by returning FALSE */
+  adjustment->priv->flush_repaint_id = 0;
+  mx_adjustment_flush (adjustment);
 
   return FALSE;
 }
 
 static gboolean
-mx_adjustment_page_size_notify_cb (MxAdjustment *adjustment)
+mx_adjustment_flush_idle_cb (gpointer data)
 {
-  MxAdjustmentPrivate *priv = adjustment->priv;
+  MxAdjustment *adjustment = data;
 
-  priv->page_size_source = 0;
-  g_object_notify (G_OBJECT (adjustment), "page-size");
+  adjustment->priv->flush_idle_id = 0;
+  mx_adjustment_flush (adjustment);
 
   return FALSE;
 }
 
-static gboolean
-mx_adjustment_emit_changed_cb (MxAdjustment *adjustment)
+/* Marks @dirty as needing to be notified. All the pending notifications
+ * are sent together, followed by a single "changed" emission, once per
+ * frame: from a pre-paint repaint function, so that listeners see the
+ * values set by timelines and events before the stage is laid out, or
+ * from an idle when no frame is scheduled.
+ */
+static void
+mx_adjustment_queue_flush (MxAdjustment *adjustment,
+                           guint         dirty)
 {
   MxAdjustmentPrivate *priv = adjustment->priv;
 
-  priv->changed_source = 0;
-  g_signal_emit (adjustment, signals[CHANGED], 0);
+  priv->dirty |= dirty;
 
-  return FALSE;
+  if (!priv->flush_repaint_id)
+    priv->flush_repaint_id =
+      clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_PRE_PAINT,
+                                             mx_adjustment_flush_repaint_cb,
+                                             adjustment,
+                                             NULL);
+
+  if (!priv->flush_idle_id)
+    priv->flush_idle_id =
+      g_idle_add_full (CLUTTER_PRIORITY_REDRAW,
+                       mx_adjustment_flush_idle_cb,
+                       adjustment,
+                       NULL);
 }
 
 /**
@@ -632,27 +663,16 @@ mx_adjustment_clamp_page (MxAdjustment *adjustment,
       changed = TRUE;
     }
 
-  if (changed && !priv->value_source)
-    priv->value_source =
-      g_idle_add_full (CLUTTER_PRIORITY_REDRAW,
-                       (GSourceFunc)mx_adjustment_value_notify_cb,
-                       adjustment,
-                       NULL);
+  if (changed)
+    mx_adjustment_queue_flush (adjustment, MX_ADJUSTMENT_DIRTY_VALUE);
 }
 
 static void
 mx_adjustment_emit_changed (MxAdjustment *adjustment)
 {
-  MxAdjustmentPrivate *priv = adjustment->priv;
-
   g_signal_emit (adjustment, signals[CHANGED_IMMEDIATE], 0);
 
-  if (!priv->changed_source)
-    priv->changed_source =
-      g_idle_add_full (CLUTTER_PRIORITY_REDRAW,
-                       (GSourceFunc)mx_adjustment_emit_changed_cb,
-                       adjustment,
-                       NULL);
+  mx_adjustment_queue_flush (adjustment, MX_ADJUSTMENT_DIRTY_CHANGED);
 }
 
 static gboolean
@@ -667,12 +687,7 @@ _mx_adjustment_set_lower (MxAdjustment *adjustment,
 
       mx_adjustment_emit_changed (adjustment);
 
-      if (!priv->lower_source)
-        priv->lower_source =
-          g_idle_add_full (CLUTTER_PRIORITY_REDRAW,
-                           (GSourceFunc)mx_adjustment_lower_notify_cb,
-                           adjustment,
-                           NULL);
+      mx_adjustment_queue_flush (adjustment, MX_ADJUSTMENT_DIRTY_LOWER);
 
       /* Defer clamp until after construction. */
       if (!priv->is_constructing && priv->clamp_value)
@@ -726,12 +741,7 @@ _mx_adjustment_set_upper (MxAdjustment *adjustment,
 
       mx_adjustment_emit_changed (adjustment);
 
-      if (!priv->upper_source)
-        priv->upper_source =
-          g_idle_add_full (CLUTTER_PRIORITY_REDRAW,
-                           (GSourceFunc)mx_adjustment_upper_notify_cb,
-                           adjustment,
-                           NULL);
+      mx_adjustment_queue_flush (adjustment, MX_ADJUSTMENT_DIRTY_UPPER);
 
       /* Defer clamp until after construction. */
       if (!priv->is_constructing && priv->clamp_value)
@@ -785,12 +795,7 @@ _mx_adjustment_set_step_increment (MxAdjustment *adjustment,
 
       mx_adjustment_emit_changed (adjustment);
 
-      if (!priv->step_inc_source)
-        priv->step_inc_source =
-          g_idle_add_full (CLUTTER_PRIORITY_REDRAW,
-                           (GSourceFunc)mx_adjustment_step_inc_notify_cb,
-                           adjustment,
-                           NULL);
+      mx_adjustment_queue_flush (adjustment, MX_ADJUSTMENT_DIRTY_STEP_INC);
 
       return TRUE;
     }
@@ -840,12 +845,7 @@ _mx_adjustment_set_page_increment (MxAdjustment *adjustment,
 
       mx_adjustment_emit_changed (adjustment);
 
-      if (!priv->page_inc_source)
-        priv->page_inc_source =
-          g_idle_add_full (CLUTTER_PRIORITY_REDRAW,
-                           (GSourceFunc)mx_adjustment_page_inc_notify_cb,
-                           adjustment,
-                           NULL);
+      mx_adjustment_queue_flush (adjustment, MX_ADJUSTMENT_DIRTY_PAGE_INC);
 
       return TRUE;
     }
@@ -895,12 +895,7 @@ _mx_adjustment_set_page_size (MxAdjustment *adjustment,
 
       mx_adjustment_emit_changed (adjustment);
 
-      if (!priv->page_size_source)
-        priv->page_size_source =
-          g_idle_add_full (CLUTTER_PRIORITY_REDRAW,
-                           (GSourceFunc)mx_adjustment_page_size_notify_cb,
-                           adjustment,
-                           NULL);
+      mx_adjustment_queue_flush (adjustment, MX_ADJUSTMENT_DIRTY_PAGE_SIZE);
 
       /* Well explicitely clamp after construction. */
       if (!priv->is_constructing && priv->clamp_value)
@@ -0,0 +1,447 @@
+/*
+ * mx-background-painter.c: Shader based painting of widget backgrounds
+ *
+ * Copyright 2012 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/*
+ * This is private to MX
+ *
+ * Paints the "border-radius", "border-width", "border-color" and
+ * "-mx-background-gradient" style of a widget with a single rectangle.
+ * All painters derive their pipeline from one template holding the
+ * shader snippets, so they share the same GLSL program and only differ in
+ * their uniform values, which are only uploaded when the style or the size
+ * of the widget changes.
+ *
+ * When GLSL isn't available, the gradient and the border are painted with
+ * plain geometry and the corners are left square.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#define COGL_ENABLE_EXPERIMENTAL_API
+
+#include "mx-background-painter.h"
+#include "mx-private.h"
+
+struct _MxBackgroundPainter
+{
+  CoglHandle   pipeline;
+
+  ClutterColor start_color;
+  ClutterColor end_color;
+  gboolean     horizontal;
+  gfloat       radius;
+  gfloat       border_width;
+  ClutterColor border_color;
+
+  /* the size and opacity last uploaded to the pipeline */
+  gfloat       width;
+  gfloat       height;
+  gint         opacity;
+};
+
+enum
+{
+  UNIFORM_SIZE,
+  UNIFORM_RADIUS,
+  UNIFORM_BORDER_WIDTH,
+  UNIFORM_BORDER_COLOR,
+  UNIFORM_START_COLOR,
+  UNIFORM_END_COLOR,
+  UNIFORM_DIRECTION,
+  UNIFORM_OPACITY,
+
+  N_UNIFORMS
+};
+
+static const gchar *uniform_names[N_UNIFORMS] =
+{
+  "mx_size",
+  "mx_radius",
+  "mx_border_width",
+  "mx_border_color",
+  "mx_start_color",
+  "mx_end_color",
+  "mx_direction",
+  "mx_opacity"
+};
+
+static const gchar fragment_declarations[] =
+  "uniform vec2 mx_size;\n"
+  "uniform float mx_radius;\n"
+  "uniform float mx_border_width;\n"
+  "uniform vec4 mx_border_color;\n"
+  "uniform vec4 mx_start_color;\n"
+  "uniform vec4 mx_end_color;\n"
+  "uniform vec2 mx_direction;\n"
+  "uniform float mx_opacity;\n";
+
+/* signed distance from the rounded rectangle outline, negative inside */
+static const gchar fragment_post[] =
+  "vec2 mx_position = cogl_tex_coord_in[0].st * mx_size;\n"
+  "vec2 half_size = mx_size * 0.5;\n"
+  "float radius = min (mx_radius, min (half_size.x, half_size.y));\n"
+  "vec2 q = abs (mx_position - half_size) - (half_size - vec2 (radius));\n"
+  "float dist = length (max (q, 0.0)) + min (max (q.x, q.y), 0.0) - radius;\n"
+  "float t = clamp (dot (mx_position / mx_size, mx_direction), 0.0, 1.0);\n"
+  "vec4 color = mix (mx_start_color, mx_end_color, t);\n"
+  "if (mx_border_width > 0.0)\n"
+  "  color = mix (color, mx_border_color,\n"
+  "               clamp (dist + mx_border_width + 0.5, 0.0, 1.0));\n"
+  "float alpha = color.a * clamp (0.5 - dist, 0.0, 1.0) * mx_opacity;\n"
+  "cogl_color_out = vec4 (color.rgb * alpha, alpha);\n";
+
+static CoglHandle template_pipeline = COGL_INVALID_HANDLE;
+static gint uniform_locations[N_UNIFORMS];
+
+static CoglHandle
+mx_background_painter_get_template (void)
+{
+  static gboolean initialized = FALSE;
+  static const guint8 white[4] = { 0xff, 0xff, 0xff, 0xff };
+  CoglSnippet *snippet;
+  CoglHandle texture;
+  gint i;
+
+  if (initialized)
+    return template_pipeline;
+
+  initialized = TRUE;
+
+  if (!clutter_feature_available (CLUTTER_FEATURE_SHADERS_GLSL))
+    return COGL_INVALID_HANDLE;
+
+  template_pipeline = cogl_material_new ();
+
+  /* The journal transforms the vertices on the CPU, so the position seen
+   * by the shader isn't in widget coordinates. The position is derived
+   * from the texture coordinates of a layer instead, whose texture is never
+   * sampled by the fragment snippet. */
+  texture = cogl_texture_new_from_data (1, 1, COGL_TEXTURE_NO_SLICING,
+                                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                        COGL_PIXEL_FORMAT_ANY,
+                                        4, white);
+  cogl_material_set_layer (template_pipeline, 0, texture);
+  cogl_handle_unref (texture);
+
+  snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT,
+                              fragment_declarations,
+                              fragment_post);
+  cogl_pipeline_add_snippet (template_pipeline, snippet);
+  cogl_handle_unref (snippet);
+
+  for (i = 0; i < N_UNIFORMS; i++)
+    uniform_locations[i] =
+      cogl_pipeline_get_uniform_location (template_pipeline,
+                                          uniform_names[i]);
+
+  return template_pipeline;
+}
+
+static void
+mx_background_painter_set_color_uniform (MxBackgroundPainter *painter,
+                                         gint                 uniform,
+                                         const ClutterColor  *color)
+{
+  gfloat value[4];
+
+  value[0] = color->red / 255.f;
+  value[1] = color->green / 255.f;
+  value[2] = color->blue / 255.f;
+  value[3] = color->alpha / 255.f;
+
+  cogl_pipeline_set_uniform_float (painter->pipeline,
+                                   uniform_locations[uniform],
+                                   4, 1, value);
+}
+
+static void
+mx_background_painter_update_style (MxBackgroundPainter *painter)
+{
+  gfloat direction[2];
+
+  if (!painter->pipeline)
+    return;
+
+  direction[0] = painter->horizontal ? 1.f : 0.f;
+  direction[1] = painter->horizontal ? 0.f : 1.f;
+
+  cogl_pipeline_set_uniform_1f (painter->pipeline,
+                                uniform_locations[UNIFORM_RADIUS],
+                                painter->radius);
+  cogl_pipeline_set_uniform_1f (painter->pipeline,
+                                uniform_locations[UNIFORM_BORDER_WIDTH],
+                                painter->border_width);
+  cogl_pipeline_set_uniform_float (painter->pipeline,
+                                   uniform_locations[UNIFORM_DIRECTION],
+                                   2, 1, direction);
+
+  mx_background_painter_set_color_uniform (painter, UNIFORM_BORDER_COLOR,
+                                           &painter->border_color);
+  mx_background_painter_set_color_uniform (painter, UNIFORM_START_COLOR,
+                                           &painter->start_color);
+  mx_background_painter_set_color_uniform (painter, UNIFORM_END_COLOR,
+                                           &painter->end_color);
+}
+
+/* Parses "linear-gradient([[to] <side>,] <color>, <color>)", where <side>
+ * is one of top, bottom, left or right. Without "to", <side> is the side
+ * the gradient starts from, as in the earlier drafts of the specification.
+ */
+static gboolean
+mx_background_parse_gradient (const gchar  *str,
+                              ClutterColor *start,
+                              ClutterColor *end,
+                              gboolean     *horizontal)
+{
+  const gchar *p, *arg_start;
+  gchar *args[3];
+  gint n_args = 0, depth = 0, i;
+  gboolean to_side = TRUE, reverse = FALSE, success = FALSE;
+  const gchar *side = "bottom";
+  gsize len;
+
+  if (!g_str_has_prefix (str, "linear-gradient("))
+    return FALSE;
+
+  len = strlen (str);
+  if (str[len - 1] != ')')
+    return FALSE;
+
+  /* split the arguments on the commas that aren't nested in a colour */
+  arg_start = str + strlen ("linear-gradient(");
+  for (p = arg_start; p < str + len - 1; p++)
+    {
+      if (*p == '(')
+        depth++;
+      else if (*p == ')')
+        depth--;
+      else if (*p == ',' && depth == 0)
+        {
+          if (n_args == 2)
+            goto out;
+
+          args[n_args++] = g_strstrip (g_strndup (arg_start, p - arg_start));
+          arg_start = p + 1;
+        }
+    }
+  args[n_args++] = g_strstrip (g_strndup (arg_start, p - arg_start));
+
+  if (n_args < 2)
+    goto out;
+
+  if (n_args == 3)
+    {
+      side = args[0];
+      if (g_str_has_prefix (side, "to "))
+        {
+          side += 3;
+          while (*side == ' ')
+            side++;
+        }
+      else
+        to_side = FALSE;
+    }
+
+  if (!strcmp (side, "bottom") || !strcmp (side, "top"))
+    *horizontal = FALSE;
+  else if (!strcmp (side, "right") || !strcmp (side, "left"))
+    *horizontal = TRUE;
+  else
+    goto out;
+
+  reverse = (!strcmp (side, "top") || !strcmp (side, "left"));
+  if (!to_side)
+    reverse = !reverse;
+
+  if (!clutter_color_from_string (reverse ? end : start, args[n_args - 2]) ||
+      !clutter_color_from_string (reverse ? start : end, args[n_args - 1]))
+    goto out;
+
+  success = TRUE;
+
+out:
+  for (i = 0; i < n_args; i++)
+    g_free (args[i]);
+
+  return success;
+}
+
+MxBackgroundPainter *
+_mx_background_painter_new (void)
+{
+  MxBackgroundPainter *painter;
+  CoglHandle template;
+
+  painter = g_slice_new0 (MxBackgroundPainter);
+  painter->opacity = -1;
+
+  template = mx_background_painter_get_template ();
+  if (template)
+    painter->pipeline = cogl_pipeline_copy (template);
+
+  return painter;
+}
+
+void
+_mx_background_painter_free (MxBackgroundPainter *painter)
+{
+  if (painter->pipeline)
+    cogl_handle_unref (painter->pipeline);
+
+  g_slice_free (MxBackgroundPainter, painter);
+}
+
+/* Returns TRUE if the appearance of the painter has changed */
+gboolean
+_mx_background_painter_set_style (MxBackgroundPainter *painter,
+                                  const ClutterColor  *color,
+                                  const gchar         *gradient,
+                                  gfloat               radius,
+                                  gfloat               border_width,
+                                  const ClutterColor  *border_color)
+{
+  ClutterColor start = { 0, }, end = { 0, }, border = { 0, };
+  gboolean horizontal = FALSE;
+
+  if (!gradient ||
+      !mx_background_parse_gradient (gradient, &start, &end, &horizontal))
+    {
+      if (gradient)
+        g_warning ("Invalid gradient \"%s\"", gradient);
+
+      if (color)
+        start = end = *color;
+    }
+
+  if (border_color)
+    border = *border_color;
+
+  if (clutter_color_equal (&start, &painter->start_color) &&
+      clutter_color_equal (&end, &painter->end_color) &&
+      clutter_color_equal (&border, &painter->border_color) &&
+      horizontal == painter->horizontal &&
+      radius == painter->radius &&
+      border_width == painter->border_width)
+    return FALSE;
+
+  painter->start_color = start;
+  painter->end_color = end;
+  painter->border_color = border;
+  painter->horizontal = horizontal;
+  painter->radius = radius;
+  painter->border_width = border_width;
+
+  mx_background_painter_update_style (painter);
+
+  return TRUE;
+}
+
+static void
+mx_background_painter_paint_fallback (MxBackgroundPainter *painter,
+                                      gfloat               width,
+                                      gfloat               height,
+                                      guint8               opacity)
+{
+  gfloat border = MIN (painter->border_width, MIN (width, height) / 2);
+  CoglTextureVertex vertices[4];
+  CoglColor border_color;
+  ClutterColor *color;
+  gint i;
+
+  memset (vertices, 0, sizeof (vertices));
+  vertices[1].x = vertices[2].x = width;
+  vertices[2].y = vertices[3].y = height;
+
+  for (i = 0; i < 4; i++)
+    {
+      gboolean at_end = painter->horizontal ?
+        (vertices[i].x > 0) : (vertices[i].y > 0);
+
+      color = at_end ? &painter->end_color : &painter->start_color;
+
+      cogl_color_init_from_4ub (&vertices[i].color,
+                                color->red, color->green, color->blue,
+                                color->alpha * opacity / 255);
+      cogl_color_premultiply (&vertices[i].color);
+    }
+
+  cogl_set_source_color4ub (0xff, 0xff, 0xff, 0xff);
+  cogl_polygon (vertices, 4, TRUE);
+
+  if (border <= 0 || painter->border_color.alpha == 0)
+    return;
+
+  color = &painter->border_color;
+  cogl_color_init_from_4ub (&border_color,
+                            color->red, color->green, color->blue,
+                            color->alpha * opacity / 255);
+  cogl_color_premultiply (&border_color);
+  cogl_set_source_color (&border_color);
+
+  cogl_rectangle (0, 0, width, border);
+  cogl_rectangle (0, height - border, width, height);
+  cogl_rectangle (0, border, border, height - border);
+  cogl_rectangle (width - border, border, width, height - border);
+}
+
+void
+_mx_background_painter_paint (MxBackgroundPainter *painter,
+                              gfloat               width,
+                              gfloat               height,
+                              guint8               opacity)
+{
+  if (width <= 0 || height <= 0)
+    return;
+
+  if (!painter->pipeline)
+    {
+      mx_background_painter_paint_fallback (painter, width, height, opacity);
+      return;
+    }
+
+  /* only touch the pipeline when something changed, as modifying it
+   * flushes any of its geometry that is still batched */
+  if (width != painter->width || height != painter->height)
+    {
+      gfloat size[2] = { width, height };
+
+      cogl_pipeline_set_uniform_float (painter->pipeline,
+                                       uniform_locations[UNIFORM_SIZE],
+                                       2, 1, size);
+      painter->width = width;
+      painter->height = height;
+    }
+
+  if (opacity != painter->opacity)
+    {
+      cogl_pipeline_set_uniform_1f (painter->pipeline,
+                                    uniform_locations[UNIFORM_OPACITY],
+                                    opacity / 255.f);
+      painter->opacity = opacity;
+    }
+
+  cogl_push_source (painter->pipeline);
+  cogl_rectangle_with_texture_coords (0, 0, width, height, 0, 0, 1, 1);
+  cogl_pop_source ();
+}
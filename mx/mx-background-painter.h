@@ -0,0 +1,52 @@
+/*
+ * mx-background-painter.h: Shader based painting of widget backgrounds
+ *
+ * Copyright 2012 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/*
+ * This is private to MX
+ */
+
+#include <glib.h>
+#include <clutter/clutter.h>
+
+G_BEGIN_DECLS
+
+#ifndef _MX_BACKGROUND_PAINTER_H
+#define _MX_BACKGROUND_PAINTER_H
+
+typedef struct _MxBackgroundPainter MxBackgroundPainter;
+
+MxBackgroundPainter *_mx_background_painter_new       (void);
+void                 _mx_background_painter_free      (MxBackgroundPainter *painter);
+
+gboolean             _mx_background_painter_set_style (MxBackgroundPainter *painter,
+                                                       const ClutterColor  *color,
+                                                       const gchar         *gradient,
+                                                       gfloat               radius,
+                                                       gfloat               border_width,
+                                                       const ClutterColor  *border_color);
+
+void                 _mx_background_painter_paint     (MxBackgroundPainter *painter,
+                                                       gfloat               width,
+                                                       gfloat               height,
+                                                       guint8               opacity);
+
+G_END_DECLS
+
+#endif /* _MX_BACKGROUND_PAINTER_H */
@@ -161,6 +161,8 @@ adjustment_value_notify_cb (MxAdjustment *adjustment,
                             GParamSpec   *pspec,
                             MxBoxLayout  *box)
 {
+  /* scrolling only changes the transform and the culling in paint */
+  _mx_scroll_stats_scrolled (CLUTTER_ACTOR (box));
   clutter_actor_queue_redraw (CLUTTER_ACTOR (box));
 }
 
@@ -392,6 +394,14 @@ update_adjustments (MxBoxLayout *self,
     }
 }
 
+/* Used by MxFocusManager when it gives the focus to a child directly */
+void
+_mx_box_layout_set_last_focus (MxBoxLayout *box,
+                               MxFocusable *focusable)
+{
+  box->priv->last_focus = focusable;
+}
+
 static MxFocusable*
 mx_box_layout_move_focus (MxFocusable      *focusable,
                           MxFocusDirection  direction,
@@ -708,6 +718,8 @@ mx_box_layout_get_preferred_width (ClutterActor *actor,
   ClutterActorIter iter;
   ClutterActor *child;
 
+  _mx_scroll_stats_relayout (actor);
+
   mx_widget_get_padding (MX_WIDGET (actor), &padding);
 
   if (min_width_p)
@@ -716,6 +728,9 @@ mx_box_layout_get_preferred_width (ClutterActor *actor,
   if (natural_width_p)
     *natural_width_p = 0;
 
+  /* measure any labels in parallel before requesting their sizes */
+  _mx_label_measure_children (actor);
+
   if (for_height > 0)
     for_height = MAX (0, for_height - padding.top - padding.bottom);
 
@@ -788,6 +803,8 @@ mx_box_layout_get_preferred_height (ClutterActor *actor,
   ClutterActor *child;
   ClutterActorIter iter;
 
+  _mx_scroll_stats_relayout (actor);
+
   mx_widget_get_padding (MX_WIDGET (actor), &padding);
 
 
@@ -797,6 +814,9 @@ mx_box_layout_get_preferred_height (ClutterActor *actor,
   if (natural_height_p)
     *natural_height_p = 0;
 
+  /* measure any labels in parallel before requesting their sizes */
+  _mx_label_measure_children (actor);
+
   if (for_width > 0)
     for_width = MAX (0, for_width - padding.left - padding.right);
 
@@ -988,6 +1008,8 @@ mx_box_layout_allocate (ClutterActor          *actor,
   gint n_expand_children, n_children;
   GList *boxes = NULL, *l;
 
+  _mx_scroll_stats_relayout (actor);
+
   CLUTTER_ACTOR_CLASS (mx_box_layout_parent_class)->allocate (actor, box,
                                                               flags);
 
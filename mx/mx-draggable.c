@@ -30,6 +30,7 @@
 #include "mx-enum-types.h"
 #include "mx-marshal.h"
 #include "mx-private.h"
+#include "mx-velocity-tracker.h"
 
 typedef struct _DragContext DragContext;
 
@@ -56,6 +57,12 @@ struct _DragContext
   gfloat              last_x;
   gfloat              last_y;
 
+  /* pointer positions in stage coordinates */
+  MxVelocityTracker   motion;
+
+  /* repaint function applying the latest motion once per frame */
+  guint               motion_repaint_id;
+
   guint               emit_delayed_press : 1;
   guint               in_drag            : 1;
 };
@@ -75,6 +82,7 @@ static guint draggable_signals[LAST_SIGNAL] = { 0, };
 static gboolean on_stage_capture (ClutterActor *stage,
                                   ClutterEvent *event,
                                   DragContext  *context);
+static void     draggable_flush_motion (DragContext *context);
 
 static gboolean
 draggable_release (DragContext        *context,
@@ -88,6 +96,9 @@ draggable_release (DragContext        *context,
   if (!context->in_drag)
     return FALSE;
 
+  /* move to the last position before ending the drag */
+  draggable_flush_motion (context);
+
   event_x = event->x;
   event_y = event->y;
   actor_x = 0;
@@ -109,6 +120,9 @@ draggable_release (DragContext        *context,
   context->last_x = actor_x;
   context->last_y = actor_y;
 
+  _mx_velocity_tracker_add (&context->motion, event_x, event_y,
+                            g_get_monotonic_time ());
+
   context->in_drag = FALSE;
 
   g_signal_handlers_disconnect_by_func (stage,
@@ -125,9 +139,9 @@ draggable_release (DragContext        *context,
   return FALSE;
 }
 
-static gboolean
-draggable_motion (DragContext        *context,
-                  ClutterMotionEvent *event)
+/* Moves the drag to the latest pointer position */
+static void
+draggable_apply_motion (DragContext *context)
 {
   gfloat event_x, event_y;
   gfloat actor_x, actor_y;
@@ -136,10 +150,9 @@ draggable_motion (DragContext        *context,
   gboolean res;
 
   if (!context->in_drag)
-    return FALSE;
+    return;
 
-  event_x = event->x;
-  event_y = event->y;
+  _mx_velocity_tracker_get_last (&context->motion, &event_x, &event_y);
   actor_x = 0;
   actor_y = 0;
 
@@ -152,7 +165,7 @@ draggable_motion (DragContext        *context,
                                              event_x, event_y,
                                              &actor_x, &actor_y);
   if (!res)
-    return FALSE;
+    return;
 
   context->last_x = actor_x;
   context->last_y = actor_y;
@@ -192,12 +205,56 @@ draggable_motion (DragContext        *context,
           g_object_set_data (G_OBJECT (stage), "mx-drag-actor", actor);
         }
       else
-        return FALSE;
+        return;
     }
 
   g_signal_emit (context->draggable, draggable_signals[DRAG_MOTION], 0,
                  delta_x,
                  delta_y);
+}
+
+static gboolean
+draggable_motion_repaint_cb (gpointer data)
+{
+  DragContext *context = data;
+
+  context->motion_repaint_id = 0;
+  draggable_apply_motion (context);
+
+  return FALSE;
+}
+
+static void
+draggable_flush_motion (DragContext *context)
+{
+  if (!context->motion_repaint_id)
+    return;
+
+  clutter_threads_remove_repaint_func (context->motion_repaint_id);
+  context->motion_repaint_id = 0;
+
+  draggable_apply_motion (context);
+}
+
+static gboolean
+draggable_motion (DragContext        *context,
+                  ClutterMotionEvent *event)
+{
+  if (!context->in_drag)
+    return FALSE;
+
+  /* Several motion events can arrive within a frame; they are all kept
+   * for the velocity estimation, but the drag is only moved to the latest
+   * position, once per frame, before the stage is laid out */
+  _mx_velocity_tracker_add (&context->motion, event->x, event->y,
+                            g_get_monotonic_time ());
+
+  if (!context->motion_repaint_id)
+    context->motion_repaint_id =
+      clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_PRE_PAINT,
+                                             draggable_motion_repaint_cb,
+                                             context,
+                                             NULL);
 
   return FALSE;
 }
@@ -268,6 +325,10 @@ on_draggable_press (ClutterActor       *actor,
   context->press_modifiers = event->modifier_state;
   context->emit_delayed_press = FALSE;
 
+  _mx_velocity_tracker_reset (&context->motion);
+  _mx_velocity_tracker_add (&context->motion, event_x, event_y,
+                            g_get_monotonic_time ());
+
   g_object_get (G_OBJECT (draggable),
                 "drag-threshold", &context->threshold,
                 "axis", &context->axis,
@@ -308,6 +369,9 @@ drag_context_free (gpointer data)
     {
       DragContext *context = data;
 
+      if (context->motion_repaint_id)
+        clutter_threads_remove_repaint_func (context->motion_repaint_id);
+
       /* disconnect any signal handlers we may have installed */
       g_signal_handlers_disconnect_by_func (context->draggable,
                                             G_CALLBACK (on_draggable_press),
@@ -352,6 +416,7 @@ drag_context_create (MxDraggable *draggable)
   context->emit_delayed_press = FALSE;
   context->stage = NULL;
   context->actor = NULL;
+  context->motion_repaint_id = 0;
 
   /* attach the context to the draggable */
   g_object_set_qdata_full (G_OBJECT (draggable), quark_draggable_context,
@@ -712,3 +777,48 @@ mx_draggable_is_enabled (MxDraggable *draggable)
 
   return retval;
 }
+
+/**
+ * mx_draggable_get_velocity:
+ * @draggable: a #MxDraggable
+ * @velocity_x: (out) (allow-none): return location for the horizontal
+ *   velocity, or %NULL
+ * @velocity_y: (out) (allow-none): return location for the vertical
+ *   velocity, or %NULL
+ *
+ * Retrieves the velocity of the pointer during the current drag, or when
+ * the last drag ended, in pixels per second. This can be used in a
+ * handler of #MxDraggable::drag-end to throw the dragged actor.
+ *
+ * The velocity is estimated from the most recent motion events, so that a
+ * single inaccurate event has little influence.
+ *
+ * Return value: %TRUE if there were enough recent events to estimate the
+ *   velocity. Otherwise, the velocity is 0.
+ *
+ * Since: 2.0
+ */
+gboolean
+mx_draggable_get_velocity (MxDraggable *draggable,
+                           gfloat      *velocity_x,
+                           gfloat      *velocity_y)
+{
+  DragContext *context;
+
+  g_return_val_if_fail (MX_IS_DRAGGABLE (draggable), FALSE);
+
+  context = g_object_get_qdata (G_OBJECT (draggable), quark_draggable_context);
+
+  if (!context)
+    {
+      if (velocity_x)
+        *velocity_x = 0;
+      if (velocity_y)
+        *velocity_y = 0;
+
+      return FALSE;
+    }
+
+  return _mx_velocity_tracker_get_velocity (&context->motion,
+                                            velocity_x, velocity_y);
+}
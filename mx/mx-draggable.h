@@ -132,6 +132,10 @@ void              mx_draggable_disable              (MxDraggable       *draggabl
 void              mx_draggable_enable               (MxDraggable       *draggable);
 gboolean          mx_draggable_is_enabled           (MxDraggable       *draggable);
 
+gboolean          mx_draggable_get_velocity         (MxDraggable       *draggable,
+                                                     gfloat            *velocity_x,
+                                                     gfloat            *velocity_y);
+
 G_END_DECLS
 
 #endif /* __MX_DRAGGABLE_H__ */
@@ -26,12 +26,17 @@
 #include "config.h"
 #endif
 
+#include <math.h>
+#include <string.h>
+
 #include "mx-droppable.h"
 #include "mx-enum-types.h"
 #include "mx-marshal.h"
 #include "mx-private.h"
+#include "mx-scrollable.h"
 
 typedef struct _DropContext DropContext;
+typedef struct _DropTarget  DropTarget;
 
 enum
 {
@@ -49,6 +54,7 @@ struct _DropContext
 {
   ClutterActor *stage;
 
+  /* the enabled droppables, as DropTarget */
   GSList       *targets;
 
   MxDroppable  *last_target;
@@ -56,46 +62,271 @@ struct _DropContext
   guint         is_over : 1;
 };
 
+struct _DropTarget
+{
+  MxDroppable     *droppable;
+
+  /* the visible area of the droppable on the stage, cached until the
+   * droppable or one of its parents is moved, transformed or scrolled */
+  ClutterActorBox  box;
+
+  /* the droppable, its parents and the adjustments of the scrollables
+   * among them, which are watched for changes to the box */
+  GPtrArray       *watched;
+
+  guint            box_valid : 1;
+
+  /* the droppable or one of its clips isn't an axis-aligned rectangle on
+   * the stage, so only a pick can tell whether it is under a point */
+  guint            complex   : 1;
+};
+
+/* Stores the bounds of the allocation of @actor in stage coordinates in
+ * @box. Returns %FALSE if it isn't an axis-aligned rectangle. */
 static gboolean
-on_stage_capture (ClutterActor *actor,
-                  ClutterEvent *event,
-                  DropContext  *context)
+drop_get_stage_box (ClutterActor    *actor,
+                    ClutterActorBox *box)
 {
-  MxDroppable *droppable;
-  MxDraggable *draggable;
-  ClutterActor *target;
-  gfloat event_x, event_y;
-  gboolean draggable_reactive;
+  ClutterVertex verts[4];
 
-  if (!(event->type == CLUTTER_MOTION ||
-        event->type == CLUTTER_BUTTON_RELEASE))
+  clutter_actor_get_abs_allocation_vertices (actor, verts);
+
+  /* the vertices are top-left, top-right, bottom-left, bottom-right */
+  if (fabsf (verts[0].y - verts[1].y) > 0.5f ||
+      fabsf (verts[2].y - verts[3].y) > 0.5f ||
+      fabsf (verts[0].x - verts[2].x) > 0.5f ||
+      fabsf (verts[1].x - verts[3].x) > 0.5f)
     return FALSE;
 
-  draggable = g_object_get_data (G_OBJECT (actor), "mx-drag-actor");
-  if (G_UNLIKELY (draggable == NULL))
+  box->x1 = MIN (verts[0].x, verts[3].x);
+  box->y1 = MIN (verts[0].y, verts[3].y);
+  box->x2 = MAX (verts[0].x, verts[3].x);
+  box->y2 = MAX (verts[0].y, verts[3].y);
+
+  return TRUE;
+}
+
+static void
+drop_target_unwatch (DropTarget *target)
+{
+  guint i;
+
+  for (i = 0; i < target->watched->len; i++)
+    g_signal_handlers_disconnect_matched (g_ptr_array_index (target->watched,
+                                                             i),
+                                          G_SIGNAL_MATCH_DATA,
+                                          0, 0, NULL, NULL, target);
+
+  g_ptr_array_set_size (target->watched, 0);
+  target->box_valid = FALSE;
+}
+
+static void
+drop_target_notify_cb (GObject    *object,
+                       GParamSpec *pspec,
+                       DropTarget *target)
+{
+  /* a scrollable got new adjustments, which need watching instead */
+  if (!strcmp (pspec->name, "horizontal-adjustment") ||
+      !strcmp (pspec->name, "vertical-adjustment"))
+    drop_target_unwatch (target);
+  else
+    target->box_valid = FALSE;
+}
+
+static void
+drop_target_parent_set_cb (ClutterActor *actor,
+                           ClutterActor *old_parent,
+                           DropTarget   *target)
+{
+  drop_target_unwatch (target);
+}
+
+static void
+drop_target_watch (DropTarget *target)
+{
+  ClutterActor *actor;
+
+  for (actor = CLUTTER_ACTOR (target->droppable);
+       actor;
+       actor = clutter_actor_get_parent (actor))
+    {
+      MxAdjustment *adjustments[2] = { NULL, NULL };
+      gint i;
+
+      /* any change to the allocation, the transformation or the clip of
+       * an actor changes the boxes of the actors inside of it */
+      g_signal_connect (actor, "notify",
+                        G_CALLBACK (drop_target_notify_cb), target);
+      g_signal_connect (actor, "parent-set",
+                        G_CALLBACK (drop_target_parent_set_cb), target);
+      g_ptr_array_add (target->watched, g_object_ref (actor));
+
+      if (!MX_IS_SCROLLABLE (actor))
+        continue;
+
+      mx_scrollable_get_adjustments (MX_SCROLLABLE (actor),
+                                     &adjustments[0], &adjustments[1]);
+      for (i = 0; i < 2; i++)
+        {
+          if (!adjustments[i])
+            continue;
+
+          g_signal_connect (adjustments[i], "notify::value",
+                            G_CALLBACK (drop_target_notify_cb), target);
+          g_ptr_array_add (target->watched, g_object_ref (adjustments[i]));
+        }
+    }
+}
+
+static void
+drop_target_update (DropTarget *target)
+{
+  ClutterActor *parent;
+
+  if (target->watched->len == 0)
+    drop_target_watch (target);
+
+  target->box_valid = TRUE;
+  target->complex = !drop_get_stage_box (CLUTTER_ACTOR (target->droppable),
+                                         &target->box);
+
+  /* Intersect with the clips of the parents. Scrollables are included as
+   * the scroll views and viewports clip their children while painting. */
+  parent = clutter_actor_get_parent (CLUTTER_ACTOR (target->droppable));
+  while (parent && !target->complex)
+    {
+      ClutterActorBox clip;
+
+      if (clutter_actor_get_clip_to_allocation (parent) ||
+          MX_IS_SCROLLABLE (parent))
+        {
+          if (!drop_get_stage_box (parent, &clip))
+            target->complex = TRUE;
+          else
+            {
+              target->box.x1 = MAX (target->box.x1, clip.x1);
+              target->box.y1 = MAX (target->box.y1, clip.y1);
+              target->box.x2 = MIN (target->box.x2, clip.x2);
+              target->box.y2 = MIN (target->box.y2, clip.y2);
+            }
+        }
+      else if (clutter_actor_has_clip (parent))
+        target->complex = TRUE;
+
+      parent = clutter_actor_get_parent (parent);
+    }
+}
+
+/* Returns whether @actor is painted after @other */
+static gboolean
+drop_actor_is_above (ClutterActor *actor,
+                     ClutterActor *other)
+{
+  ClutterActor *branch, *other_branch, *parent, *sibling;
+
+  if (clutter_actor_contains (other, actor))
+    return TRUE;
+
+  if (clutter_actor_contains (actor, other))
     return FALSE;
 
+  /* find the children of the closest common parent that contain them,
+   * the later of which is painted last */
+  for (branch = actor; (parent = clutter_actor_get_parent (branch));
+       branch = parent)
+    if (clutter_actor_contains (parent, other))
+      break;
+
+  if (!parent)
+    return FALSE;
+
+  for (other_branch = other;
+       clutter_actor_get_parent (other_branch) != parent;
+       other_branch = clutter_actor_get_parent (other_branch));
+
+  for (sibling = other_branch; sibling;
+       sibling = clutter_actor_get_next_sibling (sibling))
+    if (sibling == branch)
+      return TRUE;
+
+  return FALSE;
+}
+
+/* Finds the enabled droppable under the given point from the cached
+ * bounds, the one painted last when several of them contain it, and stores
+ * it in @hit. Returns %FALSE when that needs a pick, because one of the
+ * droppables or of their clips isn't an axis-aligned rectangle on the
+ * stage. Unlike a pick, actors that aren't droppables don't hide the
+ * droppables under them.
+ */
+static gboolean
+drop_context_hit (DropContext   *context,
+                  MxDraggable   *draggable,
+                  gfloat         x,
+                  gfloat         y,
+                  ClutterActor **hit)
+{
+  GSList *l;
+
+  *hit = NULL;
+
+  for (l = context->targets; l; l = l->next)
+    {
+      DropTarget *target = l->data;
+      ClutterActor *actor = CLUTTER_ACTOR (target->droppable);
+
+      if (!CLUTTER_ACTOR_IS_MAPPED (actor) ||
+          clutter_actor_contains (CLUTTER_ACTOR (draggable), actor))
+        continue;
+
+      if (!target->box_valid)
+        drop_target_update (target);
+
+      if (target->complex)
+        return FALSE;
+
+      if (x >= target->box.x1 && x < target->box.x2 &&
+          y >= target->box.y1 && y < target->box.y2 &&
+          (!*hit || drop_actor_is_above (actor, *hit)))
+        *hit = actor;
+    }
+
+  return TRUE;
+}
+
+static ClutterActor *
+drop_context_pick (ClutterActor *stage,
+                   MxDraggable  *draggable,
+                   gfloat        x,
+                   gfloat        y)
+{
+  ClutterActor *target;
+  gboolean draggable_reactive;
+
   /* get the actor currently under the cursor; we set the draggable
    * unreactive so that it does not intefere with get_actor_at_pos();
    * the paint that get_actor_at_pos() performs is in the back buffer
    * so the hide/show cycle will not be visible on screen
    */
-  clutter_event_get_coords (event, &event_x, &event_y);
-
   draggable_reactive = clutter_actor_get_reactive (CLUTTER_ACTOR (draggable));
   clutter_actor_set_reactive (CLUTTER_ACTOR (draggable), FALSE);
 
-  target = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (actor),
+  target = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
                                            CLUTTER_PICK_REACTIVE,
-                                           event_x,
-                                           event_y);
+                                           x, y);
 
   clutter_actor_set_reactive (CLUTTER_ACTOR (draggable), draggable_reactive);
 
-  if (G_UNLIKELY (target == NULL))
-    return FALSE;
+  return target;
+}
+
+static MxDroppable *
+drop_context_find_droppable (ClutterActor *target,
+                             MxDraggable  *draggable)
+{
+  MxDroppable *droppable = NULL;
 
-  droppable = NULL;
   if (!MX_IS_DROPPABLE (target))
     {
       ClutterActor *parent = target;
@@ -119,6 +350,41 @@ on_stage_capture (ClutterActor *actor,
         droppable = MX_DROPPABLE (target);
     }
 
+  return droppable;
+}
+
+static gboolean
+on_stage_capture (ClutterActor *actor,
+                  ClutterEvent *event,
+                  DropContext  *context)
+{
+  MxDroppable *droppable;
+  MxDraggable *draggable;
+  ClutterActor *target;
+  gfloat event_x, event_y;
+
+  if (!(event->type == CLUTTER_MOTION ||
+        event->type == CLUTTER_BUTTON_RELEASE))
+    return FALSE;
+
+  draggable = g_object_get_data (G_OBJECT (actor), "mx-drag-actor");
+  if (G_UNLIKELY (draggable == NULL))
+    return FALSE;
+
+  clutter_event_get_coords (event, &event_x, &event_y);
+
+  /* Picking renders the whole stage, so it's only done when the cached
+   * bounds can't tell which droppable is under the pointer */
+  if (!drop_context_hit (context, draggable, event_x, event_y, &target))
+    {
+      target = drop_context_pick (actor, draggable, event_x, event_y);
+
+      if (G_UNLIKELY (target == NULL))
+        return FALSE;
+    }
+
+  droppable = target ? drop_context_find_droppable (target, draggable) : NULL;
+
   /* we are on a new target, so emit ::over-out and unset the last target */
   if (context->last_target && droppable != context->last_target)
     {
@@ -171,6 +437,27 @@ on_stage_capture (ClutterActor *actor,
   return FALSE;
 }
 
+static DropTarget *
+drop_target_new (MxDroppable *droppable)
+{
+  DropTarget *target;
+
+  target = g_slice_new0 (DropTarget);
+  target->droppable = droppable;
+  target->watched = g_ptr_array_new_with_free_func (g_object_unref);
+
+  return target;
+}
+
+static void
+drop_target_free (DropTarget *target)
+{
+  drop_target_unwatch (target);
+  g_ptr_array_free (target->watched, TRUE);
+
+  g_slice_free (DropTarget, target);
+}
+
 static void
 drop_context_destroy (gpointer data)
 {
@@ -178,6 +465,7 @@ drop_context_destroy (gpointer data)
     {
       DropContext *context = data;
 
+      g_slist_foreach (context->targets, (GFunc) drop_target_free, NULL);
       g_slist_free (context->targets);
       g_object_unref (context->stage);
       g_slice_free (DropContext, context);
@@ -188,7 +476,8 @@ static void
 drop_context_update (DropContext *context,
                      MxDroppable *droppable)
 {
-  context->targets = g_slist_prepend (context->targets, droppable);
+  context->targets = g_slist_prepend (context->targets,
+                                     drop_target_new (droppable));
 }
 
 static DropContext *
@@ -199,7 +488,7 @@ drop_context_create (ClutterActor *stage,
 
   retval = g_slice_new (DropContext);
   retval->stage = g_object_ref (stage);
-  retval->targets = g_slist_prepend (NULL, droppable);
+  retval->targets = g_slist_prepend (NULL, drop_target_new (droppable));
   retval->last_target = NULL;
   retval->is_over = FALSE;
 
@@ -242,6 +531,7 @@ mx_droppable_real_disable (MxDroppable *droppable)
 {
   ClutterActor *stage;
   DropContext *context;
+  GSList *l;
 
   stage = clutter_actor_get_stage (CLUTTER_ACTOR (droppable));
   if (G_UNLIKELY (stage == NULL))
@@ -251,7 +541,21 @@ mx_droppable_real_disable (MxDroppable *droppable)
   if (G_UNLIKELY (context == NULL))
     return;
 
-  context->targets = g_slist_remove (context->targets, droppable);
+  for (l = context->targets; l; l = l->next)
+    {
+      DropTarget *target = l->data;
+
+      if (target->droppable == droppable)
+        {
+          context->targets = g_slist_delete_link (context->targets, l);
+          drop_target_free (target);
+          break;
+        }
+    }
+
+  if (context->last_target == droppable)
+    context->last_target = NULL;
+
   if (context->targets == NULL)
     {
       g_signal_handlers_disconnect_by_func (stage,
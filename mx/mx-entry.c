@@ -68,6 +68,7 @@
 #include "mx-focusable.h"
 #include "mx-private.h"
 #include "mx-tooltip.h"
+#include "mx-piece-table.h"
 
 #ifdef HAVE_X11
 /* for pointer cursor support */
@@ -83,6 +84,12 @@
 #define MX_ENTRY_TOOLTIP_DELAY 500
 #define PLACEHOLDER_SPACING 4
 
+/* In large-text mode, the ClutterText holds about this many bytes of the
+ * text around the cursor, and the window is moved once the cursor gets
+ * closer than the margin to one of its ends */
+#define MX_ENTRY_WINDOW_SIZE 16384
+#define MX_ENTRY_WINDOW_MARGIN 4096
+
 /* properties */
 enum
 {
@@ -94,7 +101,8 @@ enum
   PROP_PASSWORD_CHAR,
   PROP_ICON_HIGHLIGHT_SUFFIX,
   PROP_PRIMARY_ICON_TOOLTIP_TEXT,
-  PROP_SECONDARY_ICON_TOOLTIP_TEXT
+  PROP_SECONDARY_ICON_TOOLTIP_TEXT,
+  PROP_LARGE_TEXT
 };
 
 /* signals */
@@ -130,6 +138,8 @@ struct _MxEntryPrivate
 
   gfloat        spacing;
 
+  ClutterColor  background_color;
+
   gunichar password_char;
 
   GQueue   *undo_history;
@@ -139,6 +149,19 @@ struct _MxEntryPrivate
   guint scrolling : 1;
   guint unicode_input_mode : 1;
   guint pointer_in_entry : 1;
+  guint loading_window : 1;
+
+  /* In large-text mode, the whole text is kept in a piece table and only
+   * a window of it is loaded into the ClutterText. The edits made to the
+   * ClutterText are applied to the buffer as they happen, so window_length
+   * is always the length of its text. */
+  MxPieceTable *buffer;
+  gsize         window_start;
+  gsize         window_length;
+  guint         window_repaint_id;
+
+  /* the whole text, assembled by mx_entry_get_text() in large-text mode */
+  gchar        *text;
 
   GString *preedit_string;
 
@@ -193,6 +216,10 @@ mx_entry_set_property (GObject      *gobject,
                                                 g_value_get_string (value));
       break;
 
+    case PROP_LARGE_TEXT:
+      mx_entry_set_large_text (entry, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -218,8 +245,7 @@ mx_entry_get_property (GObject    *gobject,
       break;
 
     case PROP_TEXT:
-      g_value_set_string (value,
-                          clutter_text_get_text (CLUTTER_TEXT (priv->entry)));
+      g_value_set_string (value, mx_entry_get_text (MX_ENTRY (gobject)));
       break;
 
     case PROP_PASSWORD_CHAR:
@@ -242,6 +268,10 @@ mx_entry_get_property (GObject    *gobject,
                             mx_tooltip_get_text (priv->secondary_icon_tooltip));
       break;
 
+    case PROP_LARGE_TEXT:
+      g_value_set_boolean (value, priv->buffer != NULL);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -273,6 +303,12 @@ mx_entry_dispose (GObject *object)
       priv->tooltip_timeout = 0;
     }
 
+  if (priv->window_repaint_id)
+    {
+      clutter_threads_remove_repaint_func (priv->window_repaint_id);
+      priv->window_repaint_id = 0;
+    }
+
   G_OBJECT_CLASS (mx_entry_parent_class)->dispose (object);
 }
 
@@ -284,6 +320,15 @@ mx_entry_finalize (GObject *object)
   g_free (priv->placeholder);
   priv->placeholder = NULL;
 
+  g_free (priv->text);
+  priv->text = NULL;
+
+  if (priv->buffer)
+    {
+      _mx_piece_table_free (priv->buffer);
+      priv->buffer = NULL;
+    }
+
   if (priv->preedit_string)
     {
       g_string_free (priv->preedit_string, TRUE);
@@ -370,13 +415,22 @@ mx_entry_style_changed (MxWidget *self)
   ClutterColor *caret_color = NULL;
   ClutterColor *selection_background_color = NULL;
   ClutterColor *selected_text_color = NULL;
+  ClutterColor *background_color = NULL;
 
   mx_stylable_get (MX_STYLABLE (self),
                    "caret-color", &caret_color,
                    "selection-background-color", &selection_background_color,
                    "selected-text-color", &selected_text_color,
+                   "background-color", &background_color,
                    NULL);
 
+  /* kept for the scrolling shadow, so paint doesn't need a style lookup */
+  if (background_color)
+    {
+      priv->background_color = *background_color;
+      clutter_color_free (background_color);
+    }
+
   if (caret_color)
     {
       clutter_text_set_cursor_color (CLUTTER_TEXT (priv->entry), caret_color);
@@ -613,6 +667,299 @@ mx_entry_allocate (ClutterActor          *actor,
 
 }
 
+static gboolean
+mx_entry_is_empty (MxEntry *entry)
+{
+  MxEntryPrivate *priv = entry->priv;
+
+  if (strcmp (clutter_text_get_text (CLUTTER_TEXT (priv->entry)), ""))
+    return FALSE;
+
+  /* in large-text mode, there may be more text outside of the window */
+  return (!priv->buffer ||
+          priv->window_length == _mx_piece_table_get_length (priv->buffer));
+}
+
+static void
+mx_entry_text_changed (MxEntry *entry)
+{
+  MxEntryPrivate *priv = entry->priv;
+
+  g_free (priv->text);
+  priv->text = NULL;
+
+  g_object_notify (G_OBJECT (entry), "text");
+
+  /* set up the pseudo class for the placeholder */
+  if (priv->placeholder)
+    {
+      if (mx_entry_is_empty (entry))
+        mx_stylable_style_pseudo_class_add (MX_STYLABLE (entry),
+                                            "indeterminate");
+      else
+        mx_stylable_style_pseudo_class_remove (MX_STYLABLE (entry),
+                                               "indeterminate");
+    }
+}
+
+/* Replaces the undo history with @text, which it takes ownership of */
+static void
+mx_entry_reset_undo_history (MxEntry *entry,
+                             gchar   *text)
+{
+  MxEntryPrivate *priv = entry->priv;
+
+  if (priv->undo_timeout_source)
+    {
+      g_source_remove (priv->undo_timeout_source);
+      priv->undo_timeout_source = 0;
+    }
+
+  if (!priv->undo_history)
+    priv->undo_history = g_queue_new ();
+
+  g_queue_foreach (priv->undo_history, (GFunc) g_free, NULL);
+  g_queue_clear (priv->undo_history);
+  g_queue_push_head (priv->undo_history, text);
+}
+
+/* Returns the offset in the buffer of a character position in the
+ * ClutterText, where -1 is the end of the text */
+static gsize
+mx_entry_window_to_buffer (MxEntry *entry,
+                           gint     position)
+{
+  MxEntryPrivate *priv = entry->priv;
+  const gchar *text;
+
+  if (position < 0)
+    return priv->window_start + priv->window_length;
+
+  text = clutter_text_get_text (CLUTTER_TEXT (priv->entry));
+
+  return priv->window_start +
+    (g_utf8_offset_to_pointer (text, position) - text);
+}
+
+static void
+mx_entry_insert_text_cb (ClutterText *text,
+                         const gchar *new_text,
+                         gint         new_text_length,
+                         gint        *position,
+                         MxEntry     *entry)
+{
+  MxEntryPrivate *priv = entry->priv;
+
+  if (!priv->buffer || priv->loading_window)
+    return;
+
+  /* the text before the position is the same whether or not the new text
+   * has been added to the ClutterText yet */
+  _mx_piece_table_insert (priv->buffer,
+                          mx_entry_window_to_buffer (entry, *position),
+                          new_text, new_text_length);
+  priv->window_length += new_text_length;
+}
+
+static void
+mx_entry_delete_text_cb (ClutterText *text,
+                         gint         start_pos,
+                         gint         end_pos,
+                         MxEntry     *entry)
+{
+  MxEntryPrivate *priv = entry->priv;
+  gsize start, end;
+
+  if (!priv->buffer || priv->loading_window)
+    return;
+
+  /* the ClutterText has already removed the characters, but the text before
+   * them is the same, and they are still in the buffer */
+  start = mx_entry_window_to_buffer (entry, start_pos);
+  end = priv->window_start + priv->window_length;
+
+  if (end_pos >= 0)
+    end = MIN (end, _mx_piece_table_skip_chars (priv->buffer, start,
+                                                end_pos - start_pos));
+
+  _mx_piece_table_delete (priv->buffer, start, end - start);
+  priv->window_length -= end - start;
+}
+
+/* Loads the part of the buffer around @cursor into the ClutterText */
+static void
+mx_entry_load_window (MxEntry *entry,
+                      gsize    cursor,
+                      gsize    bound)
+{
+  MxEntryPrivate *priv = entry->priv;
+  ClutterText *text = CLUTTER_TEXT (priv->entry);
+  gsize length, start, end;
+  GString *window;
+  gint cursor_pos, bound_pos;
+
+  length = _mx_piece_table_get_length (priv->buffer);
+
+  /* centre the window on the cursor, keeping it inside of the text */
+  start = (cursor > MX_ENTRY_WINDOW_SIZE / 2) ?
+    cursor - MX_ENTRY_WINDOW_SIZE / 2 : 0;
+  end = MIN (length, start + MX_ENTRY_WINDOW_SIZE);
+  start = (end > MX_ENTRY_WINDOW_SIZE) ? end - MX_ENTRY_WINDOW_SIZE : 0;
+
+  start = _mx_piece_table_align (priv->buffer, start);
+  end = _mx_piece_table_align (priv->buffer, end);
+
+  window = g_string_sized_new (end - start + 1);
+  _mx_piece_table_get_text (priv->buffer, start, end, window);
+
+  cursor = CLAMP (cursor, start, end);
+  bound = CLAMP (bound, start, end);
+  cursor_pos = g_utf8_pointer_to_offset (window->str,
+                                         window->str + (cursor - start));
+  bound_pos = g_utf8_pointer_to_offset (window->str,
+                                        window->str + (bound - start));
+
+  priv->window_start = start;
+  priv->window_length = end - start;
+
+  /* the text itself hasn't changed, so the ClutterText's signals are
+   * ignored while it's being replaced */
+  priv->loading_window = TRUE;
+  clutter_text_set_text (text, window->str);
+  clutter_text_set_selection (text, bound_pos, cursor_pos);
+  priv->loading_window = FALSE;
+
+  /* the undo history holds the text of the previous window */
+  mx_entry_reset_undo_history (entry, g_string_free (window, FALSE));
+}
+
+static void
+mx_entry_move_window (MxEntry *entry)
+{
+  MxEntryPrivate *priv = entry->priv;
+  ClutterText *text = CLUTTER_TEXT (priv->entry);
+  gsize cursor, bound, window_end, length;
+
+  cursor = mx_entry_window_to_buffer (entry,
+                                      clutter_text_get_cursor_position (text));
+  bound = mx_entry_window_to_buffer (entry,
+                                     clutter_text_get_selection_bound (text));
+
+  window_end = mx_entry_window_to_buffer (entry, -1);
+  length = _mx_piece_table_get_length (priv->buffer);
+
+  /* keep the window where it is while the cursor isn't near one of its
+   * ends, unless it has grown a lot from the text typed into it */
+  if ((cursor >= priv->window_start + MX_ENTRY_WINDOW_MARGIN ||
+       priv->window_start == 0) &&
+      (cursor + MX_ENTRY_WINDOW_MARGIN <= window_end ||
+       priv->window_start + priv->window_length == length) &&
+      window_end - priv->window_start <= 2 * MX_ENTRY_WINDOW_SIZE)
+    return;
+
+  mx_entry_load_window (entry, cursor, bound);
+}
+
+static gboolean
+mx_entry_window_repaint_cb (gpointer data)
+{
+  MxEntry *entry = data;
+
+  entry->priv->window_repaint_id = 0;
+
+  if (entry->priv->buffer)
+    mx_entry_move_window (entry);
+
+  return FALSE;
+}
+
+static void
+mx_entry_queue_move_window (MxEntry *entry)
+{
+  MxEntryPrivate *priv = entry->priv;
+
+  if (!priv->buffer || priv->loading_window || priv->window_repaint_id)
+    return;
+
+  /* the window is moved before the next frame is laid out, so the cursor
+   * can't be painted next to the end of the window */
+  priv->window_repaint_id =
+    clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_PRE_PAINT,
+                                           mx_entry_window_repaint_cb,
+                                           entry,
+                                           NULL);
+}
+
+static void
+mx_entry_position_changed_cb (ClutterText *text,
+                              GParamSpec  *pspec,
+                              MxEntry     *entry)
+{
+  mx_entry_queue_move_window (entry);
+}
+
+/* Replaces the selection with @str in large-text mode, going through the
+ * buffer so that pasting a lot of text doesn't grow the window */
+static void
+mx_entry_insert_large_text (MxEntry     *entry,
+                            const gchar *str)
+{
+  MxEntryPrivate *priv = entry->priv;
+  ClutterText *text = CLUTTER_TEXT (priv->entry);
+  gsize cursor, bound, start, end, length;
+
+  cursor = mx_entry_window_to_buffer (entry,
+                                      clutter_text_get_cursor_position (text));
+  bound = mx_entry_window_to_buffer (entry,
+                                     clutter_text_get_selection_bound (text));
+
+  start = MIN (cursor, bound);
+  end = MAX (cursor, bound);
+  length = strlen (str);
+
+  _mx_piece_table_delete (priv->buffer, start, end - start);
+  _mx_piece_table_insert (priv->buffer, start, str, length);
+
+  mx_entry_load_window (entry, start + length, start + length);
+  mx_entry_text_changed (entry);
+}
+
+static gboolean
+mx_entry_large_text_key_press_cb (ClutterText     *text,
+                                  ClutterKeyEvent *event,
+                                  MxEntry         *entry)
+{
+  MxEntryPrivate *priv = entry->priv;
+  gsize length;
+
+  if (!priv->buffer || (event->modifier_state & CLUTTER_SHIFT_MASK))
+    return FALSE;
+
+  /* the ClutterText can only move to the ends of the window */
+  switch (event->keyval)
+    {
+    case CLUTTER_KEY_Home:
+    case CLUTTER_KEY_KP_Home:
+      if (priv->window_start == 0)
+        return FALSE;
+
+      mx_entry_load_window (entry, 0, 0);
+      return TRUE;
+
+    case CLUTTER_KEY_End:
+    case CLUTTER_KEY_KP_End:
+      length = _mx_piece_table_get_length (priv->buffer);
+      if (priv->window_start + priv->window_length == length)
+        return FALSE;
+
+      mx_entry_load_window (entry, length, length);
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
 static void clutter_text_changed_cb (ClutterText *text, MxEntry     *entry);
 
 static void
@@ -630,7 +977,12 @@ clutter_text_focus_out_cb (ClutterText  *text,
   MxEntryPrivate *priv = MX_ENTRY_PRIV (actor);
 
   /* move the cursor back to the beginning of the entry */
-  clutter_text_set_cursor_position (CLUTTER_TEXT (priv->entry), 0);
+  if (priv->buffer && priv->window_start > 0)
+    {
+      mx_entry_load_window (MX_ENTRY (actor), 0, 0);
+    }
+  else
+    clutter_text_set_cursor_position (CLUTTER_TEXT (priv->entry), 0);
 
   clutter_text_set_cursor_visible (text, FALSE);
 }
@@ -672,16 +1024,12 @@ mx_entry_paint (ClutterActor *actor)
     {
       ClutterActorBox box;
       CoglTextureVertex top[4] = { { 0,}, };
-      ClutterColor *color;
       guint8 r, g, b;
       gfloat width, height;
 
-      mx_stylable_get (MX_STYLABLE (actor), "background-color", &color, NULL);
-
-      r = color->red;
-      g = color->green;
-      b = color->blue;
-      clutter_color_free (color);
+      r = priv->background_color.red;
+      g = priv->background_color.green;
+      b = priv->background_color.blue;
 
       cogl_set_source_color4ub (0, 0, 0, 0);
 
@@ -705,8 +1053,7 @@ mx_entry_paint (ClutterActor *actor)
       cogl_polygon (top, 4, TRUE);
     }
 
-  if (priv->placeholder
-      && !strcmp ("", clutter_text_get_text (CLUTTER_TEXT (priv->entry))))
+  if (priv->placeholder && mx_entry_is_empty (MX_ENTRY (actor)))
     {
       PangoLayout *layout;
       CoglColor color;
@@ -772,6 +1119,12 @@ mx_entry_clipboard_callback (MxClipboard *clipboard,
   if (!text)
     return;
 
+  if (((MxEntry *) data)->priv->buffer)
+    {
+      mx_entry_insert_large_text ((MxEntry *) data, text);
+      return;
+    }
+
   /* delete the current selection before pasting */
   clutter_text_delete_selection (ctext);
 
@@ -942,7 +1295,7 @@ mx_entry_key_press_event (ClutterActor    *actor,
       /* prevent storing the value just restored */
       priv->pause_undo = TRUE;
 
-      if (priv->undo_history)
+      if (priv->undo_history && g_queue_peek_head (priv->undo_history))
         {
           clutter_text_set_text (CLUTTER_TEXT (priv->entry),
                                  (gchar*) g_queue_peek_head (priv->undo_history));
@@ -1110,6 +1463,23 @@ mx_entry_class_init (MxEntryClass *klass)
                                    PROP_SECONDARY_ICON_TOOLTIP_TEXT,
                                    pspec);
 
+  /**
+   * MxEntry:large-text:
+   *
+   * Whether the entry is optimised for very long text. The text is then kept
+   * outside of the #ClutterText, which only holds the part of it around the
+   * cursor, so the cost of editing doesn't depend on the length of the text.
+   *
+   * Since: 2.0
+   */
+  pspec = g_param_spec_boolean ("large-text",
+                                "Large text",
+                                "Whether the entry is optimised for very "
+                                "long text",
+                                FALSE,
+                                MX_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_LARGE_TEXT, pspec);
+
   /* signals */
   /**
    * MxEntry::primary-icon-clicked:
@@ -1148,7 +1518,8 @@ mx_entry_store_undo_timeout (MxEntry *entry)
 
   priv->undo_timeout_source = 0;
 
-  str = mx_entry_get_text (entry);
+  /* in large-text mode, this is only the window around the cursor */
+  str = clutter_text_get_text (CLUTTER_TEXT (priv->entry));
 
   if (!priv->undo_history)
     priv->undo_history = g_queue_new ();
@@ -1222,18 +1593,13 @@ clutter_text_changed_cb (ClutterText *text,
 {
   MxEntryPrivate *priv = entry->priv;
 
-  g_object_notify (G_OBJECT (entry), "text");
+  if (priv->loading_window)
+    return;
 
-  /* set up the pseudo class for the placeholder */
-  if (priv->placeholder)
-    {
-      if (!strcmp (clutter_text_get_text (text), ""))
-        mx_stylable_style_pseudo_class_add (MX_STYLABLE (entry),
-                                            "indeterminate");
-      else
-        mx_stylable_style_pseudo_class_remove (MX_STYLABLE (entry),
-                                               "indeterminate");
-    }
+  if (priv->buffer)
+    mx_entry_queue_move_window (entry);
+
+  mx_entry_text_changed (entry);
 
   mx_entry_store_undo_history (text, entry);
 }
@@ -1299,9 +1665,21 @@ mx_entry_init (MxEntry *entry)
   g_signal_connect (priv->entry, "text-changed",
                     G_CALLBACK (clutter_text_changed_cb), entry);
 
+  g_signal_connect (priv->entry, "insert-text",
+                    G_CALLBACK (mx_entry_insert_text_cb), entry);
+
+  g_signal_connect (priv->entry, "delete-text",
+                    G_CALLBACK (mx_entry_delete_text_cb), entry);
+
   g_signal_connect (priv->entry, "key-press-event",
                     G_CALLBACK (mx_entry_store_undo_on_keypress), entry);
 
+  g_signal_connect (priv->entry, "key-press-event",
+                    G_CALLBACK (mx_entry_large_text_key_press_cb), entry);
+
+  g_signal_connect (priv->entry, "notify::position",
+                    G_CALLBACK (mx_entry_position_changed_cb), entry);
+
   g_signal_connect (priv->entry, "event", G_CALLBACK (entry_event), entry);
 
   priv->spacing = 6.0f;
@@ -1357,14 +1735,43 @@ mx_entry_new_with_text (const gchar *text)
  *
  * Get the text displayed on the entry
  *
+ * When the entry is in large-text mode (see mx_entry_set_large_text()), the
+ * text is assembled from its buffer the first time it's asked for after
+ * each change, which takes time proportional to the length of the whole
+ * text.
+ *
  * Returns: the text for the entry. This must not be freed by the application
  */
 const gchar *
 mx_entry_get_text (MxEntry *entry)
 {
+  MxEntryPrivate *priv;
+  GString *text;
+
   g_return_val_if_fail (MX_IS_ENTRY (entry), NULL);
 
-  return clutter_text_get_text (CLUTTER_TEXT (entry->priv->entry));
+  priv = entry->priv;
+
+  if (!priv->buffer)
+    return clutter_text_get_text (CLUTTER_TEXT (priv->entry));
+
+  /* assemble the text around the window, until it's changed again */
+  if (!priv->text)
+    {
+      text = g_string_sized_new (_mx_piece_table_get_length (priv->buffer)
+                                 + 1);
+
+      _mx_piece_table_get_text (priv->buffer, 0, priv->window_start, text);
+      g_string_append (text,
+                       clutter_text_get_text (CLUTTER_TEXT (priv->entry)));
+      _mx_piece_table_get_text (priv->buffer,
+                                priv->window_start + priv->window_length,
+                                G_MAXSIZE, text);
+
+      priv->text = g_string_free (text, FALSE);
+    }
+
+  return priv->text;
 }
 
 /**
@@ -1390,6 +1797,17 @@ mx_entry_set_text (MxEntry     *entry,
 
   priv = entry->priv;
 
+  if (priv->buffer)
+    {
+      _mx_piece_table_free (priv->buffer);
+      priv->buffer = _mx_piece_table_new (text, -1);
+
+      mx_entry_load_window (entry, 0, 0);
+      mx_entry_text_changed (entry);
+
+      return;
+    }
+
   clutter_text_set_text (CLUTTER_TEXT (priv->entry), text);
 }
 
@@ -1435,7 +1853,7 @@ mx_entry_set_placeholder (MxEntry     *entry,
 
   if (priv->placeholder)
     {
-      if (!strcmp (clutter_text_get_text (CLUTTER_TEXT (priv->entry)), ""))
+      if (mx_entry_is_empty (entry))
         mx_stylable_style_pseudo_class_add (MX_STYLABLE (entry),
                                             "indeterminate");
       else
@@ -1974,3 +2392,102 @@ mx_entry_set_icon_highlight_suffix (MxEntry *entry, const gchar* suffix)
   _mx_entry_create_highlight_icon (entry, 1);
   _mx_entry_create_highlight_icon (entry, 2);
 }
+
+/**
+ * mx_entry_set_large_text:
+ * @entry: a #MxEntry
+ * @large_text: %TRUE to optimise the entry for very long text
+ *
+ * Sets whether the entry is optimised for very long text, such as a log
+ * pasted into it. In this mode, the text is kept in a separate buffer and
+ * only the part of it around the cursor is loaded into the #ClutterText
+ * returned by mx_entry_get_clutter_text(), so it is the only part that gets
+ * laid out. The loaded part follows the cursor as it moves.
+ *
+ * Selections, and the undo history, are limited to the loaded part of the
+ * text.
+ *
+ * #MxEntry:text is still notified for every edit, but the whole text is
+ * only assembled when mx_entry_get_text() is called, so handlers that run
+ * on each keystroke should avoid calling it.
+ *
+ * Since: 2.0
+ */
+void
+mx_entry_set_large_text (MxEntry  *entry,
+                         gboolean  large_text)
+{
+  MxEntryPrivate *priv;
+  ClutterText *text;
+  gsize cursor, bound;
+  gchar *str;
+
+  g_return_if_fail (MX_IS_ENTRY (entry));
+
+  priv = entry->priv;
+  text = CLUTTER_TEXT (priv->entry);
+
+  if ((priv->buffer != NULL) == large_text)
+    return;
+
+  /* the window starts at 0 when the whole text is in the ClutterText */
+  cursor = clutter_text_get_cursor_position (text);
+  cursor = mx_entry_window_to_buffer (entry, cursor);
+  bound = clutter_text_get_selection_bound (text);
+  bound = mx_entry_window_to_buffer (entry, bound);
+
+  if (large_text)
+    {
+      str = (gchar *) clutter_text_get_text (text);
+
+      priv->buffer = _mx_piece_table_new (str, -1);
+      mx_entry_load_window (entry, cursor, bound);
+    }
+  else
+    {
+      str = g_strdup (mx_entry_get_text (entry));
+
+      if (priv->window_repaint_id)
+        {
+          clutter_threads_remove_repaint_func (priv->window_repaint_id);
+          priv->window_repaint_id = 0;
+        }
+
+      _mx_piece_table_free (priv->buffer);
+      priv->buffer = NULL;
+      priv->window_start = 0;
+
+      g_free (priv->text);
+      priv->text = NULL;
+
+      priv->loading_window = TRUE;
+      clutter_text_set_text (text, str);
+      clutter_text_set_selection (text,
+                                  g_utf8_pointer_to_offset (str, str + bound),
+                                  g_utf8_pointer_to_offset (str, str + cursor));
+      priv->loading_window = FALSE;
+
+      mx_entry_reset_undo_history (entry, str);
+    }
+
+  g_object_notify (G_OBJECT (entry), "large-text");
+}
+
+/**
+ * mx_entry_get_large_text:
+ * @entry: a #MxEntry
+ *
+ * Gets whether the entry is optimised for very long text. See
+ * mx_entry_set_large_text().
+ *
+ * Returns: %TRUE if the entry is optimised for very long text
+ *
+ * Since: 2.0
+ */
+gboolean
+mx_entry_get_large_text (MxEntry *entry)
+{
+  g_return_val_if_fail (MX_IS_ENTRY (entry), FALSE);
+
+  return entry->priv->buffer != NULL;
+}
@@ -108,6 +108,10 @@ void mx_entry_set_icon_highlight_suffix (MxEntry     *entry,
 
 const gchar *mx_entry_get_icon_highlight_suffix (MxEntry     *entry);
 
+void     mx_entry_set_large_text (MxEntry  *entry,
+                                  gboolean  large_text);
+gboolean mx_entry_get_large_text (MxEntry  *entry);
+
 G_END_DECLS
 
 #endif /* __MX_ENTRY_H__ */
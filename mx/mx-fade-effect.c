@@ -29,6 +29,16 @@
  * of a #ClutterActor. It provides a configurable bounding box, border
  * size and colour to control the fading effect.
  *
+ * The fade geometry only depends on the bounds and the border, and is kept
+ * in a vertex buffer between frames; the colour and the paint opacity are
+ * applied by the material, so animating them doesn't rebuild the geometry.
+ *
+ * By default the actor is rendered to an offscreen buffer that is faded as
+ * it is painted. When #MxFadeEffect:use-offscreen is %FALSE, the actor is
+ * painted directly and the faded borders are blended over it towards
+ * #MxFadeEffect:color instead, which avoids the extra render target. This is
+ * only suitable when the actor sits on a solid background of that colour.
+ *
  * Since: 1.2
  */
 
@@ -57,7 +67,9 @@ enum
 
   PROP_COLOR,
 
-  PROP_FREEZE_UPDATE
+  PROP_FREEZE_UPDATE,
+
+  PROP_USE_OFFSCREEN
 };
 
 struct _MxFadeEffectPrivate
@@ -71,12 +83,15 @@ struct _MxFadeEffectPrivate
   ClutterColor  color;
   gfloat        width;
   gfloat        height;
+  gfloat        fbo_width;
+  gfloat        fbo_height;
 
   CoglHandle    vbo;
   CoglHandle    indices;
   guint         n_quads;
 
   CoglMaterial *old_material;
+  CoglMaterial *overlay_material;
 
   gulong        blocked_id;
 
@@ -85,8 +100,11 @@ struct _MxFadeEffectPrivate
 
   guint         update_vbo    : 1;
   guint         freeze_update : 1;
+  guint         use_offscreen : 1;
 };
 
+static void mx_fade_effect_paint_overlay (MxFadeEffect *self);
+
 static void
 mx_fade_effect_get_property (GObject    *object,
                              guint       property_id,
@@ -137,6 +155,10 @@ mx_fade_effect_get_property (GObject    *object,
       g_value_set_boolean (value, priv->freeze_update);
       break;
 
+    case PROP_USE_OFFSCREEN:
+      g_value_set_boolean (value, priv->use_offscreen);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -186,13 +208,18 @@ mx_fade_effect_set_property (GObject      *object,
       break;
 
     case PROP_COLOR:
+      /* the colour is applied by the material, the geometry is unchanged */
       priv->color = *(clutter_value_get_color (value));
-      break;
+      return;
 
     case PROP_FREEZE_UPDATE:
       priv->freeze_update = g_value_get_boolean (value);
       return;
 
+    case PROP_USE_OFFSCREEN:
+      mx_fade_effect_set_use_offscreen (effect, g_value_get_boolean (value));
+      return;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       return;
@@ -212,6 +239,12 @@ mx_fade_effect_dispose (GObject *object)
       priv->vbo = NULL;
     }
 
+  if (priv->overlay_material)
+    {
+      cogl_object_unref (priv->overlay_material);
+      priv->overlay_material = NULL;
+    }
+
   if (priv->blocked_id)
     {
       ClutterActor *actor =
@@ -237,8 +270,8 @@ mx_fade_effect_create_texture (ClutterOffscreenEffect *effect,
 {
   MxFadeEffectPrivate *priv = MX_FADE_EFFECT (effect)->priv;
 
-  priv->width = width;
-  priv->height = height;
+  priv->width = priv->fbo_width = width;
+  priv->height = priv->fbo_height = height;
   priv->update_vbo = TRUE;
 
   return CLUTTER_OFFSCREEN_EFFECT_CLASS (mx_fade_effect_parent_class)->
@@ -263,7 +296,26 @@ mx_fade_effect_pre_paint (ClutterEffect *effect)
 {
   MxFadeEffectPrivate *priv = MX_FADE_EFFECT (effect)->priv;
 
-  if (!priv->freeze_update)
+  if (!priv->use_offscreen)
+    {
+      gfloat width, height;
+      ClutterActor *actor =
+        clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
+
+      /* The actor paints itself as normal, the border is faded over it
+       * in post-paint.
+       */
+      clutter_actor_get_size (actor, &width, &height);
+      if (width != priv->width || height != priv->height)
+        {
+          priv->width = width;
+          priv->height = height;
+          priv->update_vbo = TRUE;
+        }
+
+      return TRUE;
+    }
+  else if (!priv->freeze_update)
     {
       return CLUTTER_EFFECT_CLASS (mx_fade_effect_parent_class)->
         pre_paint (effect);
@@ -292,7 +344,9 @@ mx_fade_effect_post_paint (ClutterEffect *effect)
 {
   MxFadeEffectPrivate *priv = MX_FADE_EFFECT (effect)->priv;
 
-  if (!priv->freeze_update)
+  if (!priv->use_offscreen)
+    mx_fade_effect_paint_overlay (MX_FADE_EFFECT (effect));
+  else if (!priv->freeze_update)
     CLUTTER_EFFECT_CLASS (mx_fade_effect_parent_class)->post_paint (effect);
   else
     {
@@ -404,12 +458,12 @@ mx_fade_effect_update_vbo (MxFadeEffect *self)
 
   MxFadeEffectPrivate *priv = self->priv;
 
+  /* The vertex colours only hold the amount of fading, from none (opaque
+   * white) to full (transparent); the fade colour itself is applied by the
+   * material, so that changing it doesn't need new geometry.
+   */
   cogl_color_init_from_4ub (&opaque, 0xff, 0xff, 0xff, 0xff);
-  cogl_color_init_from_4ub (&color,
-                            priv->color.red,
-                            priv->color.green,
-                            priv->color.blue,
-                            priv->color.alpha);
+  cogl_color_init_from_4ub (&color, 0, 0, 0, 0);
 
   /* Validate the bounds */
   x1 = priv->x;
@@ -609,6 +663,20 @@ mx_fade_effect_update_vbo (MxFadeEffect *self)
   priv->update_vbo = FALSE;
 }
 
+static void
+mx_fade_effect_draw_vbo (MxFadeEffect *self)
+{
+  MxFadeEffectPrivate *priv = self->priv;
+
+  cogl_vertex_buffer_draw_elements (priv->vbo,
+                                    COGL_VERTICES_MODE_TRIANGLES,
+                                    priv->indices,
+                                    0,
+                                    (priv->n_quads * 4) - 1,
+                                    0,
+                                    priv->n_quads * 6);
+}
+
 static void
 mx_fade_effect_paint_target (ClutterOffscreenEffect *effect)
 {
@@ -626,16 +694,26 @@ mx_fade_effect_paint_target (ClutterOffscreenEffect *effect)
   if (!priv->vbo || !priv->indices || !material)
     return;
 
-  /* Set the blend string if the material has changed so we can blend with
-   * the paint opacity.
+  /* Set the blend strings if the material has changed. The texture is
+   * modulated by the fade colour, then interpolated back towards the plain
+   * texture using the amount of fading in the vertex colours, and finally
+   * blended with the paint opacity.
    */
   if (material != priv->old_material)
     {
       GError *error = NULL;
       priv->old_material = material;
 
-      if (!cogl_material_set_layer_combine (material, 1,
-                                            "RGBA = MODULATE(PREVIOUS,CONSTANT)", &error))
+      if (!cogl_material_set_layer_combine (material, 0,
+                                            "RGBA = MODULATE(TEXTURE,CONSTANT)",
+                                            &error) ||
+          !cogl_material_set_layer_combine (material, 1,
+                                            "RGBA = INTERPOLATE(TEXTURE_0,"
+                                            "PREVIOUS,PRIMARY)",
+                                            &error) ||
+          !cogl_material_set_layer_combine (material, 2,
+                                            "RGBA = MODULATE(PREVIOUS,CONSTANT)",
+                                            &error))
         {
           g_warning (G_STRLOC ": Error setting layer combine blend string: %s",
                      error->message);
@@ -643,23 +721,73 @@ mx_fade_effect_paint_target (ClutterOffscreenEffect *effect)
         }
     }
 
+  cogl_color_init_from_4ub (&color,
+                            priv->color.red,
+                            priv->color.green,
+                            priv->color.blue,
+                            priv->color.alpha);
+  cogl_material_set_layer_combine_constant (material, 0, &color);
+
   /* Set the layer-combine constant so the texture is blended with the paint
    * opacity when painted.
    */
   actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
   opacity = clutter_actor_get_paint_opacity (actor);
   cogl_color_init_from_4ub (&color, opacity, opacity, opacity, opacity);
-  cogl_material_set_layer_combine_constant (material, 1, &color);
+  cogl_material_set_layer_combine_constant (material, 2, &color);
 
   /* Draw the texture */
   cogl_set_source (material);
-  cogl_vertex_buffer_draw_elements (priv->vbo,
-                                    COGL_VERTICES_MODE_TRIANGLES,
-                                    priv->indices,
-                                    0,
-                                    (priv->n_quads * 4) - 1,
-                                    0,
-                                    priv->n_quads * 6);
+  mx_fade_effect_draw_vbo (self);
+}
+
+static void
+mx_fade_effect_paint_overlay (MxFadeEffect *self)
+{
+  ClutterActor *actor;
+  CoglColor color;
+  guint8 opacity;
+
+  MxFadeEffectPrivate *priv = self->priv;
+
+  if (priv->update_vbo)
+    mx_fade_effect_update_vbo (self);
+
+  if (!priv->vbo || !priv->indices)
+    return;
+
+  if (!priv->overlay_material)
+    {
+      GError *error = NULL;
+
+      /* Paint the fade colour, weighted by the amount of fading in the
+       * vertex colours, over what the actor has already painted.
+       */
+      priv->overlay_material = cogl_material_new ();
+      if (!cogl_material_set_layer_combine (priv->overlay_material, 0,
+                                            "RGBA = MODULATE(CONSTANT,"
+                                            "(1-PRIMARY[A]))",
+                                            &error))
+        {
+          g_warning (G_STRLOC ": Error setting layer combine blend string: %s",
+                     error->message);
+          g_error_free (error);
+        }
+    }
+
+  actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (self));
+  opacity = clutter_actor_get_paint_opacity (actor);
+
+  cogl_color_init_from_4ub (&color,
+                            priv->color.red,
+                            priv->color.green,
+                            priv->color.blue,
+                            priv->color.alpha * opacity / 255);
+  cogl_color_premultiply (&color);
+  cogl_material_set_layer_combine_constant (priv->overlay_material, 0, &color);
+
+  cogl_set_source (priv->overlay_material);
+  mx_fade_effect_draw_vbo (self);
 }
 
 static void
@@ -757,12 +885,29 @@ mx_fade_effect_class_init (MxFadeEffectClass *klass)
                                 MX_PARAM_READWRITE |
                                 MX_PARAM_TRANSLATEABLE);
   g_object_class_install_property (object_class, PROP_FREEZE_UPDATE, pspec);
+
+  /**
+   * MxFadeEffect:use-offscreen:
+   *
+   * Whether to render the actor to an offscreen buffer and fade it, or to
+   * paint the actor directly and fade its borders to #MxFadeEffect:color.
+   *
+   * Since: 2.0
+   */
+  pspec = g_param_spec_boolean ("use-offscreen",
+                                "Use offscreen",
+                                "Fade the actor through an offscreen buffer",
+                                TRUE,
+                                MX_PARAM_READWRITE);
+  g_object_class_install_property (object_class, PROP_USE_OFFSCREEN, pspec);
 }
 
 static void
 mx_fade_effect_init (MxFadeEffect *self)
 {
   self->priv = FADE_EFFECT_PRIVATE (self);
+
+  self->priv->use_offscreen = TRUE;
 }
 
 /**
@@ -811,29 +956,31 @@ mx_fade_effect_set_border (MxFadeEffect *effect,
   if (priv->border[0] != top)
     {
       priv->border[0] = top;
+      priv->update_vbo = TRUE;
       g_object_notify (G_OBJECT (effect), "border-top");
     }
 
   if (priv->border[1] != right)
     {
       priv->border[1] = right;
+      priv->update_vbo = TRUE;
       g_object_notify (G_OBJECT (effect), "border-right");
     }
 
   if (priv->border[2] != bottom)
     {
       priv->border[2] = bottom;
+      priv->update_vbo = TRUE;
       g_object_notify (G_OBJECT (effect), "border-bottom");
     }
 
   if (priv->border[3] != left)
     {
       priv->border[3] = left;
+      priv->update_vbo = TRUE;
       g_object_notify (G_OBJECT (effect), "border-left");
     }
 
-  priv->update_vbo = TRUE;
-
   g_object_thaw_notify (G_OBJECT (effect));
 }
 
@@ -894,7 +1041,6 @@ mx_fade_effect_set_color (MxFadeEffect       *effect,
   if (!clutter_color_equal (&priv->color, color))
     {
       priv->color = *color;
-      priv->update_vbo = TRUE;
       g_object_notify (G_OBJECT (effect), "color");
     }
 }
@@ -959,29 +1105,31 @@ mx_fade_effect_set_bounds (MxFadeEffect *effect,
   if (priv->x != x)
     {
       priv->x = x;
+      priv->update_vbo = TRUE;
       g_object_notify (G_OBJECT (effect), "bounds-x");
     }
 
   if (priv->y != y)
     {
       priv->y = y;
+      priv->update_vbo = TRUE;
       g_object_notify (G_OBJECT (effect), "bounds-y");
     }
 
   if (priv->bounds_width != width)
     {
       priv->bounds_width = width;
+      priv->update_vbo = TRUE;
       g_object_notify (G_OBJECT (effect), "bounds-width");
     }
 
   if (priv->bounds_height != height)
     {
       priv->bounds_height = height;
+      priv->update_vbo = TRUE;
       g_object_notify (G_OBJECT (effect), "bounds-height");
     }
 
-  priv->update_vbo = TRUE;
-
   g_object_thaw_notify (G_OBJECT (effect));
 }
 
@@ -1068,3 +1216,63 @@ _mx_fade_effect_get_freeze_update (MxFadeEffect *effect)
   g_return_val_if_fail (MX_IS_FADE_EFFECT (effect), FALSE);
   return effect->priv->freeze_update;
 }
+
+/**
+ * mx_fade_effect_set_use_offscreen:
+ * @effect: A #MxFadeEffect
+ * @use_offscreen: %TRUE to fade through an offscreen buffer
+ *
+ * Sets whether the actor is rendered to an offscreen buffer that is faded
+ * when painted, or painted directly with its borders faded to the colour
+ * set with mx_fade_effect_set_color(). Painting directly avoids the extra
+ * render target, but is only correct when the actor is on a solid
+ * background of that colour.
+ *
+ * Since: 2.0
+ */
+void
+mx_fade_effect_set_use_offscreen (MxFadeEffect *effect,
+                                  gboolean      use_offscreen)
+{
+  MxFadeEffectPrivate *priv;
+  ClutterActor *actor;
+
+  g_return_if_fail (MX_IS_FADE_EFFECT (effect));
+
+  priv = effect->priv;
+  if (priv->use_offscreen != use_offscreen)
+    {
+      priv->use_offscreen = use_offscreen;
+
+      /* the geometry is sized to the offscreen buffer or to the actor */
+      if (use_offscreen)
+        {
+          priv->width = priv->fbo_width;
+          priv->height = priv->fbo_height;
+        }
+      priv->update_vbo = TRUE;
+
+      actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
+      if (actor)
+        clutter_actor_queue_redraw (actor);
+
+      g_object_notify (G_OBJECT (effect), "use-offscreen");
+    }
+}
+
+/**
+ * mx_fade_effect_get_use_offscreen:
+ * @effect: A #MxFadeEffect
+ *
+ * Determines whether @effect fades through an offscreen buffer.
+ *
+ * Returns: %TRUE if an offscreen buffer is used, %FALSE otherwise
+ *
+ * Since: 2.0
+ */
+gboolean
+mx_fade_effect_get_use_offscreen (MxFadeEffect *effect)
+{
+  g_return_val_if_fail (MX_IS_FADE_EFFECT (effect), TRUE);
+  return effect->priv->use_offscreen;
+}
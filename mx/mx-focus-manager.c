@@ -23,7 +23,10 @@
 #include "mx-focus-manager.h"
 #include "mx-focusable.h"
 #include "mx-private.h"
+#include "mx-scrollable.h"
+#include "mx-widget.h"
 
+#include <math.h>
 #include <clutter/clutter-keysyms.h>
 
 G_DEFINE_TYPE (MxFocusManager, mx_focus_manager, G_TYPE_OBJECT)
@@ -40,14 +43,53 @@ struct _MxFocusManagerPrivate
   MxFocusable *focused;
   MxFocusable *focused_toplevel;
   guint        refocus_idle;
+
+  guint        spatial_navigation : 1;
+
+  /* The focusables that take the focus themselves, with their bounds on
+   * the stage, for spatial navigation. Each bucket lists the ones that
+   * overlap a cell of the stage. The index is dropped when the stage is
+   * relaid out, an indexed focusable is mapped or unmapped, or a
+   * scrollable it is in scrolls, and is built again on the next move.
+   * Transformations don't relayout, so the bounds of the nearest focusable
+   * are checked again before it's given the focus. */
+  GArray      *index;
+  GPtrArray   *index_buckets;
+  GPtrArray   *index_adjustments;
+
+  /* the focusables that have been indexed while on the stage, which are
+   * watched for being mapped and unmapped until they leave it */
+  GHashTable  *index_watched;
+  guint        index_columns;
+  guint        index_rows;
+  guint        index_serial;
 };
 
 enum
 {
   PROP_STAGE = 1,
-  PROP_FOCUSED
+  PROP_FOCUSED,
+  PROP_SPATIAL_NAVIGATION
 };
 
+/* A focusable that can receive the focus directly, and its bounds on the
+ * stage, as indexed for directional navigation */
+typedef struct
+{
+  MxFocusable     *focusable;
+  ClutterActorBox  box;
+
+  /* the last search that looked at the focusable */
+  guint            serial;
+} MxFocusCandidate;
+
+/* The size of the cells of the spatial index, in pixels */
+#define MX_FOCUS_INDEX_CELL_SIZE 128
+
+static void mx_focus_manager_invalidate_index (MxFocusManager *manager);
+static void mx_focus_manager_unwatch_candidate (MxFocusManager *manager,
+                                                ClutterActor   *actor);
+
 static void mx_focus_manager_set_focused (MxFocusManager *manager, MxFocusable *focusable);
 
 static void
@@ -68,6 +110,10 @@ mx_focus_manager_get_property (GObject    *object,
     g_value_set_object (value, priv->focused);
     break;
 
+  case PROP_SPATIAL_NAVIGATION:
+    g_value_set_boolean (value, priv->spatial_navigation);
+    break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -79,8 +125,15 @@ mx_focus_manager_set_property (GObject      *object,
                                const GValue *value,
                                GParamSpec   *pspec)
 {
+  MxFocusManager *manager = MX_FOCUS_MANAGER (object);
+
   switch (property_id)
     {
+    case PROP_SPATIAL_NAVIGATION:
+      mx_focus_manager_set_spatial_navigation (manager,
+                                               g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -100,6 +153,9 @@ mx_focus_manager_dispose (GObject *object)
 
   if (priv->stage)
     {
+      g_signal_handlers_disconnect_by_func (priv->stage,
+                                            mx_focus_manager_invalidate_index,
+                                            self);
       g_object_set_qdata (G_OBJECT (priv->stage), focus_manager_quark, NULL);
       priv->stage = NULL;
     }
@@ -107,6 +163,21 @@ mx_focus_manager_dispose (GObject *object)
   if (priv->focused || priv->focused_toplevel)
     mx_focus_manager_set_focused (self, NULL);
 
+  mx_focus_manager_invalidate_index (self);
+
+  if (priv->index_watched)
+    {
+      GList *watched, *l;
+
+      watched = g_hash_table_get_keys (priv->index_watched);
+      for (l = watched; l; l = l->next)
+        mx_focus_manager_unwatch_candidate (self, l->data);
+      g_list_free (watched);
+
+      g_hash_table_destroy (priv->index_watched);
+      priv->index_watched = NULL;
+    }
+
   G_OBJECT_CLASS (mx_focus_manager_parent_class)->dispose (object);
 }
 
@@ -143,6 +214,25 @@ mx_focus_manager_class_init (MxFocusManagerClass *klass)
                                MX_PARAM_READABLE);
   g_object_class_install_property (object_class, PROP_FOCUSED, pspec);
 
+  /**
+   * MxFocusManager:spatial-navigation:
+   *
+   * Whether focus moves up, down, left and right go to the nearest
+   * focusable in that direction on the stage, whichever container it is
+   * in, instead of being handled by the containers of the focused actor.
+   *
+   * Since: 2.0
+   */
+  pspec = g_param_spec_boolean ("spatial-navigation",
+                                "Spatial navigation",
+                                "Whether directional focus moves are "
+                                "resolved from the position of the "
+                                "focusables on the stage",
+                                FALSE,
+                                MX_PARAM_READWRITE);
+  g_object_class_install_property (object_class, PROP_SPATIAL_NAVIGATION,
+                                   pspec);
+
   focus_manager_quark = g_quark_from_static_string ("mx-focus-manager");
 }
 
@@ -150,6 +240,8 @@ static void
 mx_focus_manager_init (MxFocusManager *self)
 {
   self->priv = FOCUS_MANAGER_PRIVATE (self);
+
+  self->priv->index_watched = g_hash_table_new (NULL, NULL);
 }
 
 static void
@@ -331,6 +423,600 @@ mx_focus_manager_ensure_focused (MxFocusManager *manager,
   return (priv->focused) ? TRUE : FALSE;
 }
 
+static void
+mx_focus_manager_get_stage_box (ClutterActor    *actor,
+                                ClutterActorBox *box)
+{
+  ClutterVertex verts[4];
+
+  clutter_actor_get_abs_allocation_vertices (actor, verts);
+  clutter_actor_box_from_vertices (box, verts);
+}
+
+static void
+mx_focus_manager_invalidate_index (MxFocusManager *manager)
+{
+  MxFocusManagerPrivate *priv = manager->priv;
+  guint i;
+
+  if (!priv->index)
+    return;
+
+  for (i = 0; i < priv->index_adjustments->len; i++)
+    {
+      MxAdjustment *adjustment = g_ptr_array_index (priv->index_adjustments, i);
+
+      g_signal_handlers_disconnect_by_func (adjustment,
+                                            mx_focus_manager_invalidate_index,
+                                            manager);
+    }
+
+  g_array_free (priv->index, TRUE);
+  g_ptr_array_free (priv->index_buckets, TRUE);
+  g_ptr_array_free (priv->index_adjustments, TRUE);
+
+  priv->index = NULL;
+  priv->index_buckets = NULL;
+  priv->index_adjustments = NULL;
+}
+
+static void
+mx_focus_manager_candidate_weak_notify (MxFocusManager *manager,
+                                        GObject        *where_the_object_was)
+{
+  g_hash_table_remove (manager->priv->index_watched, where_the_object_was);
+  mx_focus_manager_invalidate_index (manager);
+}
+
+static void
+mx_focus_manager_candidate_mapped_cb (ClutterActor   *actor,
+                                      GParamSpec     *pspec,
+                                      MxFocusManager *manager)
+{
+  mx_focus_manager_invalidate_index (manager);
+
+  if (clutter_actor_get_stage (actor) != manager->priv->stage)
+    mx_focus_manager_unwatch_candidate (manager, actor);
+}
+
+static void
+mx_focus_manager_watch_candidate (MxFocusManager *manager,
+                                  ClutterActor   *actor)
+{
+  MxFocusManagerPrivate *priv = manager->priv;
+
+  if (g_hash_table_lookup (priv->index_watched, actor))
+    return;
+
+  g_hash_table_insert (priv->index_watched, actor, actor);
+  g_signal_connect (actor, "notify::mapped",
+                    G_CALLBACK (mx_focus_manager_candidate_mapped_cb),
+                    manager);
+  g_object_weak_ref (G_OBJECT (actor),
+                     (GWeakNotify) mx_focus_manager_candidate_weak_notify,
+                     manager);
+}
+
+static void
+mx_focus_manager_unwatch_candidate (MxFocusManager *manager,
+                                    ClutterActor   *actor)
+{
+  g_signal_handlers_disconnect_by_func (actor,
+                                        mx_focus_manager_candidate_mapped_cb,
+                                        manager);
+  g_object_weak_unref (G_OBJECT (actor),
+                       (GWeakNotify) mx_focus_manager_candidate_weak_notify,
+                       manager);
+  g_hash_table_remove (manager->priv->index_watched, actor);
+}
+
+static void
+mx_focus_manager_index_adjustment (MxFocusManager *manager,
+                                   MxAdjustment   *adjustment)
+{
+  MxFocusManagerPrivate *priv = manager->priv;
+  guint i;
+
+  if (!adjustment)
+    return;
+
+  /* scroll views share the adjustments of their child */
+  for (i = 0; i < priv->index_adjustments->len; i++)
+    if (g_ptr_array_index (priv->index_adjustments, i) == adjustment)
+      return;
+
+  g_ptr_array_add (priv->index_adjustments, g_object_ref (adjustment));
+  g_signal_connect_swapped (adjustment, "notify::value",
+                            G_CALLBACK (mx_focus_manager_invalidate_index),
+                            manager);
+}
+
+/* Adds the focusables below @actor that don't contain any other focusable,
+ * which are the ones that take the focus themselves, to the index. Returns
+ * whether @actor is or contains a focusable.
+ */
+static gboolean
+mx_focus_manager_collect (MxFocusManager *manager,
+                          ClutterActor   *actor)
+{
+  MxFocusManagerPrivate *priv = manager->priv;
+  ClutterActorIter iter;
+  ClutterActor *child;
+  MxFocusCandidate candidate = { 0, };
+  gboolean contains_focusable = FALSE;
+
+  clutter_actor_iter_init (&iter, actor);
+  while (clutter_actor_iter_next (&iter, &child))
+    {
+      if (CLUTTER_ACTOR_IS_MAPPED (child) &&
+          mx_focus_manager_collect (manager, child))
+        contains_focusable = TRUE;
+    }
+
+  /* scrolling moves the focusables without a relayout */
+  if (contains_focusable && MX_IS_SCROLLABLE (actor))
+    {
+      MxAdjustment *hadjust, *vadjust;
+
+      mx_scrollable_get_adjustments (MX_SCROLLABLE (actor), &hadjust, &vadjust);
+      mx_focus_manager_index_adjustment (manager, hadjust);
+      mx_focus_manager_index_adjustment (manager, vadjust);
+    }
+
+  if (!MX_IS_FOCUSABLE (actor))
+    return contains_focusable;
+
+  if (contains_focusable)
+    return TRUE;
+
+  candidate.focusable = MX_FOCUSABLE (actor);
+  mx_focus_manager_get_stage_box (actor, &candidate.box);
+  g_array_append_val (priv->index, candidate);
+
+  mx_focus_manager_watch_candidate (manager, actor);
+
+  return TRUE;
+}
+
+static void
+mx_focus_manager_free_bucket (gpointer bucket)
+{
+  if (bucket)
+    g_array_free (bucket, TRUE);
+}
+
+static guint
+mx_focus_manager_index_cell (gfloat position,
+                             guint  n_cells)
+{
+  gint cell = floorf (position / MX_FOCUS_INDEX_CELL_SIZE);
+
+  return CLAMP (cell, 0, (gint) n_cells - 1);
+}
+
+static void
+mx_focus_manager_ensure_index (MxFocusManager *manager)
+{
+  MxFocusManagerPrivate *priv = manager->priv;
+  gfloat width, height;
+  guint i, n_buckets;
+
+  if (priv->index)
+    return;
+
+  priv->index = g_array_new (FALSE, FALSE, sizeof (MxFocusCandidate));
+  priv->index_adjustments = g_ptr_array_new_with_free_func (g_object_unref);
+  mx_focus_manager_collect (manager, priv->stage);
+
+  clutter_actor_get_size (priv->stage, &width, &height);
+  priv->index_columns = MAX (1, ceilf (width / MX_FOCUS_INDEX_CELL_SIZE));
+  priv->index_rows = MAX (1, ceilf (height / MX_FOCUS_INDEX_CELL_SIZE));
+
+  n_buckets = priv->index_columns * priv->index_rows;
+  priv->index_buckets =
+    g_ptr_array_new_with_free_func (mx_focus_manager_free_bucket);
+  g_ptr_array_set_size (priv->index_buckets, n_buckets);
+
+  for (i = 0; i < priv->index->len; i++)
+    {
+      MxFocusCandidate *candidate =
+        &g_array_index (priv->index, MxFocusCandidate, i);
+      guint column, row, first_column, last_column, first_row, last_row;
+
+      first_column = mx_focus_manager_index_cell (candidate->box.x1,
+                                                  priv->index_columns);
+      last_column = mx_focus_manager_index_cell (candidate->box.x2,
+                                                 priv->index_columns);
+      first_row = mx_focus_manager_index_cell (candidate->box.y1,
+                                               priv->index_rows);
+      last_row = mx_focus_manager_index_cell (candidate->box.y2,
+                                              priv->index_rows);
+
+      for (row = first_row; row <= last_row; row++)
+        for (column = first_column; column <= last_column; column++)
+          {
+            guint bucket_index = row * priv->index_columns + column;
+            GArray *bucket = g_ptr_array_index (priv->index_buckets,
+                                                bucket_index);
+
+            if (!bucket)
+              {
+                bucket = g_array_new (FALSE, FALSE, sizeof (guint));
+                g_ptr_array_index (priv->index_buckets, bucket_index) = bucket;
+              }
+
+            g_array_append_val (bucket, i);
+          }
+    }
+
+  MX_NOTE (FOCUS, "Indexed %u focusables in %ux%u cells",
+           priv->index->len, priv->index_columns, priv->index_rows);
+}
+
+/* Returns how far @box is from @from in @direction, or -1 if it isn't in
+ * that direction. The offset across the direction counts twice, so that
+ * aligned focusables are preferred over closer ones to the side, and the
+ * distance between the centres breaks ties.
+ */
+static gfloat
+mx_focus_manager_score (const ClutterActorBox *from,
+                        const ClutterActorBox *box,
+                        MxFocusDirection       direction)
+{
+  gfloat along, across, centres;
+
+  switch (direction)
+    {
+    case MX_FOCUS_DIRECTION_LEFT:
+    case MX_FOCUS_DIRECTION_RIGHT:
+      if (direction == MX_FOCUS_DIRECTION_RIGHT)
+        {
+          if (box->x1 + box->x2 <= from->x1 + from->x2)
+            return -1;
+          along = box->x1 - from->x2;
+        }
+      else
+        {
+          if (box->x1 + box->x2 >= from->x1 + from->x2)
+            return -1;
+          along = from->x1 - box->x2;
+        }
+      across = MAX (box->y1 - from->y2, from->y1 - box->y2);
+      centres = ABS ((box->y1 + box->y2) - (from->y1 + from->y2)) / 2;
+      break;
+
+    case MX_FOCUS_DIRECTION_UP:
+    case MX_FOCUS_DIRECTION_DOWN:
+      if (direction == MX_FOCUS_DIRECTION_DOWN)
+        {
+          if (box->y1 + box->y2 <= from->y1 + from->y2)
+            return -1;
+          along = box->y1 - from->y2;
+        }
+      else
+        {
+          if (box->y1 + box->y2 >= from->y1 + from->y2)
+            return -1;
+          along = from->y1 - box->y2;
+        }
+      across = MAX (box->x1 - from->x2, from->x1 - box->x2);
+      centres = ABS ((box->x1 + box->x2) - (from->x1 + from->x2)) / 2;
+      break;
+
+    default:
+      return -1;
+    }
+
+  /* overlapping boxes are as close as adjacent ones */
+  return MAX (along, 0) + 2 * MAX (across, 0) + centres / 100;
+}
+
+/* Scrolls the scrollable parents of @actor so that it is visible, as
+ * containers do when they move the focus themselves */
+static void
+mx_focus_manager_scroll_to (ClutterActor *actor)
+{
+  MxAdjustment *handled[2] = { NULL, NULL };
+  ClutterActor *parent;
+
+  for (parent = clutter_actor_get_parent (actor);
+       parent;
+       parent = clutter_actor_get_parent (parent))
+    {
+      MxAdjustment *adjustments[2];
+      ClutterVertex verts[4];
+      ClutterActorBox box;
+      gint i;
+
+      if (!MX_IS_SCROLLABLE (parent))
+        continue;
+
+      mx_scrollable_get_adjustments (MX_SCROLLABLE (parent),
+                                     &adjustments[0], &adjustments[1]);
+
+      /* Scroll views forward the adjustments of their child, which the
+       * bounds were already made visible in */
+      if (adjustments[0] == handled[0] && adjustments[1] == handled[1])
+        continue;
+
+      /* The bounds of the actor in the coordinates of the content of the
+       * scrollable, which is what the adjustments are in */
+      clutter_actor_get_allocation_vertices (actor, parent, verts);
+      clutter_actor_box_from_vertices (&box, verts);
+
+      for (i = 0; i < 2; i++)
+        {
+          gdouble value, new_value, lower, upper, page_size, start, end;
+
+          if (!adjustments[i] || adjustments[i] == handled[i])
+            continue;
+
+          mx_adjustment_get_values (adjustments[i], &value, &lower, &upper,
+                                    NULL, NULL, &page_size);
+
+          start = (i == 0) ? box.x1 : box.y1;
+          end = (i == 0) ? box.x2 : box.y2;
+
+          /* the start takes precedence when the actor is too big */
+          new_value = value;
+          if (end > new_value + page_size)
+            new_value = end - page_size;
+          if (start < new_value)
+            new_value = start;
+
+          new_value = CLAMP (new_value, lower, MAX (lower, upper - page_size));
+
+          if (new_value != value)
+            mx_adjustment_interpolate (adjustments[i], new_value,
+                                       250, CLUTTER_EASE_OUT_CUBIC);
+        }
+
+      handled[0] = adjustments[0];
+      handled[1] = adjustments[1];
+    }
+}
+
+/* Finds the focusable nearest to @from in @direction that isn't in @tried.
+ * Only the cells in that direction are searched, from the nearest, until
+ * no focusable in the next ones could be nearer than the best one found.
+ */
+static MxFocusCandidate *
+mx_focus_manager_find_nearest (MxFocusManager        *manager,
+                               const ClutterActorBox *from,
+                               MxFocusDirection       direction,
+                               GPtrArray             *tried)
+{
+  MxFocusManagerPrivate *priv = manager->priv;
+  ClutterActor *focused = CLUTTER_ACTOR (priv->focused);
+  MxFocusCandidate *best = NULL;
+  gfloat best_score = 0;
+  gboolean horizontal;
+  guint n_lines, n_cells;
+  gint line, start, step;
+
+  horizontal = (direction == MX_FOCUS_DIRECTION_LEFT ||
+                direction == MX_FOCUS_DIRECTION_RIGHT);
+
+  /* Walk the columns, or the rows, from the one holding the centre of
+   * @from, in @direction */
+  n_lines = horizontal ? priv->index_columns : priv->index_rows;
+  n_cells = horizontal ? priv->index_rows : priv->index_columns;
+  start = horizontal ?
+    mx_focus_manager_index_cell ((from->x1 + from->x2) / 2, n_lines) :
+    mx_focus_manager_index_cell ((from->y1 + from->y2) / 2, n_lines);
+  step = (direction == MX_FOCUS_DIRECTION_RIGHT ||
+          direction == MX_FOCUS_DIRECTION_DOWN) ? 1 : -1;
+
+  priv->index_serial++;
+
+  for (line = start; line >= 0 && line < (gint) n_lines; line += step)
+    {
+      guint cell;
+
+      /* Focusables first seen in this line start beyond its near edge,
+       * which bounds how close they can be */
+      if (best && line != start)
+        {
+          gfloat edge, min_distance;
+
+          switch (direction)
+            {
+            case MX_FOCUS_DIRECTION_RIGHT:
+              edge = line * MX_FOCUS_INDEX_CELL_SIZE;
+              min_distance = edge - from->x2;
+              break;
+            case MX_FOCUS_DIRECTION_LEFT:
+              edge = (line + 1) * MX_FOCUS_INDEX_CELL_SIZE;
+              min_distance = from->x1 - edge;
+              break;
+            case MX_FOCUS_DIRECTION_DOWN:
+              edge = line * MX_FOCUS_INDEX_CELL_SIZE;
+              min_distance = edge - from->y2;
+              break;
+            default:
+              edge = (line + 1) * MX_FOCUS_INDEX_CELL_SIZE;
+              min_distance = from->y1 - edge;
+              break;
+            }
+
+          if (min_distance >= best_score)
+            break;
+        }
+
+      for (cell = 0; cell < n_cells; cell++)
+        {
+          GArray *bucket;
+          guint i;
+
+          bucket = g_ptr_array_index (priv->index_buckets,
+                                      horizontal ?
+                                      cell * priv->index_columns + line :
+                                      line * priv->index_columns + cell);
+          if (!bucket)
+            continue;
+
+          for (i = 0; i < bucket->len; i++)
+            {
+              MxFocusCandidate *candidate;
+              ClutterActor *actor;
+              gfloat score;
+              guint j;
+
+              candidate = &g_array_index (priv->index, MxFocusCandidate,
+                                          g_array_index (bucket, guint, i));
+              if (candidate->serial == priv->index_serial)
+                continue;
+
+              candidate->serial = priv->index_serial;
+              actor = CLUTTER_ACTOR (candidate->focusable);
+
+              for (j = 0; j < tried->len; j++)
+                if (g_ptr_array_index (tried, j) == actor)
+                  break;
+
+              if (j < tried->len ||
+                  clutter_actor_contains (actor, focused) ||
+                  clutter_actor_contains (focused, actor) ||
+                  (MX_IS_WIDGET (actor) &&
+                   mx_widget_get_disabled (MX_WIDGET (actor))))
+                continue;
+
+              score = mx_focus_manager_score (from, &candidate->box,
+                                              direction);
+
+              if (score >= 0 && (!best || score < best_score))
+                {
+                  best = candidate;
+                  best_score = score;
+                }
+            }
+        }
+    }
+
+  return best;
+}
+
+/* Tells the containers of @focusable which of their children holds the
+ * focus, as they do themselves when they move the focus, so that they
+ * give it back there when they get the focus again */
+static void
+mx_focus_manager_notify_parents (MxFocusable *focusable)
+{
+  ClutterActor *actor, *parent;
+  MxFocusable *from = focusable;
+
+  for (actor = CLUTTER_ACTOR (focusable),
+       parent = clutter_actor_get_parent (actor);
+       parent;
+       actor = parent, parent = clutter_actor_get_parent (parent))
+    {
+      if (MX_IS_FOCUSABLE (actor))
+        from = MX_FOCUSABLE (actor);
+
+      if (MX_IS_BOX_LAYOUT (parent))
+        _mx_box_layout_set_last_focus (MX_BOX_LAYOUT (parent), from);
+      else if (MX_IS_GRID (parent))
+        _mx_grid_set_last_focus (MX_GRID (parent), from);
+      else if (MX_IS_TABLE (parent))
+        _mx_table_set_last_focus (MX_TABLE (parent), from);
+    }
+}
+
+/* Moves the focus to the focusable nearest to the focused one in
+ * @direction, anywhere on the stage. Returns %FALSE if there is none. */
+static gboolean
+mx_focus_manager_move_focus_spatial (MxFocusManager   *manager,
+                                     MxFocusDirection  direction)
+{
+  MxFocusManagerPrivate *priv = manager->priv;
+  MxFocusable *old_focus = priv->focused;
+  MxFocusable *new_focused = NULL;
+  MxFocusCandidate *best;
+  ClutterActorBox from, box;
+  GPtrArray *tried;
+  MxFocusHint hint;
+  gboolean moved_out = FALSE;
+
+  switch (direction)
+    {
+    case MX_FOCUS_DIRECTION_UP:
+      hint = MX_FOCUS_HINT_FROM_BELOW;
+      break;
+    case MX_FOCUS_DIRECTION_DOWN:
+      hint = MX_FOCUS_HINT_FROM_ABOVE;
+      break;
+    case MX_FOCUS_DIRECTION_LEFT:
+      hint = MX_FOCUS_HINT_FROM_RIGHT;
+      break;
+    case MX_FOCUS_DIRECTION_RIGHT:
+      hint = MX_FOCUS_HINT_FROM_LEFT;
+      break;
+    default:
+      return FALSE;
+    }
+
+  mx_focus_manager_get_stage_box (CLUTTER_ACTOR (old_focus), &from);
+
+  /* Try the candidates from the nearest, as they may refuse the focus.
+   * Moving the focus may change the layout and drop the index. */
+  tried = g_ptr_array_new ();
+  while (!new_focused)
+    {
+      mx_focus_manager_ensure_index (manager);
+
+      best = mx_focus_manager_find_nearest (manager, &from, direction, tried);
+      if (!best)
+        break;
+
+      /* a transformation may have moved it since the index was built, in
+       * which case the index is built again */
+      mx_focus_manager_get_stage_box (CLUTTER_ACTOR (best->focusable), &box);
+      if (fabsf (box.x1 - best->box.x1) > 0.5f ||
+          fabsf (box.y1 - best->box.y1) > 0.5f ||
+          fabsf (box.x2 - best->box.x2) > 0.5f ||
+          fabsf (box.y2 - best->box.y2) > 0.5f)
+        {
+          MX_NOTE (FOCUS, "The index is out of date, rebuilding it");
+          mx_focus_manager_invalidate_index (manager);
+          continue;
+        }
+
+      g_ptr_array_add (tried, best->focusable);
+
+      if (!moved_out)
+        {
+          /* notify the current focusable that focus is being moved */
+          mx_focusable_move_focus (old_focus, MX_FOCUS_DIRECTION_OUT,
+                                   old_focus);
+          moved_out = TRUE;
+        }
+
+      new_focused = mx_focusable_accept_focus (best->focusable, hint);
+    }
+
+  g_ptr_array_free (tried, TRUE);
+
+  if (!moved_out)
+    return FALSE;
+
+  if (!new_focused)
+    {
+      new_focused = mx_focusable_accept_focus (old_focus, MX_FOCUS_HINT_PRIOR);
+      mx_focus_manager_set_focused (manager, new_focused);
+      return FALSE;
+    }
+
+  MX_NOTE (FOCUS, "Moving focus from %s (%p) to %s (%p) spatially",
+           G_OBJECT_TYPE_NAME (old_focus), old_focus,
+           G_OBJECT_TYPE_NAME (new_focused), new_focused);
+
+  mx_focus_manager_set_focused (manager, new_focused);
+  mx_focus_manager_notify_parents (new_focused);
+  mx_focus_manager_scroll_to (CLUTTER_ACTOR (new_focused));
+
+  return TRUE;
+}
+
 static gboolean
 mx_focus_manager_event_cb (ClutterStage   *stage,
                            ClutterEvent   *event,
@@ -413,6 +1099,9 @@ mx_focus_manager_get_for_stage (ClutterStage *stage)
       g_signal_connect (G_OBJECT (stage), "event",
                         G_CALLBACK (mx_focus_manager_event_cb),
                         manager);
+      g_signal_connect_swapped (G_OBJECT (stage), "queue-relayout",
+                                G_CALLBACK (mx_focus_manager_invalidate_index),
+                                manager);
       g_object_notify (G_OBJECT (manager), "stage");
     }
 
@@ -553,6 +1242,23 @@ mx_focus_manager_move_focus (MxFocusManager   *manager,
 
   old_focus = priv->focused;
 
+  if (priv->focused && priv->spatial_navigation &&
+      (direction == MX_FOCUS_DIRECTION_UP ||
+       direction == MX_FOCUS_DIRECTION_DOWN ||
+       direction == MX_FOCUS_DIRECTION_LEFT ||
+       direction == MX_FOCUS_DIRECTION_RIGHT))
+    {
+      /* Keep the focus where it is when there is nothing in that
+       * direction */
+      if (mx_focus_manager_move_focus_spatial (manager, direction) ||
+          priv->focused)
+        {
+          if (priv->focused != old_focus)
+            g_object_notify (G_OBJECT (manager), "focused");
+          return;
+        }
+    }
+
   if (priv->focused)
     {
       new_focused = mx_focusable_move_focus (priv->focused,
@@ -605,3 +1311,51 @@ mx_focus_manager_move_focus (MxFocusManager   *manager,
   if (priv->focused != old_focus)
     g_object_notify (G_OBJECT (manager), "focused");
 }
+
+/**
+ * mx_focus_manager_set_spatial_navigation:
+ * @manager: A #MxFocusManager
+ * @enabled: %TRUE to move the focus from the position of the focusables
+ *
+ * Sets whether moving the focus up, down, left or right goes to the
+ * nearest focusable in that direction on the stage, across containers,
+ * rather than letting the containers of the focused actor decide. See
+ * #MxFocusManager:spatial-navigation.
+ *
+ * Since: 2.0
+ */
+void
+mx_focus_manager_set_spatial_navigation (MxFocusManager *manager,
+                                         gboolean        enabled)
+{
+  MxFocusManagerPrivate *priv;
+
+  g_return_if_fail (MX_IS_FOCUS_MANAGER (manager));
+
+  priv = manager->priv;
+
+  if (priv->spatial_navigation != enabled)
+    {
+      priv->spatial_navigation = !!enabled;
+      g_object_notify (G_OBJECT (manager), "spatial-navigation");
+    }
+}
+
+/**
+ * mx_focus_manager_get_spatial_navigation:
+ * @manager: A #MxFocusManager
+ *
+ * Gets the value of the #MxFocusManager:spatial-navigation property.
+ *
+ * Returns: %TRUE if directional focus moves use the position of the
+ *   focusables
+ *
+ * Since: 2.0
+ */
+gboolean
+mx_focus_manager_get_spatial_navigation (MxFocusManager *manager)
+{
+  g_return_val_if_fail (MX_IS_FOCUS_MANAGER (manager), FALSE);
+
+  return manager->priv->spatial_navigation;
+}
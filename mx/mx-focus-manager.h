@@ -103,6 +103,10 @@ void         mx_focus_manager_push_focus_with_hint  (MxFocusManager *manager,
 void         mx_focus_manager_move_focus  (MxFocusManager   *manager,
                                            MxFocusDirection  direction);
 
+void         mx_focus_manager_set_spatial_navigation (MxFocusManager *manager,
+                                                      gboolean        enabled);
+gboolean     mx_focus_manager_get_spatial_navigation (MxFocusManager *manager);
+
 G_END_DECLS
 
 #endif /* _MX_FOCUS_MANAGER_H */
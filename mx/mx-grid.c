@@ -265,6 +265,8 @@ adjustment_value_notify_cb (MxAdjustment *adjustment,
                             GParamSpec   *pspec,
                             MxGrid       *grid)
 {
+  /* scrolling only changes the transform and the culling in paint */
+  _mx_scroll_stats_scrolled (CLUTTER_ACTOR (grid));
   clutter_actor_queue_redraw (CLUTTER_ACTOR (grid));
 }
 
@@ -620,6 +622,14 @@ update_adjustments (MxGrid      *self,
     }
 }
 
+/* Used by MxFocusManager when it gives the focus to a child directly */
+void
+_mx_grid_set_last_focus (MxGrid      *grid,
+                         MxFocusable *focusable)
+{
+  grid->priv->last_focus = focusable;
+}
+
 static MxFocusable*
 mx_grid_move_focus (MxFocusable      *focusable,
                     MxFocusDirection  direction,
@@ -1161,6 +1171,9 @@ mx_grid_actor_removed (ClutterContainer *container,
   MxGrid *layout = MX_GRID (container);
   MxGridPrivate *priv = layout->priv;
 
+  if ((ClutterActor *)priv->last_focus == actor)
+    priv->last_focus = NULL;
+
   g_hash_table_remove (priv->hash_table, actor);
 }
 
@@ -1274,6 +1287,11 @@ mx_grid_get_preferred_width (ClutterActor *self,
   gfloat actual_width, min_width;
   ClutterActorBox box;
 
+  _mx_scroll_stats_relayout (self);
+
+  /* measure any labels in parallel before requesting their sizes */
+  _mx_label_measure_children (self);
+
   box.x1 = 0;
   box.y1 = 0;
   box.x2 = G_MAXFLOAT;
@@ -1297,6 +1315,11 @@ mx_grid_get_preferred_height (ClutterActor *self,
   gfloat actual_height, min_height;
   ClutterActorBox box;
 
+  _mx_scroll_stats_relayout (self);
+
+  /* measure any labels in parallel before requesting their sizes */
+  _mx_label_measure_children (self);
+
   box.x1 = 0;
   box.y1 = 0;
   box.x2 = for_width;
@@ -1689,6 +1712,8 @@ mx_grid_allocate (ClutterActor          *self,
   MxGridPrivate *priv = MX_GRID (self)->priv;
   ClutterActorBox alloc_box = *box;
 
+  _mx_scroll_stats_relayout (self);
+
   /* chain up here to preserve the allocated size
    *
    * (we ignore the height of the allocation if we have a vadjustment set,
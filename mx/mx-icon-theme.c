@@ -22,6 +22,8 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <glib/gstdio.h>
 #include <gio/gio.h>
 #include "mx-icon-theme.h"
 #include "mx-marshal.h"
@@ -29,6 +31,8 @@
 #include "mx-private.h"
 #include "mx-settings.h"
 
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
 G_DEFINE_TYPE (MxIconTheme, mx_icon_theme, G_TYPE_OBJECT)
 
 enum
@@ -58,6 +62,46 @@ typedef struct
   gint         threshold;
 } MxIconData;
 
+typedef struct
+{
+  gchar      *name;
+  gint        size;
+  MxIconType  type;
+  gint        min_size;
+  gint        max_size;
+  gint        threshold;
+} MxIconThemeDir;
+
+/* The icons of a theme found under one of the search paths. Icons are
+ * looked up in the mapped icon-theme.cache when there is an up to date one,
+ * or else in a table built by listing each directory of the theme once. */
+typedef struct
+{
+  gchar       *path;
+  GMappedFile *cache;
+  GHashTable  *icons;
+} MxIconThemeRoot;
+
+typedef struct
+{
+  GArray     *dirs;
+  GHashTable *dir_indices;
+  GList      *roots;
+} MxIconThemeIndex;
+
+typedef struct
+{
+  guint16 dir;
+  guint16 flags;
+} MxIconThemeImage;
+
+typedef struct
+{
+  guint dir;
+  guint root;
+  guint flags;
+} MxIconThemeMatch;
+
 struct _MxIconThemePrivate
 {
   guint       override_theme : 1;
@@ -65,6 +109,11 @@ struct _MxIconThemePrivate
   GList      *search_paths;
   GHashTable *icon_hash;
   GHashTable *theme_path_hash;
+  GHashTable *theme_index_hash;
+
+  /* (name, size) pairs that weren't found, oldest first in the queue */
+  GHashTable *missing_hash;
+  GQueue      missing_queue;
 
   gchar      *theme;
   GKeyFile   *theme_file;
@@ -80,6 +129,20 @@ enum
   PROP_THEME_NAME
 };
 
+/* The number of missing icons remembered by the negative cache */
+#define MX_ICON_THEME_MAX_MISSING 256
+
+static void mx_icon_theme_index_free (MxIconThemeIndex *index);
+
+static void
+mx_icon_theme_clear_missing (MxIconTheme *theme)
+{
+  MxIconThemePrivate *priv = theme->priv;
+
+  g_queue_clear (&priv->missing_queue);
+  g_hash_table_remove_all (priv->missing_hash);
+}
+
 static void
 mx_icon_theme_get_property (GObject    *object,
                             guint       property_id,
@@ -132,6 +195,9 @@ mx_icon_theme_finalize (GObject *object)
   mx_icon_theme_set_search_paths (self, NULL);
   g_hash_table_unref (priv->icon_hash);
   g_hash_table_unref (priv->theme_path_hash);
+  g_hash_table_unref (priv->theme_index_hash);
+  mx_icon_theme_clear_missing (self);
+  g_hash_table_unref (priv->missing_hash);
   g_free (priv->theme);
 
   if (priv->theme_file)
@@ -383,6 +449,14 @@ mx_icon_theme_init (MxIconTheme *self)
                                                  NULL,
                                                  g_free);
 
+  priv->theme_index_hash =
+    g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                           (GDestroyNotify) mx_icon_theme_index_free);
+
+  priv->missing_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                              g_free, NULL);
+  g_queue_init (&priv->missing_queue);
+
   priv->hicolor_file = mx_icon_theme_load_theme (self, "hicolor");
   if (!priv->hicolor_file)
     g_warning ("Error loading fallback icon theme");
@@ -499,17 +573,21 @@ mx_icon_theme_set_theme_name (MxIconTheme *theme,
 
   /* Clear old data */
   g_hash_table_remove_all (priv->icon_hash);
+  mx_icon_theme_clear_missing (theme);
 
   g_free (priv->theme);
 
   if (priv->theme_file)
     {
+      g_hash_table_remove (priv->theme_index_hash, priv->theme_file);
       g_hash_table_remove (priv->theme_path_hash, priv->theme_file);
       g_key_file_free (priv->theme_file);
     }
 
   while (priv->theme_fallbacks)
     {
+      g_hash_table_remove (priv->theme_index_hash,
+                           priv->theme_fallbacks->data);
       g_hash_table_remove (priv->theme_path_hash, priv->theme_fallbacks->data);
       g_key_file_free ((GKeyFile *)priv->theme_fallbacks->data);
       priv->theme_fallbacks = g_list_delete_link (priv->theme_fallbacks,
@@ -568,28 +646,284 @@ mx_icon_theme_collect_dirs (GString     *string,
   g_dir_close (dir);
 }
 
-static GList *
-mx_icon_theme_theme_load_icon (MxIconTheme *self,
-                               GKeyFile    *theme_file,
-                               const gchar *icon,
-                               GIcon       *store_icon,
-                               gboolean     store_fail)
+/* Flags of the images in icon-theme.cache, see the GTK+ icon cache format */
+#define MX_ICON_SUFFIX_XPM (1 << 0)
+#define MX_ICON_SUFFIX_SVG (1 << 1)
+#define MX_ICON_SUFFIX_PNG (1 << 2)
+
+#define MX_ICON_CACHE_END 0xffffffff
+
+static guint
+mx_icon_theme_cache_hash (const gchar *name)
 {
-  gchar *dirs;
-  const gchar *theme;
+  const signed char *p = (const signed char *) name;
+  guint32 h = *p;
+
+  if (h)
+    for (p += 1; *p != '\0'; p++)
+      h = (h << 5) - h + *p;
+
+  return h;
+}
 
-  GList *data = NULL;
+/* The offsets come from the file and may be unaligned, so the values are
+ * copied out rather than dereferenced in place */
+static inline gboolean
+mx_icon_theme_cache_get_uint32 (const gchar *data,
+                                gsize        size,
+                                guint32      offset,
+                                guint32     *value)
+{
+  guint32 be;
+
+  if ((gsize) offset + 4 > size)
+    return FALSE;
+
+  memcpy (&be, data + offset, sizeof (be));
+  *value = GUINT32_FROM_BE (be);
+  return TRUE;
+}
+
+static inline gboolean
+mx_icon_theme_cache_get_uint16 (const gchar *data,
+                                gsize        size,
+                                guint32      offset,
+                                guint16     *value)
+{
+  guint16 be;
+
+  if ((gsize) offset + 2 > size)
+    return FALSE;
+
+  memcpy (&be, data + offset, sizeof (be));
+  *value = GUINT16_FROM_BE (be);
+  return TRUE;
+}
+
+static GMappedFile *
+mx_icon_theme_cache_open (const gchar *path)
+{
+  struct stat dir_stat, cache_stat;
+  GMappedFile *cache;
+  const gchar *data;
+  gchar *filename;
+  guint16 major;
+
+  filename = g_build_filename (path, "icon-theme.cache", NULL);
+
+  /* a cache older than the theme directory doesn't list every icon */
+  if (g_stat (filename, &cache_stat) != 0 ||
+      g_stat (path, &dir_stat) != 0 ||
+      cache_stat.st_mtime < dir_stat.st_mtime)
+    {
+      g_free (filename);
+      return NULL;
+    }
+
+  cache = g_mapped_file_new (filename, FALSE, NULL);
+  g_free (filename);
+
+  if (!cache)
+    return NULL;
+
+  data = g_mapped_file_get_contents (cache);
+  if (!mx_icon_theme_cache_get_uint16 (data, g_mapped_file_get_length (cache),
+                                       0, &major) ||
+      major != 1 ||
+      g_mapped_file_get_length (cache) < 12)
+    {
+      g_mapped_file_unref (cache);
+      return NULL;
+    }
+
+  return cache;
+}
+
+static void
+mx_icon_theme_root_scan (MxIconThemeIndex *index,
+                         MxIconThemeRoot  *root)
+{
+  guint i;
+
+  root->icons = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                       (GDestroyNotify) g_array_unref);
+
+  for (i = 0; i < index->dirs->len; i++)
+    {
+      MxIconThemeDir *theme_dir;
+      const gchar *file;
+      gchar *path;
+      GDir *dir;
+
+      theme_dir = &g_array_index (index->dirs, MxIconThemeDir, i);
+      path = g_build_filename (root->path, theme_dir->name, NULL);
+      dir = g_dir_open (path, 0, NULL);
+      g_free (path);
+
+      if (!dir)
+        continue;
+
+      while ((file = g_dir_read_name (dir)))
+        {
+          MxIconThemeImage *last, image;
+          const gchar *suffix;
+          GArray *images;
+          gchar *name;
+
+          suffix = strrchr (file, '.');
+          if (!suffix)
+            continue;
+
+          if (g_str_equal (suffix, ".png"))
+            image.flags = MX_ICON_SUFFIX_PNG;
+          else if (g_str_equal (suffix, ".svg"))
+            image.flags = MX_ICON_SUFFIX_SVG;
+          else if (g_str_equal (suffix, ".xpm"))
+            image.flags = MX_ICON_SUFFIX_XPM;
+          else
+            continue;
+
+          image.dir = i;
+
+          name = g_strndup (file, suffix - file);
+          images = g_hash_table_lookup (root->icons, name);
+          if (!images)
+            {
+              images = g_array_new (FALSE, FALSE, sizeof (MxIconThemeImage));
+              g_hash_table_insert (root->icons, name, images);
+            }
+          else
+            g_free (name);
+
+          /* the same icon may be available in several formats */
+          last = images->len ?
+            &g_array_index (images, MxIconThemeImage, images->len - 1) : NULL;
+          if (last && last->dir == i)
+            last->flags |= image.flags;
+          else
+            g_array_append_val (images, image);
+        }
+
+      g_dir_close (dir);
+    }
+}
+
+static void
+mx_icon_theme_root_free (MxIconThemeRoot *root)
+{
+  g_free (root->path);
+
+  if (root->cache)
+    g_mapped_file_unref (root->cache);
+
+  if (root->icons)
+    g_hash_table_unref (root->icons);
+
+  g_slice_free (MxIconThemeRoot, root);
+}
+
+static void
+mx_icon_theme_index_free (MxIconThemeIndex *index)
+{
+  guint i;
+
+  for (i = 0; i < index->dirs->len; i++)
+    g_free (g_array_index (index->dirs, MxIconThemeDir, i).name);
+
+  g_array_unref (index->dirs);
+  g_hash_table_unref (index->dir_indices);
+  g_list_free_full (index->roots, (GDestroyNotify) mx_icon_theme_root_free);
+
+  g_slice_free (MxIconThemeIndex, index);
+}
+
+static void
+mx_icon_theme_index_add_dir (MxIconThemeIndex *index,
+                             GKeyFile         *theme_file,
+                             const gchar      *dir)
+{
+  MxIconThemeDir theme_dir = { 0, };
+  gchar *type_string;
+
+  if (g_hash_table_lookup (index->dir_indices, dir))
+    return;
+
+  theme_dir.size = g_key_file_get_integer (theme_file, dir, "Size", NULL);
+  if (!theme_dir.size)
+    {
+      /* Try to get size from dir name */
+      theme_dir.size = atoi (dir);
+      if (!theme_dir.size)
+        return;
+    }
+
+  type_string = g_key_file_get_string (theme_file, dir, "Type", NULL);
+
+  theme_dir.type = MX_FIXED;
+  if (type_string)
+    {
+      if (g_str_equal (type_string, "Scalable"))
+        {
+          theme_dir.type = MX_SCALABLE;
+          theme_dir.min_size = g_key_file_get_integer (theme_file, dir,
+                                                       "MinSize", NULL);
+          if (!theme_dir.min_size)
+            theme_dir.min_size = theme_dir.size;
+
+          theme_dir.max_size = g_key_file_get_integer (theme_file, dir,
+                                                       "MaxSize", NULL);
+          if (!theme_dir.max_size)
+            theme_dir.max_size = theme_dir.size;
+        }
+      else if (g_str_equal (type_string, "Threshold"))
+        {
+          theme_dir.type = MX_THRESHOLD;
+          theme_dir.threshold = g_key_file_get_integer (theme_file, dir,
+                                                        "Threshold", NULL);
+          if (!theme_dir.threshold)
+            theme_dir.threshold = 2;
+
+          theme_dir.min_size = theme_dir.size - theme_dir.threshold;
+          theme_dir.max_size = theme_dir.size + theme_dir.threshold;
+        }
+      g_free (type_string);
+    }
+
+  theme_dir.name = g_strdup (dir);
+  g_array_append_val (index->dirs, theme_dir);
+
+  /* store the index + 1, so that 0 means the directory isn't used */
+  g_hash_table_insert (index->dir_indices, theme_dir.name,
+                       GUINT_TO_POINTER (index->dirs->len));
+}
+
+static MxIconThemeIndex *
+mx_icon_theme_get_index (MxIconTheme *self,
+                         GKeyFile    *theme_file)
+{
   MxIconThemePrivate *priv = self->priv;
+  MxIconThemeIndex *index;
+  const gchar *theme;
+  gchar *dirs;
+  GList *p;
+
+  index = g_hash_table_lookup (priv->theme_index_hash, theme_file);
+  if (index)
+    return index;
+
+  index = g_slice_new0 (MxIconThemeIndex);
+  index->dirs = g_array_new (FALSE, FALSE, sizeof (MxIconThemeDir));
+  index->dir_indices = g_hash_table_new (g_str_hash, g_str_equal);
+
+  theme = g_hash_table_lookup (priv->theme_path_hash, theme_file);
 
   dirs = g_key_file_get_string (theme_file,
                                 "Icon Theme",
                                 "Directories",
                                 NULL);
-  theme = g_hash_table_lookup (priv->theme_path_hash, theme_file);
 
   if (!dirs)
     {
-      GList *p;
       GString *string;
 
       /* Icon theme hasn't specified directories, so recurse and
@@ -608,136 +942,228 @@ mx_icon_theme_theme_load_icon (MxIconTheme *self,
         }
 
       /* Chop off the trailing comma */
-      g_string_truncate (string, string->len - 1);
+      if (string->len)
+        g_string_truncate (string, string->len - 1);
 
-      dirs = string->str;
-      g_string_free (string, FALSE);
+      dirs = g_string_free (string, FALSE);
     }
 
   if (dirs)
     {
+      gchar **strv = g_strsplit (dirs, ",", 0);
       gint i;
-      gint dirs_len = strlen (dirs);
 
-      g_strdelimit (dirs, ",", '\0');
+      for (i = 0; strv[i]; i++)
+        if (*strv[i])
+          mx_icon_theme_index_add_dir (index, theme_file, strv[i]);
+
+      g_strfreev (strv);
+      g_free (dirs);
+    }
+
+  for (p = priv->search_paths; p; p = p->next)
+    {
+      MxIconThemeRoot *root;
+      gchar *path;
 
-      i = 0;
-      while (i < dirs_len)
+      path = g_build_filename (p->data, theme, NULL);
+      if (!g_file_test (path, G_FILE_TEST_IS_DIR))
         {
-          GList *p;
-          MxIconType type;
-          gchar *type_string;
-          gint size, min, max, threshold;
-
-          const gchar *dir = dirs + i;
-          i += strlen (dir) + 1;
-
-          size = g_key_file_get_integer (theme_file,
-                                         dir,
-                                         "Size",
-                                         NULL);
-          if (!size)
-            {
-              /* Try to get size from dir name */
-              size = atoi (dir);
-              if (!size)
-                continue;
-            }
+          g_free (path);
+          continue;
+        }
 
-          type_string = g_key_file_get_string (theme_file,
-                                               dir,
-                                               "Type",
-                                               NULL);
+      root = g_slice_new0 (MxIconThemeRoot);
+      root->path = path;
+      root->cache = mx_icon_theme_cache_open (path);
 
-          type = MX_FIXED;
-          min = max = threshold = 0;
-          if (type_string)
-            {
-              if (g_str_equal (type_string, "Scalable"))
-                {
-                  type = MX_SCALABLE;
-                  min = g_key_file_get_integer (theme_file,
-                                                dir,
-                                                "MinSize",
-                                                NULL);
-                  if (!min)
-                    min = size;
-
-                  max = g_key_file_get_integer (theme_file,
-                                                dir,
-                                                "MaxSize",
-                                                NULL);
-                  if (!max)
-                    max = size;
-                }
-              else if (g_str_equal (type_string, "Threshold"))
-                {
-                  type = MX_THRESHOLD;
-                  threshold = g_key_file_get_integer (theme_file,
-                                                      dir,
-                                                      "Threshold",
-                                                      NULL);
-                  if (!threshold)
-                    threshold = 2;
-
-                  min = size - threshold;
-                  max = size + threshold;
-                }
-              g_free (type_string);
-            }
+      if (!root->cache)
+        mx_icon_theme_root_scan (index, root);
+
+      index->roots = g_list_append (index->roots, root);
+    }
+
+  g_hash_table_insert (priv->theme_index_hash, theme_file, index);
+
+  return index;
+}
+
+static void
+mx_icon_theme_root_cache_lookup (MxIconThemeIndex *index,
+                                 MxIconThemeRoot  *root,
+                                 guint             root_number,
+                                 const gchar      *icon,
+                                 GArray           *matches)
+{
+  guint32 hash_offset, dir_list_offset, n_buckets, n_dirs, offset;
+  const gchar *data;
+  gsize size;
+
+  data = g_mapped_file_get_contents (root->cache);
+  size = g_mapped_file_get_length (root->cache);
+
+  if (!mx_icon_theme_cache_get_uint32 (data, size, 4, &hash_offset) ||
+      !mx_icon_theme_cache_get_uint32 (data, size, 8, &dir_list_offset) ||
+      !mx_icon_theme_cache_get_uint32 (data, size, hash_offset, &n_buckets) ||
+      !mx_icon_theme_cache_get_uint32 (data, size, dir_list_offset, &n_dirs) ||
+      n_buckets == 0)
+    return;
+
+  if (!mx_icon_theme_cache_get_uint32 (data, size,
+                                       hash_offset + 4 + 4 *
+                                       (mx_icon_theme_cache_hash (icon) %
+                                        n_buckets),
+                                       &offset))
+    return;
+
+  while (offset != MX_ICON_CACHE_END)
+    {
+      guint32 name_offset, list_offset, n_images, i;
+
+      if (!mx_icon_theme_cache_get_uint32 (data, size, offset + 4,
+                                           &name_offset) ||
+          name_offset >= size)
+        return;
 
-          for (p = priv->search_paths; p; p = p->next)
+      if (strncmp (data + name_offset, icon, size - name_offset) != 0)
+        {
+          if (!mx_icon_theme_cache_get_uint32 (data, size, offset, &offset))
+            return;
+          continue;
+        }
+
+      if (!mx_icon_theme_cache_get_uint32 (data, size, offset + 8,
+                                           &list_offset) ||
+          !mx_icon_theme_cache_get_uint32 (data, size, list_offset,
+                                           &n_images))
+        return;
+
+      for (i = 0; i < n_images; i++)
+        {
+          guint32 image_offset = list_offset + 4 + 8 * i;
+          guint32 dir_name_offset;
+          guint16 dir, flags;
+          MxIconThemeMatch match;
+          gpointer dir_index;
+
+          if (!mx_icon_theme_cache_get_uint16 (data, size, image_offset,
+                                               &dir) ||
+              !mx_icon_theme_cache_get_uint16 (data, size, image_offset + 2,
+                                               &flags) ||
+              dir >= n_dirs ||
+              !mx_icon_theme_cache_get_uint32 (data, size,
+                                               dir_list_offset + 4 + 4 * dir,
+                                               &dir_name_offset) ||
+              dir_name_offset >= size ||
+              !memchr (data + dir_name_offset, '\0', size - dir_name_offset))
+            return;
+
+          /* skip directories that aren't part of the theme */
+          dir_index = g_hash_table_lookup (index->dir_indices,
+                                           data + dir_name_offset);
+          if (!dir_index)
+            continue;
+
+          match.dir = GPOINTER_TO_UINT (dir_index) - 1;
+          match.root = root_number;
+          match.flags = flags;
+          g_array_append_val (matches, match);
+        }
+
+      return;
+    }
+}
+
+static gint
+mx_icon_theme_match_compare (const MxIconThemeMatch *a,
+                             const MxIconThemeMatch *b)
+{
+  if (a->dir != b->dir)
+    return (a->dir < b->dir) ? -1 : 1;
+
+  return (gint) a->root - (gint) b->root;
+}
+
+static GList *
+mx_icon_theme_theme_load_icon (MxIconTheme *self,
+                               GKeyFile    *theme_file,
+                               const gchar *icon,
+                               GIcon       *store_icon,
+                               gboolean     store_fail)
+{
+  MxIconThemeIndex *index;
+  GArray *matches;
+  GList *r, *data = NULL;
+  guint i, root_number;
+
+  MxIconThemePrivate *priv = self->priv;
+
+  index = mx_icon_theme_get_index (self, theme_file);
+  matches = g_array_new (FALSE, FALSE, sizeof (MxIconThemeMatch));
+
+  for (r = index->roots, root_number = 0; r; r = r->next, root_number++)
+    {
+      MxIconThemeRoot *root = r->data;
+
+      if (root->cache)
+        mx_icon_theme_root_cache_lookup (index, root, root_number, icon,
+                                         matches);
+      else
+        {
+          GArray *images = g_hash_table_lookup (root->icons, icon);
+
+          for (i = 0; images && i < images->len; i++)
             {
-              gchar *file;
-
-              MxIconData *icon_data = NULL;
-              const gchar *search_path = p->data;
-              gchar *path = g_build_filename (search_path,
-                                              theme,
-                                              dir,
-                                              NULL);
-
-              /* Try png first, then svg and xpm */
-              file = g_strconcat (path, G_DIR_SEPARATOR_S, icon, ".png", NULL);
-              if (!g_file_test (file, G_FILE_TEST_EXISTS |
-                                      G_FILE_TEST_IS_REGULAR))
-                {
-                  g_free (file);
-                  file = g_strconcat (path, G_DIR_SEPARATOR_S, icon, ".svg",
-                                      NULL);
-                  if (!g_file_test (file, G_FILE_TEST_EXISTS |
-                                          G_FILE_TEST_IS_REGULAR))
-                    {
-                      g_free (file);
-                      file = g_strconcat (path, G_DIR_SEPARATOR_S, icon, ".xpm",
-                                          NULL);
-                      if (!g_file_test (file, G_FILE_TEST_EXISTS |
-                                              G_FILE_TEST_IS_REGULAR))
-                        {
-                          g_free (file);
-                          file = NULL;
-                        }
-                    }
-                }
-
-              if (file)
-                {
-                  icon_data = mx_icon_theme_icon_data_new (size,
-                                                           file,
-                                                           type,
-                                                           min,
-                                                           max,
-                                                           threshold);
-                  g_free (file);
-
-                  data = g_list_prepend (data, icon_data);
-                }
-              g_free (path);
+              MxIconThemeImage *image;
+              MxIconThemeMatch match;
+
+              image = &g_array_index (images, MxIconThemeImage, i);
+              match.dir = image->dir;
+              match.root = root_number;
+              match.flags = image->flags;
+              g_array_append_val (matches, match);
             }
         }
-      g_free (dirs);
     }
 
+  /* keep the order of the theme directories, then of the search paths */
+  g_array_sort (matches, (GCompareFunc) mx_icon_theme_match_compare);
+
+  for (i = 0; i < matches->len; i++)
+    {
+      MxIconThemeMatch *match = &g_array_index (matches, MxIconThemeMatch, i);
+      MxIconThemeDir *dir;
+      MxIconThemeRoot *root;
+      const gchar *suffix;
+      gchar *file;
+
+      /* Prefer png, then svg and xpm */
+      if (match->flags & MX_ICON_SUFFIX_PNG)
+        suffix = ".png";
+      else if (match->flags & MX_ICON_SUFFIX_SVG)
+        suffix = ".svg";
+      else if (match->flags & MX_ICON_SUFFIX_XPM)
+        suffix = ".xpm";
+      else
+        continue;
+
+      dir = &g_array_index (index->dirs, MxIconThemeDir, match->dir);
+      root = g_list_nth_data (index->roots, match->root);
+
+      file = g_strconcat (root->path, G_DIR_SEPARATOR_S, dir->name,
+                          G_DIR_SEPARATOR_S, icon, suffix, NULL);
+      data = g_list_prepend (data,
+                             mx_icon_theme_icon_data_new (dir->size,
+                                                          file,
+                                                          dir->type,
+                                                          dir->min_size,
+                                                          dir->max_size,
+                                                          dir->threshold));
+      g_free (file);
+    }
+
+  g_array_free (matches, TRUE);
+
   if (data || store_fail)
     {
       data = g_list_reverse (data);
@@ -917,6 +1343,89 @@ mx_icon_theme_lookup_internal (MxIconTheme *theme,
   return best_match;
 }
 
+static gchar *
+mx_icon_theme_missing_key (const gchar *icon_name,
+                           gint         size)
+{
+  return g_strdup_printf ("%s:%d", icon_name, size);
+}
+
+static gboolean
+mx_icon_theme_is_missing (MxIconTheme *theme,
+                          const gchar *icon_name,
+                          gint         size)
+{
+  gboolean missing;
+  gchar *key;
+
+  key = mx_icon_theme_missing_key (icon_name, size);
+  missing = g_hash_table_lookup_extended (theme->priv->missing_hash, key,
+                                          NULL, NULL);
+  g_free (key);
+
+  return missing;
+}
+
+static void
+mx_icon_theme_add_missing (MxIconTheme *theme,
+                           const gchar *icon_name,
+                           gint         size)
+{
+  MxIconThemePrivate *priv = theme->priv;
+  gchar *key;
+
+  key = mx_icon_theme_missing_key (icon_name, size);
+  if (g_hash_table_lookup_extended (priv->missing_hash, key, NULL, NULL))
+    {
+      g_free (key);
+      return;
+    }
+
+  /* forget the oldest entry, the keys are owned by the hash table */
+  if (g_queue_get_length (&priv->missing_queue) >= MX_ICON_THEME_MAX_MISSING)
+    g_hash_table_remove (priv->missing_hash,
+                         g_queue_pop_head (&priv->missing_queue));
+
+  g_hash_table_insert (priv->missing_hash, key, NULL);
+  g_queue_push_tail (&priv->missing_queue, key);
+}
+
+static MxIconData *
+mx_icon_theme_find (MxIconTheme *theme,
+                    const gchar *icon_name,
+                    gint         size)
+{
+  MxIconData *icon_data;
+
+  if (mx_icon_theme_is_missing (theme, icon_name, size))
+    return NULL;
+
+  icon_data = mx_icon_theme_lookup_internal (theme, icon_name, size);
+  if (!icon_data)
+    mx_icon_theme_add_missing (theme, icon_name, size);
+
+  return icon_data;
+}
+
+/* Scalable icons are rendered at the requested size, and stored in the
+ * texture cache under a key that includes the size */
+static gchar *
+mx_icon_theme_get_cache_key (MxIconData *icon_data,
+                             gint        size,
+                             gboolean   *render_at_size)
+{
+  gboolean scalable = (icon_data->type != MX_FIXED &&
+                       g_str_has_suffix (icon_data->path, ".svg"));
+
+  if (render_at_size)
+    *render_at_size = scalable;
+
+  if (scalable)
+    return g_strdup_printf ("%s#%d", icon_data->path, size);
+  else
+    return g_strdup (icon_data->path);
+}
+
 /**
  * mx_icon_theme_lookup:
  * @theme: an #MxIconTheme
@@ -934,16 +1443,243 @@ mx_icon_theme_lookup (MxIconTheme *theme,
 {
   MxTextureCache *texture_cache;
   MxIconData *icon_data;
+  CoglHandle texture;
+  gchar *key;
 
   g_return_val_if_fail (MX_IS_ICON_THEME (theme), NULL);
   g_return_val_if_fail (icon_name, NULL);
   g_return_val_if_fail (size > 0, NULL);
 
-  if (!(icon_data = mx_icon_theme_lookup_internal (theme, icon_name, size)))
+  if (!(icon_data = mx_icon_theme_find (theme, icon_name, size)))
     return NULL;
 
+  /* use a copy rendered at this size by mx_icon_theme_lookup_async() */
   texture_cache = mx_texture_cache_get_default ();
-  return mx_texture_cache_get_cogl_texture (texture_cache, icon_data->path);
+  key = mx_icon_theme_get_cache_key (icon_data, size, NULL);
+  if (mx_texture_cache_contains (texture_cache, key))
+    texture = mx_texture_cache_get_cogl_texture (texture_cache, key);
+  else
+    texture = mx_texture_cache_get_cogl_texture (texture_cache,
+                                                 icon_data->path);
+  g_free (key);
+
+  return texture;
+}
+
+typedef struct
+{
+  gchar      *path;
+  gchar      *key;
+  gint        size;
+  gboolean    render_at_size;
+
+  GdkPixbuf  *pixbuf;
+  CoglHandle  texture;
+} MxIconThemeLoad;
+
+static void
+mx_icon_theme_load_free (MxIconThemeLoad *load)
+{
+  g_free (load->path);
+  g_free (load->key);
+
+  if (load->pixbuf)
+    g_object_unref (load->pixbuf);
+
+  if (load->texture)
+    cogl_handle_unref (load->texture);
+
+  g_slice_free (MxIconThemeLoad, load);
+}
+
+/* Runs in a thread of the GIO pool, so it mustn't touch Cogl */
+static void
+mx_icon_theme_load_thread (GSimpleAsyncResult *result,
+                           GObject            *object,
+                           GCancellable       *cancellable)
+{
+  MxIconThemeLoad *load;
+  GError *error = NULL;
+
+  load = g_simple_async_result_get_op_res_gpointer (result);
+
+  if (load->render_at_size)
+    load->pixbuf = gdk_pixbuf_new_from_file_at_size (load->path,
+                                                     load->size, load->size,
+                                                     &error);
+  else
+    load->pixbuf = gdk_pixbuf_new_from_file (load->path, &error);
+
+  if (!load->pixbuf)
+    {
+      g_simple_async_result_set_from_error (result, error);
+      g_error_free (error);
+    }
+}
+
+/**
+ * mx_icon_theme_lookup_async:
+ * @theme: an #MxIconTheme
+ * @icon_name: The name of the icon
+ * @size: The desired size of the icon
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the icon is loaded
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronously loads the icon @icon_name at @size. The image file is
+ * decoded in a thread and scalable icons are rendered at @size, so the main
+ * loop isn't blocked. Icons that are already in the #MxTextureCache are
+ * returned on the next iteration of the main loop.
+ *
+ * When the operation is finished, @callback will be called, and
+ * mx_icon_theme_lookup_finish() can be used to get the result.
+ *
+ * Since: 2.0
+ */
+void
+mx_icon_theme_lookup_async (MxIconTheme         *theme,
+                            const gchar         *icon_name,
+                            gint                 size,
+                            GCancellable        *cancellable,
+                            GAsyncReadyCallback  callback,
+                            gpointer             user_data)
+{
+  GSimpleAsyncResult *result;
+  MxTextureCache *texture_cache;
+  MxIconThemeLoad *load;
+  MxIconData *icon_data;
+
+  g_return_if_fail (MX_IS_ICON_THEME (theme));
+  g_return_if_fail (icon_name);
+  g_return_if_fail (size > 0);
+
+  result = g_simple_async_result_new (G_OBJECT (theme), callback, user_data,
+                                      mx_icon_theme_lookup_async);
+  g_simple_async_result_set_check_cancellable (result, cancellable);
+
+  if (!(icon_data = mx_icon_theme_find (theme, icon_name, size)))
+    {
+      g_simple_async_result_set_error (result, G_IO_ERROR,
+                                       G_IO_ERROR_NOT_FOUND,
+                                       "Icon \"%s\" not found", icon_name);
+      g_simple_async_result_complete_in_idle (result);
+      g_object_unref (result);
+      return;
+    }
+
+  load = g_slice_new0 (MxIconThemeLoad);
+  load->path = g_strdup (icon_data->path);
+  load->size = size;
+  load->key = mx_icon_theme_get_cache_key (icon_data, size,
+                                           &load->render_at_size);
+  g_simple_async_result_set_op_res_gpointer (result, load,
+                                             (GDestroyNotify)
+                                             mx_icon_theme_load_free);
+
+  texture_cache = mx_texture_cache_get_default ();
+  if (mx_texture_cache_contains (texture_cache, load->key))
+    {
+      load->texture =
+        mx_texture_cache_get_cogl_texture (texture_cache, load->key);
+      g_simple_async_result_complete_in_idle (result);
+    }
+  else
+    g_simple_async_result_run_in_thread (result, mx_icon_theme_load_thread,
+                                         G_PRIORITY_DEFAULT, cancellable);
+
+  g_object_unref (result);
+}
+
+/**
+ * mx_icon_theme_lookup_finish:
+ * @theme: an #MxIconTheme
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Finishes an operation started with mx_icon_theme_lookup_async(). The
+ * loaded texture is added to the #MxTextureCache.
+ *
+ * Return value: (transfer full): a #CoglHandle of the icon, or %NULL if
+ *   the icon couldn't be found or loaded. Use cogl_handle_unref() when
+ *   done with it.
+ *
+ * Since: 2.0
+ */
+CoglHandle
+mx_icon_theme_lookup_finish (MxIconTheme   *theme,
+                             GAsyncResult  *result,
+                             GError       **error)
+{
+  GSimpleAsyncResult *simple;
+  MxIconThemeLoad *load;
+
+  g_return_val_if_fail (MX_IS_ICON_THEME (theme), NULL);
+  g_return_val_if_fail (g_simple_async_result_is_valid (result,
+                                                        G_OBJECT (theme),
+                                                        mx_icon_theme_lookup_async),
+                        NULL);
+
+  simple = G_SIMPLE_ASYNC_RESULT (result);
+  if (g_simple_async_result_propagate_error (simple, error))
+    return NULL;
+
+  load = g_simple_async_result_get_op_res_gpointer (simple);
+
+  if (!load->texture && load->pixbuf)
+    {
+      GdkPixbuf *pixbuf = load->pixbuf;
+      MxTextureCache *texture_cache = mx_texture_cache_get_default ();
+      gboolean has_alpha = gdk_pixbuf_get_has_alpha (pixbuf);
+
+      /* another lookup may have completed first */
+      if (mx_texture_cache_contains (texture_cache, load->key))
+        load->texture =
+          mx_texture_cache_get_cogl_texture (texture_cache, load->key);
+      else
+        {
+          load->texture =
+            cogl_texture_new_from_data (gdk_pixbuf_get_width (pixbuf),
+                                        gdk_pixbuf_get_height (pixbuf),
+                                        COGL_TEXTURE_NONE,
+                                        has_alpha ?
+                                        COGL_PIXEL_FORMAT_RGBA_8888 :
+                                        COGL_PIXEL_FORMAT_RGB_888,
+                                        COGL_PIXEL_FORMAT_ANY,
+                                        gdk_pixbuf_get_rowstride (pixbuf),
+                                        gdk_pixbuf_get_pixels (pixbuf));
+
+          if (load->texture)
+            mx_texture_cache_insert (texture_cache, load->key, load->texture);
+        }
+
+      g_object_unref (load->pixbuf);
+      load->pixbuf = NULL;
+    }
+
+  return load->texture ? cogl_handle_ref (load->texture) : NULL;
+}
+
+/* Returns the icon only if its texture has already been loaded */
+CoglHandle
+_mx_icon_theme_lookup_cached (MxIconTheme *theme,
+                              const gchar *icon_name,
+                              gint         size)
+{
+  MxTextureCache *texture_cache;
+  MxIconData *icon_data;
+  CoglHandle texture = NULL;
+  gchar *key;
+
+  if (!(icon_data = mx_icon_theme_find (theme, icon_name, size)))
+    return NULL;
+
+  texture_cache = mx_texture_cache_get_default ();
+  key = mx_icon_theme_get_cache_key (icon_data, size, NULL);
+  if (mx_texture_cache_contains (texture_cache, key))
+    texture = mx_texture_cache_get_cogl_texture (texture_cache, key);
+  g_free (key);
+
+  return texture;
 }
 
 gboolean
@@ -1004,4 +1740,9 @@ mx_icon_theme_set_search_paths (MxIconTheme *theme,
   priv->search_paths = g_list_copy ((GList *)paths);
   for (p = priv->search_paths; p; p = p->next)
     p->data = g_strdup ((const gchar *)p->data);
+
+  /* the themes will be indexed again from the new paths */
+  g_hash_table_remove_all (priv->theme_index_hash);
+  g_hash_table_remove_all (priv->icon_hash);
+  mx_icon_theme_clear_missing (theme);
 }
@@ -28,6 +28,10 @@
  *
  * #MxIcon is a simple styled texture actor that displays an image from
  * a stylesheet.
+ *
+ * Icons from the icon theme are loaded asynchronously. While an icon is
+ * loading, the previous icon is kept or, if there wasn't one, the space
+ * for the icon is left empty. The icon is faded in once it has loaded.
  */
 
 #include "mx-icon.h"
@@ -58,14 +62,20 @@ struct _MxIconPrivate
   guint         icon_set         : 1;
   guint         size_set         : 1;
   guint         is_content_image : 1;
+  guint         loading          : 1;
 
   CoglTexture  *icon_texture;
 
+  GCancellable    *cancellable;
+  ClutterTimeline *fade_timeline;
+
   gchar        *icon_name;
   gchar        *icon_suffix;
   gint          icon_size;
 };
 
+#define MX_ICON_FADE_DURATION 150
+
 static void mx_icon_update (MxIcon *icon);
 
 static void
@@ -165,9 +175,68 @@ mx_icon_notify_theme_name_cb (MxIconTheme *theme,
   mx_icon_update (self);
 }
 
+static void
+mx_icon_cancel_load (MxIcon *icon)
+{
+  MxIconPrivate *priv = icon->priv;
+
+  if (priv->cancellable)
+    {
+      g_cancellable_cancel (priv->cancellable);
+      g_object_unref (priv->cancellable);
+      priv->cancellable = NULL;
+    }
+
+  priv->loading = FALSE;
+}
+
+static void
+mx_icon_set_texture (MxIcon     *icon,
+                     CoglHandle  texture,
+                     gboolean    fade_in)
+{
+  MxIconPrivate *priv = icon->priv;
+
+  if (priv->icon_texture)
+    {
+      _mx_texture_frame_release_material (priv->icon_texture);
+      cogl_object_unref (priv->icon_texture);
+    }
+
+  priv->icon_texture = texture;
+
+  if (fade_in && texture)
+    {
+      clutter_timeline_rewind (priv->fade_timeline);
+      clutter_timeline_start (priv->fade_timeline);
+    }
+  else
+    clutter_timeline_stop (priv->fade_timeline);
+
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (icon));
+}
+
 static void
 mx_icon_dispose (GObject *gobject)
 {
+  MxIconPrivate *priv = MX_ICON (gobject)->priv;
+
+  mx_icon_cancel_load (MX_ICON (gobject));
+
+  if (priv->fade_timeline)
+    {
+      clutter_timeline_stop (priv->fade_timeline);
+      g_object_unref (priv->fade_timeline);
+      priv->fade_timeline = NULL;
+    }
+
+  if (priv->icon_texture)
+    {
+      _mx_texture_frame_release_material (priv->icon_texture);
+      cogl_object_unref (priv->icon_texture);
+      priv->icon_texture = NULL;
+    }
+
   if (mx_icon_theme_get_default ())
     {
       g_signal_handlers_disconnect_by_func (mx_icon_theme_get_default (),
@@ -217,6 +286,8 @@ mx_icon_get_preferred_height (ClutterActor *actor,
       else
         pref_height = height;
     }
+  else if (priv->loading)
+    pref_height = priv->icon_size;
   else
     pref_height = 0;
 
@@ -258,6 +329,8 @@ mx_icon_get_preferred_width (ClutterActor *actor,
       else
         pref_width = width;
     }
+  else if (priv->loading)
+    pref_width = priv->icon_size;
   else
     pref_width = 0;
 
@@ -287,8 +360,22 @@ mx_icon_paint (ClutterActor *actor)
       clutter_actor_get_allocation_box (actor, &allocation);
       mx_widget_get_available_area (MX_WIDGET (actor), &allocation, &box);
 
-      cogl_set_source_texture (priv->icon_texture);
-      cogl_rectangle (box.x1, box.y1, box.x2, box.y2);
+      if (clutter_timeline_is_playing (priv->fade_timeline))
+        {
+          gdouble progress =
+            clutter_timeline_get_progress (priv->fade_timeline);
+
+          _mx_paint_texture_with_opacity (priv->icon_texture,
+                                          (guint8) (progress * 255),
+                                          box.x1, box.y1,
+                                          box.x2 - box.x1,
+                                          box.y2 - box.y1);
+        }
+      else
+        {
+          cogl_set_source_texture (priv->icon_texture);
+          cogl_rectangle (box.x1, box.y1, box.x2, box.y2);
+        }
     }
 }
 
@@ -325,43 +412,86 @@ mx_icon_class_init (MxIconClass *klass)
   g_object_class_install_property (object_class, PROP_ICON_SIZE, pspec);
 }
 
+static void
+mx_icon_lookup_cb (MxIconTheme  *theme,
+                   GAsyncResult *result,
+                   MxIcon       *icon)
+{
+  MxIconPrivate *priv = icon->priv;
+  CoglHandle texture;
+  GError *error = NULL;
+
+  texture = mx_icon_theme_lookup_finish (theme, result, &error);
+
+  if (error)
+    {
+      gboolean cancelled = g_error_matches (error, G_IO_ERROR,
+                                            G_IO_ERROR_CANCELLED);
+      g_error_free (error);
+
+      /* the icon changed again, or was disposed, while loading */
+      if (cancelled)
+        {
+          g_object_unref (icon);
+          return;
+        }
+    }
+
+  g_object_unref (priv->cancellable);
+  priv->cancellable = NULL;
+  priv->loading = FALSE;
+
+  /* If the icon is missing, use the image-missing icon */
+  if (!texture)
+    texture = mx_icon_theme_lookup (theme, "image-missing", priv->icon_size);
+
+  mx_icon_set_texture (icon, texture, TRUE);
+
+  g_object_unref (icon);
+}
+
 static void
 mx_icon_update (MxIcon *icon)
 {
   MxIconPrivate *priv = icon->priv;
+  MxIconTheme *theme = mx_icon_theme_get_default ();
+  CoglHandle texture;
+  gchar *icon_name;
 
   if (priv->is_content_image)
     {
       priv->is_content_image = FALSE;
-      g_signal_connect (mx_icon_theme_get_default (), "notify::theme-name",
+      g_signal_connect (theme, "notify::theme-name",
                         G_CALLBACK (mx_icon_notify_theme_name_cb), icon);
     }
 
-  /* Get rid of the old one */
-  if (priv->icon_texture)
-    {
-      cogl_object_unref (priv->icon_texture);
-      priv->icon_texture = NULL;
-    }
+  mx_icon_cancel_load (icon);
 
-  /* Try to lookup the new one */
-  if (priv->icon_name)
+  if (!priv->icon_name)
     {
-      gchar *icon_name;
-      MxIconTheme *theme = mx_icon_theme_get_default ();
+      mx_icon_set_texture (icon, NULL, FALSE);
+      return;
+    }
 
-      icon_name = g_strconcat (priv->icon_name, priv->icon_suffix, NULL);
-      priv->icon_texture = mx_icon_theme_lookup (theme, icon_name,
-                                                 priv->icon_size);
-      g_free (icon_name);
+  /* Use the icon straight away if it's already loaded, otherwise keep
+   * the old one until the new one has been loaded in the background */
+  icon_name = g_strconcat (priv->icon_name, priv->icon_suffix, NULL);
+  texture = _mx_icon_theme_lookup_cached (theme, icon_name, priv->icon_size);
 
-      /* If the icon is missing, use the image-missing icon */
-      if (!priv->icon_texture)
-        priv->icon_texture = mx_icon_theme_lookup (theme, "image-missing",
-                                                   priv->icon_size);
+  if (texture)
+    mx_icon_set_texture (icon, texture, FALSE);
+  else
+    {
+      priv->loading = TRUE;
+      priv->cancellable = g_cancellable_new ();
+      mx_icon_theme_lookup_async (theme, icon_name, priv->icon_size,
+                                  priv->cancellable,
+                                  (GAsyncReadyCallback) mx_icon_lookup_cb,
+                                  g_object_ref (icon));
+      clutter_actor_queue_relayout (CLUTTER_ACTOR (icon));
     }
 
-  clutter_actor_queue_relayout (CLUTTER_ACTOR (icon));
+  g_free (icon_name);
 }
 
 static void
@@ -393,8 +523,12 @@ mx_icon_style_changed_cb (MxWidget *widget)
                                             mx_icon_notify_theme_name_cb,
                                             self);
 
+      mx_icon_cancel_load (self);
+      clutter_timeline_stop (priv->fade_timeline);
+
       if (priv->icon_texture)
         {
+          _mx_texture_frame_release_material (priv->icon_texture);
           cogl_object_unref (priv->icon_texture);
           priv->icon_texture = NULL;
         }
@@ -463,6 +597,10 @@ mx_icon_init (MxIcon *self)
 
   self->priv->icon_size = 48;
 
+  self->priv->fade_timeline = clutter_timeline_new (MX_ICON_FADE_DURATION);
+  g_signal_connect_swapped (self->priv->fade_timeline, "new-frame",
+                            G_CALLBACK (clutter_actor_queue_redraw), self);
+
   g_signal_connect (self, "style-changed",
                     G_CALLBACK (mx_icon_style_changed_cb), NULL);
 
@@ -24,6 +24,9 @@
  * or scaled to fit within the allocation. A transition effect occurs when a
  * new image is loaded.
  *
+ * The image can also be a sprite sheet, whose frames are played back in a
+ * loop, see mx_image_set_sprite_sheet().
+ *
  *
  * Since: 1.2
  */
@@ -35,6 +38,7 @@
 #include "mx-enum-types.h"
 #include "mx-marshal.h"
 #include "mx-texture-cache.h"
+#include "mx-sprite-animation.h"
 
 #include <gdk-pixbuf/gdk-pixbuf.h>
 
@@ -113,6 +117,12 @@ struct _MxImagePrivate
   guint transition_duration;
 
   MxImageAsyncData *async_load_data;
+
+  /* sprite sheet playback */
+  MxSpriteAnimation *animation;
+  guint              n_frames;
+  CoglHandle         sprite_material;
+  CoglHandle         sprite_texture;
 };
 
 enum
@@ -260,6 +270,88 @@ calculate_scale (CoglHandle       texture,
     }
 }
 
+static void
+mx_image_paint_sprite (MxImage *image,
+                       gfloat   x,
+                       gfloat   y,
+                       gfloat   aw,
+                       gfloat   ah,
+                       guint8   alpha)
+{
+  MxImagePrivate *priv = image->priv;
+  gfloat tw, th, fw, fh, dw, dh, scale, center, half;
+  gfloat coords[4];
+
+  tw = cogl_texture_get_width (priv->texture);
+  th = cogl_texture_get_height (priv->texture);
+
+  /* the frames are inside the 1px transparent border of the texture */
+  if (tw <= 2 || th <= 2)
+    return;
+
+  _mx_sprite_animation_get_coords (priv->animation, coords);
+  _mx_sprite_animation_painted (priv->animation);
+
+  fw = (tw - 2) * (coords[2] - coords[0]);
+  fh = (th - 2) * (coords[3] - coords[1]);
+
+  coords[0] = (1 + coords[0] * (tw - 2)) / tw;
+  coords[1] = (1 + coords[1] * (th - 2)) / th;
+  coords[2] = (1 + coords[2] * (tw - 2)) / tw;
+  coords[3] = (1 + coords[3] * (th - 2)) / th;
+
+  if (priv->mode == MX_IMAGE_SCALE_FIT)
+    scale = MIN (aw / fw, ah / fh);
+  else if (priv->mode == MX_IMAGE_SCALE_CROP)
+    scale = MAX (aw / fw, ah / fh);
+  else
+    scale = 1;
+
+  dw = fw * scale;
+  dh = fh * scale;
+
+  /* crop the frame to the allocation, keeping it centered */
+  if (dw > aw)
+    {
+      center = (coords[0] + coords[2]) / 2;
+      half = (coords[2] - coords[0]) * (aw / dw) / 2;
+      coords[0] = center - half;
+      coords[2] = center + half;
+      dw = aw;
+    }
+  if (dh > ah)
+    {
+      center = (coords[1] + coords[3]) / 2;
+      half = (coords[3] - coords[1]) * (ah / dh) / 2;
+      coords[1] = center - half;
+      coords[3] = center + half;
+      dh = ah;
+    }
+
+  x += (aw - dw) / 2;
+  y += (ah - dh) / 2;
+
+  if (!priv->sprite_material)
+    {
+      priv->sprite_material = cogl_material_new ();
+      cogl_material_set_layer_wrap_mode (priv->sprite_material, 0,
+                                         COGL_MATERIAL_WRAP_MODE_CLAMP_TO_EDGE);
+    }
+
+  if (priv->sprite_texture != priv->texture)
+    {
+      cogl_material_set_layer (priv->sprite_material, 0, priv->texture);
+      priv->sprite_texture = priv->texture;
+    }
+
+  cogl_material_set_color4ub (priv->sprite_material,
+                              alpha, alpha, alpha, alpha);
+  cogl_set_source (priv->sprite_material);
+  cogl_rectangle_with_texture_coords (x, y, x + dw, y + dh,
+                                      coords[0], coords[1],
+                                      coords[2], coords[3]);
+}
+
 static void
 mx_image_paint (ClutterActor *actor)
 {
@@ -291,11 +383,19 @@ mx_image_paint (ClutterActor *actor)
   aw -= (float) (padding.left + padding.right);
   ah -= (float) (padding.top + padding.bottom);
 
+  alpha = clutter_actor_get_paint_opacity (actor);
+
+  if (priv->n_frames > 1)
+    {
+      mx_image_paint_sprite (MX_IMAGE (actor), padding.left, padding.top,
+                             aw, ah, alpha);
+      return;
+    }
+
   bw = cogl_texture_get_width (priv->texture); /* base texture width */
   bh = cogl_texture_get_height (priv->texture); /* base texture height */
   ratio = bw/bh;
 
-  alpha = clutter_actor_get_paint_opacity (actor);
   cogl_color_init_from_4ub (&color, alpha, alpha, alpha, alpha);
 
   if (priv->old_texture)
@@ -388,6 +488,9 @@ mx_image_get_preferred_width (ClutterActor *actor,
 
   width = cogl_texture_get_width (priv->texture);
 
+  if (priv->n_frames > 1 && width > 2)
+    width = (width - 2) / _mx_sprite_animation_get_columns (priv->animation);
+
   if (min_width)
     *min_width = 0;
 
@@ -409,6 +512,9 @@ mx_image_get_preferred_height (ClutterActor *actor,
 
   height = cogl_texture_get_height (priv->texture);
 
+  if (priv->n_frames > 1 && height > 2)
+    height = (height - 2) / _mx_sprite_animation_get_rows (priv->animation);
+
   if (min_height)
     *min_height = 0;
 
@@ -572,6 +678,20 @@ mx_image_dispose (GObject *object)
       priv->async_load_data = NULL;
     }
 
+  if (priv->animation)
+    {
+      _mx_sprite_animation_free (priv->animation);
+      priv->animation = NULL;
+    }
+
+  if (priv->sprite_material)
+    {
+      cogl_object_unref (priv->sprite_material);
+
+      priv->sprite_material = NULL;
+      priv->sprite_texture = NULL;
+    }
+
   G_OBJECT_CLASS (mx_image_parent_class)->dispose (object);
 }
 
@@ -2235,3 +2355,59 @@ mx_image_get_transition_duration (MxImage *image)
 
   return image->priv->transition_duration;
 }
+
+/**
+ * mx_image_set_sprite_sheet:
+ * @image: A #MxImage
+ * @n_frames: the number of frames in the image
+ * @columns: the number of frames on each row, or 0 to have all the frames on
+ *   a single row
+ * @durations: (array length=n_durations) (allow-none): the time each frame
+ *   is shown for, in milliseconds
+ * @n_durations: the length of @durations
+ *
+ * Treats the images of @image as sprite sheets, holding @n_frames frames of
+ * the same size laid out row by row, and plays them back in a loop. Frame
+ * <emphasis>i</emphasis> is shown for durations[i % @n_durations]
+ * milliseconds, or for 100 milliseconds if @durations is %NULL.
+ *
+ * The playback follows the frame clock and is paused while @image isn't
+ * visible. The rotation and the transition between images don't apply to
+ * sprite sheets. Setting @n_frames to 1 or less shows whole images again.
+ *
+ * Since: 2.0
+ */
+void
+mx_image_set_sprite_sheet (MxImage     *image,
+                           guint        n_frames,
+                           guint        columns,
+                           const guint *durations,
+                           guint        n_durations)
+{
+  MxImagePrivate *priv;
+
+  g_return_if_fail (MX_IS_IMAGE (image));
+
+  priv = image->priv;
+
+  if (n_frames <= 1)
+    {
+      if (priv->animation)
+        _mx_sprite_animation_set_playing (priv->animation, FALSE);
+    }
+  else
+    {
+      if (!priv->animation)
+        priv->animation = _mx_sprite_animation_new (CLUTTER_ACTOR (image),
+                                                    NULL, NULL);
+
+      _mx_sprite_animation_set_layout (priv->animation, n_frames, columns);
+      _mx_sprite_animation_set_durations (priv->animation,
+                                          durations, n_durations);
+      _mx_sprite_animation_set_playing (priv->animation, TRUE);
+    }
+
+  priv->n_frames = n_frames;
+
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (image));
+}
@@ -154,6 +154,12 @@ void     mx_image_animate_scale_mode (MxImage          *image,
                                       gulong            mode,
                                       guint             duration,
                                       MxImageScaleMode  scale_mode);
+
+void     mx_image_set_sprite_sheet (MxImage     *image,
+                                    guint        n_frames,
+                                    guint        columns,
+                                    const guint *durations,
+                                    guint        n_durations);
 G_END_DECLS
 
 #endif /* _MX_IMAGE */
@@ -43,7 +43,9 @@
 #include "mx-private.h"
 #include "mx-scrollable.h"
 #include "mx-focusable.h"
+#include "mx-velocity-tracker.h"
 #include <math.h>
+#include <string.h>
 
 #define _KINETIC_DEBUG 0
 
@@ -61,12 +63,19 @@ G_DEFINE_TYPE_WITH_CODE (MxKineticScrollView,
                                         MX_TYPE_KINETIC_SCROLL_VIEW, \
                                         MxKineticScrollViewPrivate))
 
+/* The movement of one adjustment after a drag is released. The value is
+ * evaluated from the time elapsed since the release, so it doesn't depend
+ * on the frame rate. */
 typedef struct {
-  /* Units to store the origin of a click when scrolling */
-  gfloat   x;
-  gfloat   y;
-  GTimeVal time;
-} MxKineticScrollViewMotion;
+  gdouble  start;
+  gdouble  distance;
+
+  /* Set once the value went beyond a boundary, with overshoot enabled */
+  gboolean bouncing;
+  gdouble  bounce_time;
+  gdouble  bounce_edge;
+  gdouble  bounce_velocity;
+} MxKineticScrollViewAxis;
 
 typedef enum {
   MX_AUTOMATIC_SCROLL_NONE,
@@ -89,6 +98,7 @@ struct _MxKineticScrollViewPrivate
   guint                  vclamping           : 1;
   guint                  clamp_to_center     : 1;
   guint                  snap_on_page        : 1;
+  guint                  predicting          : 1;
 
   guint32                button;
   ClutterInputDevice    *device;
@@ -99,8 +109,13 @@ struct _MxKineticScrollViewPrivate
   MxAutomaticScroll        in_automatic_scroll;
 
   /* Mouse motion event information */
-  GArray                *motion_buffer;
-  guint                  last_motion;
+  MxVelocityTracker      motion;
+
+  /* The motion events are applied once per frame, from a repaint
+   * function; this is the position the adjustments were last moved for */
+  guint                  motion_repaint_id;
+  gfloat                 drag_x;
+  gfloat                 drag_y;
 
   /* Variables for storing acceleration information */
   ClutterTimeline       *deceleration_timeline;
@@ -108,9 +123,16 @@ struct _MxKineticScrollViewPrivate
   gfloat                 dy;
   gdouble                decel_rate;
   gdouble                overshoot;
-  gdouble                accumulated_delta;
   gdouble                acceleration_factor;
 
+  MxKineticScrollViewAxis haxis;
+  MxKineticScrollViewAxis vaxis;
+  gdouble                fling_duration;
+
+  ClutterTimelineProgressFunc decel_func;
+  gpointer                    decel_data;
+  GDestroyNotify              decel_notify;
+
   MxScrollPolicy         scroll_policy;
 
   guint                  clamp_duration;
@@ -139,6 +161,12 @@ enum {
   PROP_SNAP_ON_PAGE,
 };
 
+/* The interval the deceleration rate and overshoot are expressed in */
+#define FRAME_INTERVAL (1000.0 / 60.0)
+
+/* The longest time allowed for bouncing back from a boundary */
+#define MAX_BOUNCE_DURATION 1000
+
 #if _KINETIC_DEBUG
 # define LOG_DEBUG(args...) _log_debug(args)
 
@@ -286,11 +314,27 @@ mx_kinetic_scroll_view_get_adjustments (MxScrollable  *scrollable,
     }
 }
 
+static void
+mx_kinetic_scroll_view_viewport_predicted (MxScrollable *scrollable,
+                                           gdouble       x,
+                                           gdouble       y,
+                                           gdouble       velocity_x,
+                                           gdouble       velocity_y)
+{
+  MxKineticScrollViewPrivate *priv = MX_KINETIC_SCROLL_VIEW (scrollable)->priv;
+
+  /* The child owns the content, let it prefetch along the way */
+  if (priv->child)
+    mx_scrollable_predict_viewport (MX_SCROLLABLE (priv->child),
+                                    x, y, velocity_x, velocity_y);
+}
+
 static void
 mx_scrollable_iface_init (MxScrollableIface *iface)
 {
   iface->set_adjustments = mx_kinetic_scroll_view_set_adjustments;
   iface->get_adjustments = mx_kinetic_scroll_view_get_adjustments;
+  iface->viewport_predicted = mx_kinetic_scroll_view_viewport_predicted;
 }
 
 /* Object implementation */
@@ -480,6 +524,19 @@ mx_kinetic_scroll_view_dispose (GObject *object)
       priv->deceleration_timeline = NULL;
     }
 
+  if (priv->motion_repaint_id)
+    {
+      clutter_threads_remove_repaint_func (priv->motion_repaint_id);
+      priv->motion_repaint_id = 0;
+    }
+
+  if (priv->decel_notify)
+    {
+      priv->decel_notify (priv->decel_data);
+      priv->decel_notify = NULL;
+    }
+  priv->decel_func = NULL;
+
   G_OBJECT_CLASS (mx_kinetic_scroll_view_parent_class)->dispose (object);
 }
 
@@ -488,8 +545,6 @@ mx_kinetic_scroll_view_finalize (GObject *object)
 {
   MxKineticScrollViewPrivate *priv = MX_KINETIC_SCROLL_VIEW (object)->priv;
 
-  g_array_free (priv->motion_buffer, TRUE);
-
   G_OBJECT_CLASS (mx_kinetic_scroll_view_parent_class)->finalize (object);
 }
 
@@ -741,6 +796,66 @@ mx_kinetic_scroll_view_class_init (MxKineticScrollViewClass *klass)
                                     "vertical-adjustment");
 }
 
+static gdouble deceleration_get_progress (MxKineticScrollView *scroll,
+                                          gdouble              elapsed);
+
+/* Returns the value @adjust settles at and stores its initial velocity in
+ * @velocity, in units per second */
+static gdouble
+predict_axis (MxKineticScrollView     *scroll,
+              MxAdjustment            *adjust,
+              MxKineticScrollViewAxis *axis,
+              gboolean                 moving,
+              gdouble                 *velocity)
+{
+  gdouble value, lower, upper, page_size;
+
+  mx_adjustment_get_values (adjust, &value, &lower, &upper,
+                            NULL, NULL, &page_size);
+
+  *velocity = 0.0;
+
+  if (moving && axis->distance != 0.0)
+    {
+      value = axis->start + axis->distance;
+
+      /* The slope of the deceleration curve over its first millisecond */
+      *velocity = axis->distance *
+        deceleration_get_progress (scroll, 1.0) * 1000.0;
+    }
+
+  return CLAMP (value, lower, MAX (lower, upper - page_size));
+}
+
+/* Emits MxScrollable::viewport-predicted with where the current fling is
+ * going to stop or, when @moving is %FALSE, where the view came to rest */
+static void
+predict_viewport (MxKineticScrollView *scroll,
+                  gboolean             moving)
+{
+  MxKineticScrollViewPrivate *priv = scroll->priv;
+  MxAdjustment *hadjust, *vadjust;
+  gdouble x = 0.0, y = 0.0, velocity_x = 0.0, velocity_y = 0.0;
+
+  if (!priv->child)
+    return;
+
+  mx_scrollable_get_adjustments (MX_SCROLLABLE (priv->child),
+                                 &hadjust, &vadjust);
+
+  if (hadjust)
+    x = predict_axis (scroll, hadjust, &priv->haxis,
+                      moving && priv->hmoving, &velocity_x);
+  if (vadjust)
+    y = predict_axis (scroll, vadjust, &priv->vaxis,
+                      moving && priv->vmoving, &velocity_y);
+
+  priv->predicting = moving;
+
+  mx_scrollable_predict_viewport (MX_SCROLLABLE (scroll),
+                                  x, y, velocity_x, velocity_y);
+}
+
 static void
 set_state (MxKineticScrollView *scroll, MxKineticScrollViewState state)
 {
@@ -748,6 +863,82 @@ set_state (MxKineticScrollView *scroll, MxKineticScrollViewState state)
 
   priv->state = state;
   g_object_notify (G_OBJECT (scroll), "state");
+
+  /* Once the fling and the clamp that follows it are over, tell
+   * listeners the position the view rests at */
+  if (priv->predicting &&
+      state != MX_KINETIC_SCROLL_VIEW_STATE_SCROLLING &&
+      state != MX_KINETIC_SCROLL_VIEW_STATE_CLAMPING)
+    predict_viewport (scroll, FALSE);
+}
+
+/* Scrolls by the distance the pointer moved since the last frame */
+static void
+apply_motion (MxKineticScrollView *scroll)
+{
+  MxKineticScrollViewPrivate *priv = scroll->priv;
+  MxAdjustment *hadjust, *vadjust;
+  gdouble dx, dy;
+  gfloat x, y;
+
+  if (!priv->in_drag || !priv->child)
+    return;
+
+  _mx_velocity_tracker_get_last (&priv->motion, &x, &y);
+
+  mx_scrollable_get_adjustments (MX_SCROLLABLE (priv->child),
+                                 &hadjust, &vadjust);
+
+  if (hadjust &&
+      (priv->scroll_policy == MX_SCROLL_POLICY_HORIZONTAL ||
+       priv->scroll_policy == MX_SCROLL_POLICY_BOTH ||
+       priv->scroll_policy == MX_SCROLL_POLICY_AUTOMATIC) &&
+       (priv->in_automatic_scroll == MX_AUTOMATIC_SCROLL_HORIZONTAL ||
+       priv->in_automatic_scroll == MX_AUTOMATIC_SCROLL_NONE))
+    {
+      dx = (priv->drag_x - x) + mx_adjustment_get_value (hadjust);
+      mx_adjustment_set_value (hadjust, dx);
+    }
+
+  if (vadjust &&
+      (priv->scroll_policy == MX_SCROLL_POLICY_VERTICAL ||
+       priv->scroll_policy == MX_SCROLL_POLICY_BOTH ||
+       priv->scroll_policy == MX_SCROLL_POLICY_AUTOMATIC) &&
+       (priv->in_automatic_scroll == MX_AUTOMATIC_SCROLL_VERTICAL ||
+       priv->in_automatic_scroll == MX_AUTOMATIC_SCROLL_NONE))
+    {
+      dy = (priv->drag_y - y) + mx_adjustment_get_value (vadjust);
+      mx_adjustment_set_value (vadjust, dy);
+    }
+
+  priv->drag_x = x;
+  priv->drag_y = y;
+}
+
+static gboolean
+motion_repaint_cb (gpointer data)
+{
+  MxKineticScrollView *scroll = data;
+
+  scroll->priv->motion_repaint_id = 0;
+  apply_motion (scroll);
+
+  return FALSE;
+}
+
+/* Applies the motion still waiting for the next frame, if any */
+static void
+flush_motion (MxKineticScrollView *scroll)
+{
+  MxKineticScrollViewPrivate *priv = scroll->priv;
+
+  if (!priv->motion_repaint_id)
+    return;
+
+  clutter_threads_remove_repaint_func (priv->motion_repaint_id);
+  priv->motion_repaint_id = 0;
+
+  apply_motion (scroll);
 }
 
 static gboolean
@@ -820,7 +1011,9 @@ motion_event_cb (ClutterActor        *actor,
   if (clutter_actor_transform_stage_point (CLUTTER_ACTOR (scroll),
                                            x, y, &x, &y))
     {
-      MxKineticScrollViewMotion *motion;
+      gfloat last_x, last_y;
+
+      _mx_velocity_tracker_get_last (&priv->motion, &last_x, &last_y);
 
       /* Check if we've passed the drag threshold */
       if (!priv->in_drag)
@@ -832,11 +1025,9 @@ motion_event_cb (ClutterActor        *actor,
 
           g_object_get (G_OBJECT (settings),
                         "drag-threshold", &threshold, NULL);
-          motion = &g_array_index (priv->motion_buffer,
-                                   MxKineticScrollViewMotion, 0);
 
-          dx = ABS (motion->x - x);
-          dy = ABS (motion->y - y);
+          dx = ABS (last_x - x);
+          dy = ABS (last_y - y);
 
           if ((dy >= threshold) &&
               (priv->scroll_policy == MX_SCROLL_POLICY_VERTICAL ||
@@ -881,6 +1072,8 @@ motion_event_cb (ClutterActor        *actor,
                                                        FALSE);
 
               priv->in_drag = TRUE;
+              priv->drag_x = last_x;
+              priv->drag_y = last_y;
 
               set_state (scroll, MX_KINETIC_SCROLL_VIEW_STATE_PANNING);
 
@@ -916,75 +1109,35 @@ motion_event_cb (ClutterActor        *actor,
         }
 
       LOG_DEBUG (scroll, "motion dx=%f dy=%f",
-                 ABS (g_array_index (priv->motion_buffer, MxKineticScrollViewMotion, priv->motion_buffer->len - 1).x - x),
-                 ABS (g_array_index (priv->motion_buffer, MxKineticScrollViewMotion, priv->motion_buffer->len - 1).y - y));
+                 ABS (last_x - x), ABS (last_y - y));
 
-      if (priv->child)
+      if (priv->child && !priv->align_tested)
         {
-          gdouble dx, dy;
-          MxAdjustment *hadjust, *vadjust;
-
-          mx_scrollable_get_adjustments (MX_SCROLLABLE (priv->child),
-                                         &hadjust, &vadjust);
-
-          motion = &g_array_index (priv->motion_buffer,
-                                   MxKineticScrollViewMotion,
-                                   priv->last_motion);
-
-          if (!priv->align_tested)
-            {
-              priv->align_tested = TRUE;
-              priv->in_automatic_scroll = MX_AUTOMATIC_SCROLL_NONE;
-              if (priv->scroll_policy == MX_SCROLL_POLICY_AUTOMATIC)
-                {
-                  gfloat scroll_threshold = M_PI_4/2;
-                  gfloat drag_angle = atan((motion->y - y)/(x - motion->x));
-                  if( (drag_angle > -scroll_threshold) && (drag_angle < scroll_threshold) )
-                    priv->in_automatic_scroll = MX_AUTOMATIC_SCROLL_HORIZONTAL;
-                  else if ( (drag_angle > (M_PI_2 - scroll_threshold)) ||
-                            (drag_angle < -(M_PI_2 - scroll_threshold)) )
-                    priv->in_automatic_scroll = MX_AUTOMATIC_SCROLL_VERTICAL;
-                }
-            }
-
-
-          if (hadjust &&
-              (priv->scroll_policy == MX_SCROLL_POLICY_HORIZONTAL ||
-               priv->scroll_policy == MX_SCROLL_POLICY_BOTH ||
-               priv->scroll_policy == MX_SCROLL_POLICY_AUTOMATIC) &&
-               (priv->in_automatic_scroll == MX_AUTOMATIC_SCROLL_HORIZONTAL ||
-               priv->in_automatic_scroll == MX_AUTOMATIC_SCROLL_NONE))
+          priv->align_tested = TRUE;
+          priv->in_automatic_scroll = MX_AUTOMATIC_SCROLL_NONE;
+          if (priv->scroll_policy == MX_SCROLL_POLICY_AUTOMATIC)
             {
-              dx = (motion->x - x) + mx_adjustment_get_value (hadjust);
-              mx_adjustment_set_value (hadjust, dx);
+              gfloat scroll_threshold = M_PI_4/2;
+              gfloat drag_angle = atan((last_y - y)/(x - last_x));
+              if( (drag_angle > -scroll_threshold) && (drag_angle < scroll_threshold) )
+                priv->in_automatic_scroll = MX_AUTOMATIC_SCROLL_HORIZONTAL;
+              else if ( (drag_angle > (M_PI_2 - scroll_threshold)) ||
+                        (drag_angle < -(M_PI_2 - scroll_threshold)) )
+                priv->in_automatic_scroll = MX_AUTOMATIC_SCROLL_VERTICAL;
             }
-
-          if (vadjust &&
-              (priv->scroll_policy == MX_SCROLL_POLICY_VERTICAL ||
-               priv->scroll_policy == MX_SCROLL_POLICY_BOTH ||
-               priv->scroll_policy == MX_SCROLL_POLICY_AUTOMATIC) &&
-               (priv->in_automatic_scroll == MX_AUTOMATIC_SCROLL_VERTICAL ||
-               priv->in_automatic_scroll == MX_AUTOMATIC_SCROLL_NONE))
-            {
-              dy = (motion->y - y) + mx_adjustment_get_value (vadjust);
-              mx_adjustment_set_value (vadjust, dy);
-            }
-        }
-
-      priv->last_motion ++;
-      if (priv->last_motion == priv->motion_buffer->len)
-        {
-          LOG_DEBUG (scroll, "reset");
-          priv->motion_buffer = g_array_remove_index (priv->motion_buffer, 0);
-          g_array_set_size (priv->motion_buffer, priv->last_motion);
-          priv->last_motion --;
         }
 
-      motion = &g_array_index (priv->motion_buffer,
-                               MxKineticScrollViewMotion, priv->last_motion);
-      motion->x = x;
-      motion->y = y;
-      g_get_current_time (&motion->time);
+      /* Every event is kept for the velocity estimation, but the
+       * adjustments only follow the latest position, once per frame */
+      if (!priv->motion_repaint_id)
+        priv->motion_repaint_id =
+          clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_PRE_PAINT,
+                                                 motion_repaint_cb,
+                                                 scroll,
+                                                 NULL);
+
+      _mx_velocity_tracker_add (&priv->motion, x, y,
+                                g_get_monotonic_time ());
     }
 
   return swallow;
@@ -1100,105 +1253,155 @@ deceleration_completed_cb (ClutterTimeline     *timeline,
   priv->deceleration_timeline = NULL;
 }
 
-static void
-deceleration_new_frame_cb (ClutterTimeline     *timeline,
-                           gint                 frame_num,
-                           MxKineticScrollView *scroll)
+/* The default deceleration curve. The velocity is divided by the
+ * deceleration rate every FRAME_INTERVAL, which integrates to an exponential
+ * decay; it is normalised so that the whole distance is covered at @total.
+ */
+static gdouble
+mx_kinetic_scroll_view_decay (ClutterTimeline *timeline,
+                              gdouble          elapsed,
+                              gdouble          total,
+                              gpointer         user_data)
+{
+  MxKineticScrollView *scroll = user_data;
+  gdouble r = 1.0 / scroll->priv->decel_rate;
+  gdouble end = 1.0 - pow (r, total / FRAME_INTERVAL);
+
+  if (end <= 0.0)
+    return elapsed / total;
+
+  return (1.0 - pow (r, elapsed / FRAME_INTERVAL)) / end;
+}
+
+static gdouble
+deceleration_get_progress (MxKineticScrollView *scroll,
+                           gdouble              elapsed)
 {
   MxKineticScrollViewPrivate *priv = scroll->priv;
 
-  if (priv->child)
-    {
-      MxAdjustment *hadjust, *vadjust;
+  if (elapsed <= 0.0)
+    return 0.0;
 
-      gboolean stop = TRUE;
+  if (elapsed >= priv->fling_duration)
+    return 1.0;
 
-      mx_scrollable_get_adjustments (MX_SCROLLABLE (priv->child),
-                                     &hadjust, &vadjust);
+  if (priv->decel_func)
+    return priv->decel_func (priv->deceleration_timeline, elapsed,
+                             priv->fling_duration, priv->decel_data);
 
-      priv->accumulated_delta += clutter_timeline_get_delta (timeline);
+  return mx_kinetic_scroll_view_decay (priv->deceleration_timeline, elapsed,
+                                       priv->fling_duration, scroll);
+}
 
-      if (priv->accumulated_delta <= 1000.0/60.0)
-        stop = FALSE;
+/* Moves @adjust to where it is at @elapsed milliseconds since the release.
+ * Returns %FALSE when the axis has come to rest. */
+static gboolean
+deceleration_step_axis (MxKineticScrollView     *scroll,
+                        MxAdjustment            *adjust,
+                        MxKineticScrollViewAxis *axis,
+                        gdouble                  elapsed)
+{
+  MxKineticScrollViewPrivate *priv = scroll->priv;
+  gdouble value, lower, upper, page_size, progress;
 
-      while (priv->accumulated_delta > 1000.0/60.0)
-        {
-          gdouble hvalue, vvalue;
+  if (axis->bouncing)
+    {
+      gdouble omega, t, offset;
 
-          if (hadjust &&
-              (priv->scroll_policy == MX_SCROLL_POLICY_HORIZONTAL ||
-              priv->scroll_policy == MX_SCROLL_POLICY_BOTH ||
-              priv->scroll_policy == MX_SCROLL_POLICY_AUTOMATIC) &&
-              priv->in_automatic_scroll != MX_AUTOMATIC_SCROLL_VERTICAL)
-            {
-              if (ABS (priv->dx) > 2)
-                {
-                  hvalue = priv->dx + mx_adjustment_get_value (hadjust);
-                  mx_adjustment_set_value (hadjust, hvalue);
+      /* A critically damped spring pulling the value back to the edge,
+       * that started with the velocity the edge was crossed at. The
+       * overshoot is the fraction of velocity kept every FRAME_INTERVAL.
+       */
+      omega = -log (CLAMP (priv->overshoot, 0.01, 0.99)) / FRAME_INTERVAL;
+      t = elapsed - axis->bounce_time;
+      offset = axis->bounce_velocity * t * exp (-omega * t);
 
-                  if (priv->overshoot > 0.0)
-                    {
-                      if ((hvalue > mx_adjustment_get_upper (hadjust) -
-                           mx_adjustment_get_page_size (hadjust)) ||
-                          (hvalue < mx_adjustment_get_lower (hadjust)))
-                        priv->dx *= priv->overshoot;
-                    }
+      mx_adjustment_set_value (adjust, axis->bounce_edge + offset);
 
-                  priv->dx = priv->dx / priv->decel_rate;
+      /* Stop once past the peak and back within half a unit of the edge */
+      return (omega * t < 1.0 || ABS (offset) >= 0.5);
+    }
 
-                  stop = FALSE;
-                }
-              else if (priv->hmoving)
-                {
-                  guint duration;
+  mx_adjustment_get_values (adjust, NULL, &lower, &upper,
+                            NULL, NULL, &page_size);
+  upper -= page_size;
 
-                  priv->hmoving = FALSE;
+  progress = deceleration_get_progress (scroll, elapsed);
+  value = axis->start + axis->distance * progress;
 
-                  duration = (priv->overshoot > 0.0) ?
-                                priv->clamp_duration : 10;
-                  clamp_adjustments (scroll, duration, TRUE, FALSE);
-                }
-            }
+  if ((value < lower && axis->distance < 0) ||
+      (value > upper && axis->distance > 0))
+    {
+      gdouble edge = (value < lower) ? lower : upper;
 
-          if (vadjust &&
-              (priv->scroll_policy == MX_SCROLL_POLICY_VERTICAL ||
-              priv->scroll_policy == MX_SCROLL_POLICY_BOTH ||
-              priv->scroll_policy == MX_SCROLL_POLICY_AUTOMATIC) &&
-              priv->in_automatic_scroll != MX_AUTOMATIC_SCROLL_HORIZONTAL)
-            {
-              if (ABS (priv->dy) > 2)
-                {
-                  vvalue = priv->dy + mx_adjustment_get_value (vadjust);
-                  mx_adjustment_set_value (vadjust, vvalue);
+      mx_adjustment_set_value (adjust, edge);
 
-                  if (priv->overshoot > 0.0)
-                    {
-                      if ((vvalue > mx_adjustment_get_upper (vadjust) -
-                           mx_adjustment_get_page_size (vadjust)) ||
-                          (vvalue < mx_adjustment_get_lower (vadjust)))
-                        priv->dy *= priv->overshoot;
-                    }
+      if (priv->overshoot <= 0.0)
+        return FALSE;
 
-                  priv->dy = priv->dy / priv->decel_rate;
+      /* The velocity at the edge, from the slope of the curve */
+      axis->bouncing = TRUE;
+      axis->bounce_time = elapsed;
+      axis->bounce_edge = edge;
+      axis->bounce_velocity = axis->distance *
+        (progress - deceleration_get_progress (scroll, elapsed - 1.0));
 
-                  stop = FALSE;
-                }
-              else if (priv->vmoving)
-                {
-                  guint duration;
+      return TRUE;
+    }
 
-                  priv->vmoving = FALSE;
+  mx_adjustment_set_value (adjust, value);
 
-                  duration = (priv->overshoot > 0.0) ?
-                                priv->clamp_duration : 10;
-                  clamp_adjustments (scroll, duration, FALSE, TRUE);
-                }
-            }
+  return (elapsed < priv->fling_duration);
+}
 
-          priv->accumulated_delta -= 1000.0/60.0;
+static void
+deceleration_new_frame_cb (ClutterTimeline     *timeline,
+                           gint                 frame_num,
+                           MxKineticScrollView *scroll)
+{
+  MxKineticScrollViewPrivate *priv = scroll->priv;
+
+  if (priv->child)
+    {
+      MxAdjustment *hadjust, *vadjust;
+      gdouble elapsed;
+      guint duration;
+
+      mx_scrollable_get_adjustments (MX_SCROLLABLE (priv->child),
+                                     &hadjust, &vadjust);
+
+      /* The elapsed time of the timeline is taken from the master clock
+       * when the frame starts, so one evaluation per axis gives the
+       * position for this frame at any refresh rate.
+       */
+      elapsed = clutter_timeline_get_elapsed_time (timeline);
+      duration = (priv->overshoot > 0.0) ? priv->clamp_duration : 10;
+
+      if (priv->hmoving &&
+          !(hadjust &&
+            (priv->scroll_policy == MX_SCROLL_POLICY_HORIZONTAL ||
+             priv->scroll_policy == MX_SCROLL_POLICY_BOTH ||
+             priv->scroll_policy == MX_SCROLL_POLICY_AUTOMATIC) &&
+            priv->in_automatic_scroll != MX_AUTOMATIC_SCROLL_VERTICAL &&
+            deceleration_step_axis (scroll, hadjust, &priv->haxis, elapsed)))
+        {
+          priv->hmoving = FALSE;
+          clamp_adjustments (scroll, duration, TRUE, FALSE);
+        }
+
+      if (priv->vmoving &&
+          !(vadjust &&
+            (priv->scroll_policy == MX_SCROLL_POLICY_VERTICAL ||
+             priv->scroll_policy == MX_SCROLL_POLICY_BOTH ||
+             priv->scroll_policy == MX_SCROLL_POLICY_AUTOMATIC) &&
+            priv->in_automatic_scroll != MX_AUTOMATIC_SCROLL_HORIZONTAL &&
+            deceleration_step_axis (scroll, vadjust, &priv->vaxis, elapsed)))
+        {
+          priv->vmoving = FALSE;
+          clamp_adjustments (scroll, duration, FALSE, TRUE);
         }
 
-      if (stop)
+      if (!priv->hmoving && !priv->vmoving)
         {
           clutter_timeline_stop (timeline);
           deceleration_completed_cb (timeline, scroll);
@@ -1261,6 +1464,8 @@ release_event (MxKineticScrollView *scroll,
 
   LOG_DEBUG (scroll, "RELEASE!");
 
+  flush_motion (scroll);
+
   g_signal_handlers_disconnect_by_func (scroll,
                                         motion_event_cb,
                                         scroll);
@@ -1275,7 +1480,7 @@ release_event (MxKineticScrollView *scroll,
     {
       priv->device = NULL;
       priv->sequence = NULL;
-      priv->last_motion = 0;
+      _mx_velocity_tracker_reset (&priv->motion);
       return FALSE;
     }
 
@@ -1289,52 +1494,22 @@ release_event (MxKineticScrollView *scroll,
                                                &event_x, &event_y))
         {
           gdouble value, lower, upper, step_increment, page_size,
-                  d, ax, ay, y, nx, ny, n;
-          gfloat frac, x_origin, y_origin;
-          GTimeVal release_time, motion_time;
+                  d, y, nx, ny, n;
+          gfloat velocity_x, velocity_y;
           MxAdjustment *hadjust, *vadjust;
-          glong time_diff;
           guint duration;
-          gint i;
-
-          /* Get time delta */
-          g_get_current_time (&release_time);
-
-          /* Get average position/time of last x mouse events */
-          priv->last_motion ++;
-          x_origin = y_origin = 0;
-          motion_time = (GTimeVal){ 0, 0 };
-          for (i = 0; i < priv->last_motion; i++)
-            {
-              MxKineticScrollViewMotion *motion =
-                &g_array_index (priv->motion_buffer, MxKineticScrollViewMotion, i);
-
-              /* FIXME: This doesn't guard against overflows - Should
-               *        either fix that, or calculate the correct maximum
-               *        value for the buffer size
-               */
-              x_origin += motion->x;
-              y_origin += motion->y;
-              motion_time.tv_sec += motion->time.tv_sec;
-              motion_time.tv_usec += motion->time.tv_usec;
-            }
-          x_origin = x_origin / priv->last_motion;
-          y_origin = y_origin / priv->last_motion;
-          motion_time.tv_sec /= priv->last_motion;
-          motion_time.tv_usec /= priv->last_motion;
 
-          if (motion_time.tv_sec == release_time.tv_sec)
-            time_diff = release_time.tv_usec - motion_time.tv_usec;
-          else
-            time_diff = release_time.tv_usec +
-                        (G_USEC_PER_SEC - motion_time.tv_usec);
-
-          /* Work out the fraction of 1/60th of a second that has elapsed */
-          frac = (time_diff/1000.0) / (1000.0/60.0);
+          /* Estimate the velocity of the pointer when it was released,
+           * in units per second */
+          _mx_velocity_tracker_add (&priv->motion, event_x, event_y,
+                                    g_get_monotonic_time ());
+          _mx_velocity_tracker_get_velocity (&priv->motion,
+                                             &velocity_x, &velocity_y);
 
-          /* See how many units to move in 1/60th of a second */
-          priv->dx = (x_origin - event_x) / frac * priv->acceleration_factor;
-          priv->dy = (y_origin - event_y) / frac * priv->acceleration_factor;
+          /* See how many units to move in 1/60th of a second. The view
+           * moves in the opposite direction to the pointer. */
+          priv->dx = -velocity_x / 60.0 * priv->acceleration_factor;
+          priv->dy = -velocity_y / 60.0 * priv->acceleration_factor;
 
           /* If the delta is too low for the equations to work,
            * bump the values up a bit.
@@ -1361,33 +1536,17 @@ release_event (MxKineticScrollView *scroll,
 
           if (duration > 250)
             {
-              /* Now we have n, adjust dx/dy so that we finish on a step
-               * boundary.
-               *
-               * Distance moved, using the above variable names:
-               *
-               * d = x + x/y + x/y^2 + ... + x/y^n
-               *
-               * Using geometric series,
-               *
-               * d = (1 - 1/y^(n+1))/(1 - 1/y)*x
-               *
-               * Let a = (1 - 1/y^(n+1))/(1 - 1/y),
-               *
-               * d = a * x
-               *
-               * Find d and find its nearest page boundary, then solve for x
-               *
-               * x = d / a
+              /* Now we have n, find the distance d to move so that we
+               * finish on a step boundary. The deceleration curve then
+               * covers d over the duration, so the position can be
+               * evaluated directly at the time of each frame.
                */
-
-              /* Get adjustments, work out y^n */
               mx_scrollable_get_adjustments (MX_SCROLLABLE (priv->child),
                                              &hadjust, &vadjust);
-              ax = (1.0 - 1.0 / pow (y, n + 1)) / (1.0 - 1.0 / y);
-              ay = (1.0 - 1.0 / pow (y, n + 1)) / (1.0 - 1.0 / y);
+              memset (&priv->haxis, 0, sizeof (MxKineticScrollViewAxis));
+              memset (&priv->vaxis, 0, sizeof (MxKineticScrollViewAxis));
 
-              /* Solving for dx */
+              /* Distance along x */
               if (hadjust &&
                   priv->in_automatic_scroll != MX_AUTOMATIC_SCROLL_VERTICAL)
                 {
@@ -1422,10 +1581,11 @@ release_event (MxKineticScrollView *scroll,
                         d = priv->dx;
                     }
 
-                  priv->dx = d / ax;
+                  priv->haxis.start = value;
+                  priv->haxis.distance = d;
                 }
 
-              /* Solving for dy */
+              /* Distance along y */
               if (vadjust &&
                   priv->in_automatic_scroll != MX_AUTOMATIC_SCROLL_HORIZONTAL)
                 {
@@ -1457,20 +1617,26 @@ release_event (MxKineticScrollView *scroll,
                         d = priv->dy;
                     }
 
-                  priv->dy = d / ay;
+                  priv->vaxis.start = value;
+                  priv->vaxis.distance = d;
                 }
 
+              priv->fling_duration = duration;
+              if (priv->overshoot > 0.0)
+                duration += MAX_BOUNCE_DURATION;
+
               priv->deceleration_timeline = clutter_timeline_new (duration);
 
               g_signal_connect (priv->deceleration_timeline, "new_frame",
                                 G_CALLBACK (deceleration_new_frame_cb), scroll);
               g_signal_connect (priv->deceleration_timeline, "completed",
                                 G_CALLBACK (deceleration_completed_cb), scroll);
-              priv->accumulated_delta = 0;
               priv->hmoving = priv->vmoving = TRUE;
               clutter_timeline_start (priv->deceleration_timeline);
               decelerating = TRUE;
               set_state (scroll, MX_KINETIC_SCROLL_VIEW_STATE_SCROLLING);
+
+              predict_viewport (scroll, TRUE);
             }
         }
     }
@@ -1487,7 +1653,7 @@ release_event (MxKineticScrollView *scroll,
   priv->device = NULL;
 
   /* Reset motion event buffer */
-  priv->last_motion = 0;
+  _mx_velocity_tracker_reset (&priv->motion);
 
   if (!decelerating)
     clamp_adjustments (scroll, priv->clamp_duration, TRUE, TRUE);
@@ -1503,27 +1669,25 @@ press_event (MxKineticScrollView *scroll,
   MxKineticScrollViewPrivate *priv = scroll->priv;
   ClutterActor *actor = (ClutterActor *) scroll;
   ClutterActor *stage = clutter_actor_get_stage (actor);
-  MxKineticScrollViewMotion *motion;
+  gfloat motion_x, motion_y;
 
   /* Reset automatic-scroll setting */
   priv->in_automatic_scroll = MX_AUTOMATIC_SCROLL_NONE;
   priv->align_tested = 0;
 
   /* Reset motion buffer */
-  priv->last_motion = 0;
-  motion = &g_array_index (priv->motion_buffer, MxKineticScrollViewMotion, 0);
-  motion->x = x;
-  motion->y = y;
+  _mx_velocity_tracker_reset (&priv->motion);
 
   LOG_DEBUG (scroll, "initial point(%fx%f)", x, y);
 
   if (clutter_actor_transform_stage_point (actor, x, y,
-                                           &motion->x, &motion->y))
+                                           &motion_x, &motion_y))
     {
       guint threshold;
       MxSettings *settings = mx_settings_get_default ();
 
-      g_get_current_time (&motion->time);
+      _mx_velocity_tracker_add (&priv->motion, motion_x, motion_y,
+                                g_get_monotonic_time ());
 
       if (priv->deceleration_timeline)
         {
@@ -1739,9 +1903,6 @@ mx_kinetic_scroll_view_init (MxKineticScrollView *self)
   MxKineticScrollViewPrivate *priv = self->priv =
     KINETIC_SCROLL_VIEW_PRIVATE (self);
 
-  priv->motion_buffer =
-    g_array_sized_new (FALSE, TRUE, sizeof (MxKineticScrollViewMotion), 3);
-  g_array_set_size (priv->motion_buffer, 3);
   priv->decel_rate = 1.1f;
   priv->button = 1;
   priv->scroll_policy = MX_SCROLL_POLICY_BOTH;
@@ -1801,6 +1962,9 @@ mx_kinetic_scroll_view_stop (MxKineticScrollView *scroll)
       g_object_unref (priv->deceleration_timeline);
       priv->deceleration_timeline = NULL;
     }
+
+  if (priv->predicting)
+    predict_viewport (scroll, FALSE);
 }
 
 /**
@@ -1849,6 +2013,46 @@ mx_kinetic_scroll_view_get_deceleration (MxKineticScrollView *scroll)
   return scroll->priv->decel_rate;
 }
 
+/**
+ * mx_kinetic_scroll_view_set_deceleration_func:
+ * @scroll: A #MxKineticScrollView
+ * @func: (allow-none): a #ClutterTimelineProgressFunc, or %NULL
+ * @data: (allow-none): data to pass to @func
+ * @notify: (allow-none): a function to free @data
+ *
+ * Sets the curve used to decelerate after a drag is finished. @func is
+ * called with the time elapsed since the drag was released and the total
+ * duration of the deceleration, in milliseconds, and returns the fraction
+ * of the distance covered at that time, going from 0.0 to 1.0. The first
+ * argument of @func is the timeline driving the deceleration.
+ *
+ * The curve is evaluated once per frame at the time of the frame, so it
+ * doesn't depend on the frame rate. Passing %NULL restores the default
+ * curve, an exponential decay that divides the velocity by the
+ * #MxKineticScrollView:deceleration rate every 60th of a second.
+ *
+ * Since: 2.0
+ */
+void
+mx_kinetic_scroll_view_set_deceleration_func (MxKineticScrollView         *scroll,
+                                              ClutterTimelineProgressFunc  func,
+                                              gpointer                     data,
+                                              GDestroyNotify               notify)
+{
+  MxKineticScrollViewPrivate *priv;
+
+  g_return_if_fail (MX_IS_KINETIC_SCROLL_VIEW (scroll));
+
+  priv = scroll->priv;
+
+  if (priv->decel_notify)
+    priv->decel_notify (priv->decel_data);
+
+  priv->decel_func = func;
+  priv->decel_data = data;
+  priv->decel_notify = notify;
+}
+
 /*
 void
 mx_kinetic_scroll_view_set_buffer_size (MxKineticScrollView *scroll,
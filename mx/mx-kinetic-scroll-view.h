@@ -76,6 +76,11 @@ void mx_kinetic_scroll_view_set_deceleration (MxKineticScrollView *scroll,
                                               gdouble              rate);
 gdouble mx_kinetic_scroll_view_get_deceleration (MxKineticScrollView *scroll);
 
+void mx_kinetic_scroll_view_set_deceleration_func (MxKineticScrollView         *scroll,
+                                                   ClutterTimelineProgressFunc  func,
+                                                   gpointer                     data,
+                                                   GDestroyNotify               notify);
+
 /*
 void mx_kinetic_scroll_view_set_buffer_size (MxKineticScrollView *scroll,
                                              guint                size);
@@ -35,19 +35,21 @@
 #include "config.h"
 #endif
 
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include <glib.h>
 
 #include <clutter/clutter.h>
+#include <pango/pangocairo.h>
+#include <cogl-pango/cogl-pango.h>
 
 #include "mx-label.h"
 
 #include "mx-widget.h"
 #include "mx-stylable.h"
 #include "mx-private.h"
-#include "mx-fade-effect.h"
 
 enum
 {
@@ -68,7 +70,6 @@ enum
 struct _MxLabelPrivate
 {
   ClutterActor  *label;
-  ClutterEffect *fade_effect;
 
   MxAlign x_align;
   MxAlign y_align;
@@ -77,11 +78,76 @@ struct _MxLabelPrivate
 
   gint em_width;
 
+  /* width of the visible part of the text when it's faded out */
+  gfloat fade_width;
+
+  /* the end of the text, laid out on its own for drawing the faded border,
+   * and where it goes; kept until the text or its width changes */
+  PangoLayout *fade_layout;
+  gfloat       fade_layout_x;
+  gfloat       fade_layout_y;
+
   guint fade_out           : 1;
   guint label_should_fade  : 1;
   guint show_tooltip       : 1;
+  guint measure_valid      : 1;
+  guint fade_layout_valid  : 1;
+
+  /* size of the text, as measured by _mx_label_measure_children() */
+  gfloat measured_min_width;
+  gfloat measured_natural_width;
+  gfloat measured_height;
 };
 
+/* Containers only measure their labels in parallel when at least this many
+ * need measuring, below that it's cheaper to measure them inline */
+#define MX_LABEL_PARALLEL_MEASURE_THRESHOLD 8
+
+/* The number of steps of decreasing opacity the faded end of the label is
+ * drawn in */
+#define MX_LABEL_FADE_STEPS 4
+
+typedef struct
+{
+  MxLabel              *label;
+
+  gchar                *text;
+  PangoFontDescription *font;
+  PangoAttrList        *attrs;
+  gboolean              ellipsize;
+
+  gfloat                min_width;
+  gfloat                natural_width;
+  gfloat                height;
+} MxLabelMeasureData;
+
+/* The labels being measured, which the main thread and the worker threads
+ * take from in turn */
+typedef struct
+{
+  GMutex              lock;
+  GCond               cond;
+  gint                pending;
+
+  volatile gint       next;
+  MxLabelMeasureData *data;
+  gint                n_data;
+} MxLabelMeasureBatch;
+
+typedef struct
+{
+  MxLabelMeasureBatch *batch;
+  PangoContext        *context;
+} MxLabelMeasureTask;
+
+static GThreadPool *mx_label_threads = NULL;
+
+/* A Pango context for each thread measuring labels, the first of which is
+ * used by the main thread. Pango font maps can't be shared between threads,
+ * so each one has its own CoglPango font map, the same kind of font map
+ * ClutterText uses. */
+static GPtrArray *mx_label_measure_contexts = NULL;
+
 G_DEFINE_TYPE (MxLabel, mx_label, MX_TYPE_WIDGET);
 
 static void
@@ -201,9 +267,17 @@ mx_label_get_preferred_width (ClutterActor *actor,
 
   for_height -= padding.top + padding.bottom;
 
-  clutter_actor_get_preferred_width (priv->label, for_height,
-                                     min_width_p,
-                                     natural_width_p);
+  if (priv->measure_valid)
+    {
+      if (min_width_p)
+        *min_width_p = priv->measured_min_width;
+      if (natural_width_p)
+        *natural_width_p = priv->measured_natural_width;
+    }
+  else
+    clutter_actor_get_preferred_width (priv->label, for_height,
+                                       min_width_p,
+                                       natural_width_p);
 
   /* If we're fading out, make sure our minimum width is zero */
   if (priv->fade_out && min_width_p)
@@ -229,9 +303,18 @@ mx_label_get_preferred_height (ClutterActor *actor,
 
   for_width -= padding.left + padding.right;
 
-  clutter_actor_get_preferred_height (priv->label, for_width,
-                                      min_height_p,
-                                      natural_height_p);
+  /* measured labels don't wrap, so their height doesn't depend on width */
+  if (priv->measure_valid)
+    {
+      if (min_height_p)
+        *min_height_p = priv->measured_height;
+      if (natural_height_p)
+        *natural_height_p = priv->measured_height;
+    }
+  else
+    clutter_actor_get_preferred_height (priv->label, for_width,
+                                        min_height_p,
+                                        natural_height_p);
 
   if (min_height_p)
     *min_height_p += padding.top + padding.bottom;
@@ -240,6 +323,56 @@ mx_label_get_preferred_height (ClutterActor *actor,
     *natural_height_p += padding.top + padding.bottom;
 }
 
+static void
+mx_label_align_measured_box (MxLabel         *label,
+                             ClutterActorBox *box,
+                             gboolean         x_fill,
+                             gboolean         y_fill)
+{
+  MxLabelPrivate *priv = label->priv;
+  gfloat avail_width, avail_height, width, height;
+
+  /* this is mx_allocate_align_fill(), using the measured size of the text
+   * instead of requesting it from the ClutterText */
+  avail_width = MAX (0, box->x2 - box->x1);
+  avail_height = MAX (0, box->y2 - box->y1);
+
+  if (x_fill)
+    box->x2 = (int)(box->x1 + avail_width);
+  else
+    {
+      width = CLAMP (priv->measured_natural_width, priv->measured_min_width,
+                     avail_width);
+      box->x1 += (int)((avail_width - width) *
+                       MX_ALIGN_TO_FLOAT (priv->x_align));
+      box->x2 = box->x1 + (int) width;
+    }
+
+  if (y_fill)
+    box->y2 = (int)(box->y1 + avail_height);
+  else
+    {
+      height = MIN (priv->measured_height, avail_height);
+      box->y1 += (int)((avail_height - height) *
+                       MX_ALIGN_TO_FLOAT (priv->y_align));
+      box->y2 = box->y1 + (int) height;
+    }
+}
+
+static void
+mx_label_clear_fade_layout (MxLabel *label)
+{
+  MxLabelPrivate *priv = label->priv;
+
+  if (priv->fade_layout)
+    {
+      g_object_unref (priv->fade_layout);
+      priv->fade_layout = NULL;
+    }
+
+  priv->fade_layout_valid = FALSE;
+}
+
 static void
 mx_label_allocate (ClutterActor          *actor,
                    const ClutterActorBox *box,
@@ -269,20 +402,27 @@ mx_label_allocate (ClutterActor          *actor,
   x_fill = (priv->x_align == MX_ALIGN_START) ? TRUE : FALSE;
   y_fill = (priv->y_align == MX_ALIGN_START) ? TRUE : FALSE;
 
-  mx_allocate_align_fill (priv->label, &child_box, priv->x_align,
-                          priv->y_align, x_fill, y_fill);
+  if (priv->measure_valid)
+    mx_label_align_measured_box (MX_LABEL (actor), &child_box, x_fill, y_fill);
+  else
+    mx_allocate_align_fill (priv->label, &child_box, priv->x_align,
+                            priv->y_align, x_fill, y_fill);
 
   priv->label_should_fade = FALSE;
 
   if (priv->fade_out)
     {
       /* If we're fading out, make sure the label has its full width
-       * allocated. This ensures that the offscreen effect has the full
-       * label inside its texture.
+       * allocated, so the layout isn't ellipsized. The text is clipped
+       * to the available width when it is painted.
        */
       gfloat label_width;
 
-      clutter_actor_get_preferred_width (priv->label, -1, NULL, &label_width);
+      if (priv->measure_valid)
+        label_width = priv->measured_natural_width;
+      else
+        clutter_actor_get_preferred_width (priv->label, -1, NULL,
+                                           &label_width);
 
       if (label_width > avail_width)
         {
@@ -290,8 +430,12 @@ mx_label_allocate (ClutterActor          *actor,
           child_box.x2 = child_box.x1 + label_width;
         }
 
-      mx_fade_effect_set_bounds (MX_FADE_EFFECT (priv->fade_effect),
-                                 0, 0, MIN (label_width, avail_width), 0);
+      label_width = MIN (label_width, avail_width);
+      if (priv->fade_width != label_width)
+        {
+          priv->fade_width = label_width;
+          mx_label_clear_fade_layout (MX_LABEL (actor));
+        }
     }
 
   /* Allocate the label */
@@ -330,6 +474,222 @@ mx_label_allocate (ClutterActor          *actor,
     }
 }
 
+typedef struct
+{
+  PangoAttrList *attrs;
+  guint          start;
+} MxLabelTrimData;
+
+static gboolean
+mx_label_trim_attr (PangoAttribute *attr,
+                    gpointer        data)
+{
+  MxLabelTrimData *trim = data;
+  PangoAttribute *copy;
+
+  if (attr->end_index <= trim->start)
+    return FALSE;
+
+  copy = pango_attribute_copy (attr);
+  copy->start_index = MAX (attr->start_index, trim->start) - trim->start;
+  if (attr->end_index != G_MAXUINT)
+    copy->end_index = attr->end_index - trim->start;
+  pango_attr_list_insert (trim->attrs, copy);
+
+  /* keep the attribute in the original list */
+  return FALSE;
+}
+
+/* Creates a layout of the text of @layout from the start of the word at @x
+ * onwards, and stores where to draw it in @x_offset and @y_offset. Starting
+ * after a space means the glyphs are shaped the same way as in @layout.
+ * Returns %NULL if the layout can't be trimmed, in which case all of it has
+ * to be drawn. */
+static PangoLayout *
+mx_label_trim_layout (PangoLayout *layout,
+                      gfloat       x,
+                      gfloat      *x_offset,
+                      gfloat      *y_offset)
+{
+  PangoLayoutLine *line;
+  PangoLayout *trimmed;
+  PangoAttrList *attrs;
+  PangoRectangle pos;
+  const gchar *text, *space;
+  gint index, trailing;
+
+  /* only single lines of left-to-right text keep their glyphs in the
+   * order of the text */
+  if (pango_layout_get_line_count (layout) != 1)
+    return NULL;
+
+  line = pango_layout_get_line_readonly (layout, 0);
+  if (line->resolved_dir != PANGO_DIRECTION_LTR)
+    return NULL;
+
+  if (!pango_layout_xy_to_index (layout, x * PANGO_SCALE, 0,
+                                 &index, &trailing))
+    return NULL;
+
+  text = pango_layout_get_text (layout);
+  space = g_strrstr_len (text, index, " ");
+  if (space)
+    index = space + 1 - text;
+
+  pango_layout_index_to_pos (layout, index, &pos);
+
+  trimmed = pango_layout_copy (layout);
+  pango_layout_set_width (trimmed, -1);
+  pango_layout_set_alignment (trimmed, PANGO_ALIGN_LEFT);
+  pango_layout_set_indent (trimmed, 0);
+  pango_layout_set_ellipsize (trimmed, PANGO_ELLIPSIZE_NONE);
+  pango_layout_set_text (trimmed, text + index, -1);
+
+  attrs = pango_layout_get_attributes (layout);
+  if (attrs)
+    {
+      MxLabelTrimData trim;
+
+      trim.attrs = pango_attr_list_new ();
+      trim.start = index;
+      pango_attr_list_filter (attrs, mx_label_trim_attr, &trim);
+
+      pango_layout_set_attributes (trimmed, trim.attrs);
+      pango_attr_list_unref (trim.attrs);
+    }
+
+  /* line the baselines up, in case the fonts of the rest of the text made
+   * the line taller */
+  *x_offset = pos.x / (gfloat) PANGO_SCALE;
+  *y_offset = (pango_layout_get_baseline (layout)
+               - pango_layout_get_baseline (trimmed)) / (gfloat) PANGO_SCALE;
+
+  return trimmed;
+}
+
+/* Paints the layout of the ClutterText directly, with the opacity of the
+ * glyphs decreasing across the border at the end of the visible width.
+ * The border is split into a few steps that are each clipped to their own
+ * rectangle and drawn with the colour of the text at a lower alpha, so the
+ * gradient is applied as the glyphs are drawn, without an offscreen buffer
+ * and without depending on what is behind the label.
+ *
+ * The steps only draw the end of the text, from the start of the word at
+ * the border, which is laid out once and kept, so cogl-pango can reuse the
+ * geometry it caches for it.
+ *
+ * Labels aren't editable, so there is no cursor or selection to draw.
+ */
+static void
+mx_label_paint_faded (MxLabel *label)
+{
+  MxLabelPrivate *priv = label->priv;
+  ClutterText *text = CLUTTER_TEXT (priv->label);
+  ClutterColor text_color;
+  ClutterActorBox box;
+  PangoLayout *layout, *fade_layout;
+  CoglColor color;
+  gfloat height, border, fade_start, step_width, progress, split;
+  gfloat x_offset, y_offset;
+  guint8 opacity;
+  gint i;
+
+  clutter_actor_get_allocation_box (priv->label, &box);
+  height = box.y2 - box.y1;
+
+  layout = clutter_text_get_layout (text);
+  clutter_text_get_color (text, &text_color);
+  opacity = clutter_actor_get_paint_opacity (priv->label)
+          * text_color.alpha / 255;
+
+  if (!opacity)
+    return;
+
+  progress = clutter_timeline_get_progress (priv->fade_timeline);
+
+  border = MIN (priv->em_width * 5, priv->fade_width);
+  fade_start = priv->fade_width - border;
+  step_width = border / MX_LABEL_FADE_STEPS;
+
+  if (!priv->fade_layout_valid)
+    {
+      priv->fade_layout_valid = TRUE;
+      priv->fade_layout_x = priv->fade_layout_y = 0;
+      priv->fade_layout = mx_label_trim_layout (layout, fade_start,
+                                                &priv->fade_layout_x,
+                                                &priv->fade_layout_y);
+    }
+
+  if (priv->fade_layout)
+    {
+      fade_layout = priv->fade_layout;
+      x_offset = priv->fade_layout_x;
+      y_offset = priv->fade_layout_y;
+    }
+  else
+    {
+      fade_layout = layout;
+      x_offset = y_offset = 0;
+    }
+
+  cogl_push_matrix ();
+  cogl_translate (box.x1, box.y1, 0);
+
+  cogl_color_init_from_4ub (&color,
+                            text_color.red,
+                            text_color.green,
+                            text_color.blue,
+                            opacity);
+  cogl_color_premultiply (&color);
+
+  /* the text before the trimmed layout is drawn once at full opacity */
+  split = fade_layout == layout ? fade_start : x_offset;
+  if (split > 0)
+    {
+      cogl_clip_push_rectangle (0, 0, split, height);
+      cogl_pango_render_layout (layout, 0, 0, &color, 0);
+      cogl_clip_pop ();
+    }
+
+  /* and so is the start of the trimmed layout, before the border */
+  cogl_translate (x_offset, y_offset, 0);
+
+  if (fade_start > split)
+    {
+      cogl_clip_push_rectangle (split - x_offset, -y_offset,
+                                fade_start - x_offset, height - y_offset);
+      cogl_pango_render_layout (fade_layout, 0, 0, &color, 0);
+      cogl_clip_pop ();
+    }
+
+  for (i = 0; i < MX_LABEL_FADE_STEPS; i++)
+    {
+      gfloat x1, x2;
+      guint8 alpha;
+
+      x1 = fade_start + i * step_width;
+      x2 = x1 + step_width;
+      alpha = opacity * (1.0 - progress * (i + 0.5) / MX_LABEL_FADE_STEPS);
+
+      if (x2 <= x1 || alpha == 0)
+        continue;
+
+      cogl_color_init_from_4ub (&color,
+                                text_color.red,
+                                text_color.green,
+                                text_color.blue,
+                                alpha);
+      cogl_color_premultiply (&color);
+
+      cogl_clip_push_rectangle (x1 - x_offset, -y_offset,
+                                x2 - x_offset, height - y_offset);
+      cogl_pango_render_layout (fade_layout, 0, 0, &color, 0);
+      cogl_clip_pop ();
+    }
+
+  cogl_pop_matrix ();
+}
+
 static void
 mx_label_paint (ClutterActor *actor)
 {
@@ -339,8 +699,15 @@ mx_label_paint (ClutterActor *actor)
   parent_class = CLUTTER_ACTOR_CLASS (mx_label_parent_class);
   parent_class->paint (actor);
 
-  clutter_actor_paint (priv->label);
-  _mx_fade_effect_set_freeze_update (MX_FADE_EFFECT (priv->fade_effect), TRUE);
+  if (priv->fade_out &&
+      (priv->label_should_fade ||
+       clutter_timeline_is_playing (priv->fade_timeline)))
+    {
+      if (CLUTTER_ACTOR_IS_VISIBLE (priv->label))
+        mx_label_paint_faded (MX_LABEL (actor));
+    }
+  else
+    clutter_actor_paint (priv->label);
 }
 
 static void
@@ -368,6 +735,8 @@ mx_label_dispose (GObject *actor)
       priv->fade_timeline = NULL;
     }
 
+  mx_label_clear_fade_layout (MX_LABEL (actor));
+
   G_OBJECT_CLASS (mx_label_parent_class)->dispose (actor);
 }
 
@@ -477,15 +846,6 @@ mx_label_single_line_mode_cb (ClutterText *text,
     mx_label_set_fade_out (self, FALSE);
 }
 
-static void
-mx_label_label_changed_cb (MxLabel *label)
-{
-  MxLabelPrivate *priv = label->priv;
-
-  /* Enable updating of the off-screen texture */
-  _mx_fade_effect_set_freeze_update (MX_FADE_EFFECT (priv->fade_effect), FALSE);
-}
-
 static void
 mx_label_font_description_cb (ClutterText *text,
                               GParamSpec  *pspec,
@@ -518,57 +878,39 @@ mx_label_font_description_cb (ClutterText *text,
 
       priv->em_width = (1.2f * font_size) * dpi / 96.f;
 
-      mx_fade_effect_set_border (MX_FADE_EFFECT (priv->fade_effect),
-                                 0, priv->em_width * 5, 0, 0);
+      clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
     }
 }
 
 static void
-mx_label_fade_new_frame_cb (ClutterTimeline *timeline,
-                            gint             msecs,
-                            MxLabel         *self)
+mx_label_label_queue_relayout_cb (ClutterText *text,
+                                  MxLabel     *label)
 {
-  guint8 a;
-  ClutterColor color;
-
-  MxLabelPrivate *priv = self->priv;
-
-  a = (1.0 - clutter_timeline_get_progress (priv->fade_timeline)) * 255;
-
-  color.red = a;
-  color.green = a;
-  color.blue = a;
-  color.alpha = a;
-
-  mx_fade_effect_set_color (MX_FADE_EFFECT (priv->fade_effect), &color);
-
-  clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+  /* the text, font or layout settings have changed */
+  label->priv->measure_valid = FALSE;
+  mx_label_clear_fade_layout (label);
 }
 
 static void
-mx_label_fade_started_cb (ClutterTimeline *timeline,
-                          MxLabel         *label)
+mx_label_fade_new_frame_cb (ClutterTimeline *timeline,
+                            gint             msecs,
+                            MxLabel         *self)
 {
-  clutter_actor_meta_set_enabled (CLUTTER_ACTOR_META (label->priv->fade_effect),
-                                  TRUE);
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
 }
 
 static void
 mx_label_fade_completed_cb (ClutterTimeline *timeline,
                             MxLabel         *label)
 {
-  MxLabelPrivate *priv = label->priv;
-
-  if (!priv->label_should_fade)
-    clutter_actor_meta_set_enabled (CLUTTER_ACTOR_META (priv->fade_effect),
-                                    FALSE);
+  /* switch back to painting the ClutterText itself */
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (label));
 }
 
 static void
 mx_label_init (MxLabel *label)
 {
   MxLabelPrivate *priv;
-  const ClutterColor opaque = { 0xff, 0xff, 0xff, 0xff };
 
   label->priv = priv = MX_LABEL_GET_PRIVATE (label);
 
@@ -578,30 +920,255 @@ mx_label_init (MxLabel *label)
 
   clutter_actor_add_child (CLUTTER_ACTOR (label), priv->label);
 
-  priv->fade_effect = mx_fade_effect_new ();
-  mx_fade_effect_set_color (MX_FADE_EFFECT (priv->fade_effect), &opaque);
-  clutter_actor_add_effect (priv->label, priv->fade_effect);
-  clutter_actor_meta_set_enabled (CLUTTER_ACTOR_META (priv->fade_effect),
-                                  FALSE);
-
   g_signal_connect (label, "style-changed",
                     G_CALLBACK (mx_label_style_changed), NULL);
   g_signal_connect (priv->label, "notify::single-line-mode",
                     G_CALLBACK (mx_label_single_line_mode_cb), label);
-  g_signal_connect_swapped (priv->label, "queue-redraw",
-                            G_CALLBACK (mx_label_label_changed_cb), label);
+  g_signal_connect (priv->label, "queue-relayout",
+                    G_CALLBACK (mx_label_label_queue_relayout_cb), label);
 
   priv->fade_timeline = clutter_timeline_new (250);
   clutter_timeline_set_progress_mode (priv->fade_timeline,
                                       CLUTTER_EASE_OUT_QUAD);
   g_signal_connect (priv->fade_timeline, "new-frame",
                     G_CALLBACK (mx_label_fade_new_frame_cb), label);
-  g_signal_connect (priv->fade_timeline, "started",
-                    G_CALLBACK (mx_label_fade_started_cb), label);
   g_signal_connect (priv->fade_timeline, "completed",
                     G_CALLBACK (mx_label_fade_completed_cb), label);
 }
 
+/* Gets the context for the @n-th thread measuring labels, set up like the
+ * contexts Clutter creates for actors. Font maps can only be created on the
+ * main thread, as CoglPango font maps hold on to the Cogl context. */
+static PangoContext *
+mx_label_get_measure_context (guint                       n,
+                              gdouble                     resolution,
+                              const cairo_font_options_t *font_options)
+{
+  PangoContext *context;
+
+  if (!mx_label_measure_contexts)
+    mx_label_measure_contexts = g_ptr_array_new ();
+
+  while (mx_label_measure_contexts->len <= n)
+    {
+      PangoFontMap *font_map = cogl_pango_font_map_new ();
+
+      context = pango_font_map_create_context (font_map);
+      pango_context_set_language (context, pango_language_get_default ());
+      g_ptr_array_add (mx_label_measure_contexts, context);
+
+      g_object_unref (font_map);
+    }
+
+  context = g_ptr_array_index (mx_label_measure_contexts, n);
+
+  cogl_pango_font_map_set_resolution (COGL_PANGO_FONT_MAP
+                                      (pango_context_get_font_map (context)),
+                                      resolution);
+  pango_cairo_context_set_resolution (context, resolution);
+  pango_cairo_context_set_font_options (context, font_options);
+
+  return context;
+}
+
+static void
+mx_label_measure (PangoContext       *context,
+                  MxLabelMeasureData *data)
+{
+  PangoRectangle logical_rect = { 0, };
+  PangoLayout *layout;
+  gint logical_width, logical_height;
+
+  layout = pango_layout_new (context);
+  pango_layout_set_font_description (layout, data->font);
+  pango_layout_set_attributes (layout, data->attrs);
+  pango_layout_set_text (layout, data->text, -1);
+  pango_layout_get_extents (layout, NULL, &logical_rect);
+  g_object_unref (layout);
+
+  /* calculate the size in the same way as ClutterText's size request */
+  logical_width = logical_rect.x + logical_rect.width;
+  logical_height = logical_rect.y + logical_rect.height;
+
+  data->natural_width = (logical_width > 0) ?
+    ceilf (logical_width / 1024.0f) : 1;
+  data->min_width = (data->ellipsize) ? 1 : data->natural_width;
+  data->height = ceilf (logical_height / 1024.0f);
+}
+
+/* Measures labels of @batch until there are none left */
+static void
+mx_label_measure_batch (MxLabelMeasureBatch *batch,
+                        PangoContext        *context)
+{
+  gint i;
+
+  while ((i = g_atomic_int_add (&batch->next, 1)) < batch->n_data)
+    mx_label_measure (context, &batch->data[i]);
+}
+
+static void
+mx_label_measure_cb (gpointer task_data,
+                     gpointer user_data)
+{
+  MxLabelMeasureTask *task = task_data;
+  MxLabelMeasureBatch *batch = task->batch;
+
+  mx_label_measure_batch (batch, task->context);
+
+  g_mutex_lock (&batch->lock);
+  if (--batch->pending == 0)
+    g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->lock);
+}
+
+static gboolean
+mx_label_needs_measuring (ClutterActor *actor)
+{
+  ClutterText *text;
+
+  if (!MX_IS_LABEL (actor) || !CLUTTER_ACTOR_IS_VISIBLE (actor) ||
+      MX_LABEL (actor)->priv->measure_valid)
+    return FALSE;
+
+  text = CLUTTER_TEXT (MX_LABEL (actor)->priv->label);
+
+  /* only simple, non-wrapping labels can be measured outside of ClutterText,
+   * anything else is left to the normal size request */
+  return (!clutter_text_get_line_wrap (text) &&
+          !clutter_text_get_use_markup (text) &&
+          !clutter_text_get_single_line_mode (text) &&
+          !clutter_text_get_editable (text) &&
+          clutter_text_get_password_char (text) == 0);
+}
+
+/* Measures the MxLabel children of @container on the main thread and on a
+ * pool of worker threads, so that the following size requests and
+ * allocation can use the measured sizes instead of laying out the text one
+ * label at a time. This is only done when enough labels need measuring to
+ * be worth it.
+ */
+void
+_mx_label_measure_children (ClutterActor *container)
+{
+  MxLabelMeasureBatch batch;
+  MxLabelMeasureTask *tasks;
+  MxLabelMeasureData *data;
+  ClutterBackend *backend;
+  const cairo_font_options_t *font_options;
+  gdouble resolution;
+  ClutterActorIter iter;
+  ClutterActor *child;
+  GPtrArray *labels;
+  gint i, n_workers;
+
+  labels = NULL;
+  clutter_actor_iter_init (&iter, container);
+  while (clutter_actor_iter_next (&iter, &child))
+    {
+      if (!mx_label_needs_measuring (child))
+        continue;
+
+      if (!labels)
+        labels = g_ptr_array_new ();
+
+      g_ptr_array_add (labels, child);
+    }
+
+  if (!labels)
+    return;
+
+  if (labels->len < MX_LABEL_PARALLEL_MEASURE_THRESHOLD)
+    {
+      g_ptr_array_free (labels, TRUE);
+      return;
+    }
+
+  /* the main thread measures labels too */
+  n_workers = MIN (g_get_num_processors (), (gint) labels->len) - 1;
+
+  if (n_workers > 0 && !mx_label_threads)
+    mx_label_threads = g_thread_pool_new (mx_label_measure_cb, NULL,
+                                          g_get_num_processors () - 1,
+                                          FALSE, NULL);
+
+  if (!mx_label_threads)
+    n_workers = 0;
+
+  /* ClutterText lays out with the resolution and font options of the
+   * backend, which Clutter sets on its CoglPango font map and on the
+   * actors' contexts, so the measuring contexts are set up the same way */
+  backend = clutter_get_default_backend ();
+  resolution = clutter_backend_get_resolution (backend);
+  font_options = clutter_backend_get_font_options (backend);
+
+  /* copy everything the worker threads need, as neither the actors nor their
+   * Pango context can be touched outside of the main thread */
+  data = g_new0 (MxLabelMeasureData, labels->len);
+  for (i = 0; i < (gint) labels->len; i++)
+    {
+      MxLabel *label = g_ptr_array_index (labels, i);
+      ClutterText *text = CLUTTER_TEXT (label->priv->label);
+
+      data[i].label = label;
+      data[i].text = g_strdup (clutter_text_get_text (text));
+      data[i].font =
+        pango_font_description_copy (clutter_text_get_font_description (text));
+      data[i].attrs = clutter_text_get_attributes (text);
+      if (data[i].attrs)
+        data[i].attrs = pango_attr_list_copy (data[i].attrs);
+      data[i].ellipsize =
+        (clutter_text_get_ellipsize (text) != PANGO_ELLIPSIZE_NONE);
+    }
+
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+  batch.pending = n_workers;
+  batch.next = 0;
+  batch.data = data;
+  batch.n_data = labels->len;
+
+  tasks = g_new0 (MxLabelMeasureTask, n_workers + 1);
+  for (i = 0; i <= n_workers; i++)
+    {
+      tasks[i].batch = &batch;
+      tasks[i].context = mx_label_get_measure_context (i, resolution,
+                                                       font_options);
+    }
+
+  for (i = 1; i <= n_workers; i++)
+    g_thread_pool_push (mx_label_threads, &tasks[i], NULL);
+
+  mx_label_measure_batch (&batch, tasks[0].context);
+
+  g_mutex_lock (&batch.lock);
+  while (batch.pending > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+  g_mutex_unlock (&batch.lock);
+
+  for (i = 0; i < (gint) labels->len; i++)
+    {
+      MxLabelPrivate *priv = data[i].label->priv;
+
+      priv->measured_min_width = data[i].min_width;
+      priv->measured_natural_width = data[i].natural_width;
+      priv->measured_height = data[i].height;
+      priv->measure_valid = TRUE;
+
+      g_free (data[i].text);
+      pango_font_description_free (data[i].font);
+      if (data[i].attrs)
+        pango_attr_list_unref (data[i].attrs);
+    }
+
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
+
+  g_free (tasks);
+  g_free (data);
+  g_ptr_array_free (labels, TRUE);
+}
+
 /**
  * mx_label_new:
  *
@@ -902,7 +1469,7 @@ mx_label_set_fade_out (MxLabel  *label,
       priv->fade_out = fade;
       g_object_notify (G_OBJECT (label), "fade-out");
 
-      /* Enable the fade-effect */
+      /* Disable ellipsizing, the end of the text is faded instead */
       if (fade)
         {
           priv->label_should_fade = FALSE;
@@ -32,12 +32,26 @@
  *
  * Data is set on the children by mapping columns in the model to object
  * properties on the children.
+ *
+ * When #MxListView:section-column is set, consecutive rows that share the
+ * same value in that column are grouped into sections, each introduced by a
+ * header actor. In this mode the view is virtualised: actors are only
+ * created for the rows and headers that are on screen, and are recycled as
+ * the view scrolls, so memory use is proportional to the size of the view
+ * rather than the size of the model. The header of the section at the top of
+ * the view is kept pinned in place until the next header pushes it away.
+ * Sectioned mode assumes that all items share the same height, and that all
+ * headers share the same height.
  */
 
+#include <string.h>
+
 #include "mx-list-view.h"
 #include "mx-box-layout.h"
 #include "mx-private.h"
 #include "mx-item-factory.h"
+#include "mx-label.h"
+#include "mx-scrollable.h"
 
 G_DEFINE_TYPE (MxListView, mx_list_view, MX_TYPE_BOX_LAYOUT)
 
@@ -50,13 +64,32 @@ typedef struct
   gint   col;
 } AttributeData;
 
+typedef struct
+{
+  gint   first_row;
+  gint   n_rows;
+  gchar *key;
+} MxListViewSection;
+
+/* The sections and rows that have actors, rows being indices in the model.
+ * The visible rows are contiguous, even across sections. */
+typedef struct
+{
+  gint first_section;
+  gint last_section;
+  gint first_row;
+  gint last_row;
+} MxListViewRange;
+
 enum
 {
   PROP_0,
 
   PROP_MODEL,
   PROP_ITEM_TYPE,
-  PROP_FACTORY
+  PROP_FACTORY,
+  PROP_SECTION_COLUMN,
+  PROP_HEADER_FACTORY
 };
 
 struct _MxListViewPrivate
@@ -74,8 +107,41 @@ struct _MxListViewPrivate
   gulong         sort_changed;
 
   guint          is_frozen : 1;
+
+  /* sectioned mode */
+  guint          sections_valid : 1;
+  guint          sizes_valid    : 1;
+
+  gint           section_column;
+  MxItemFactory *header_factory;
+  GSList        *header_attributes;
+
+  GArray        *sections;
+  GHashTable    *visible_items;
+  GHashTable    *visible_headers;
+  GQueue         item_pool;
+  GQueue         header_pool;
+
+  gfloat         sizes_for_width;
+  gfloat         item_height;
+  gfloat         header_height;
+  gfloat         min_width;
+  gfloat         natural_width;
+
+  MxAdjustment  *vadjustment;
+
+  /* what was laid out by the last allocation; scrolling within it only
+   * moves the pinned header */
+  MxListViewRange range;
+  ClutterActor   *pinned_header;
+  gdouble         pinned_header_y;
 };
 
+static void mx_list_view_clear_sections (MxListView *list_view);
+static void mx_list_view_value_notify_cb (MxAdjustment *adjustment,
+                                          GParamSpec   *pspec,
+                                          MxListView   *list_view);
+
 /* gobject implementations */
 
 static void
@@ -96,6 +162,12 @@ mx_list_view_get_property (GObject    *object,
     case PROP_FACTORY:
       g_value_set_object (value, priv->factory);
       break;
+    case PROP_SECTION_COLUMN:
+      g_value_set_int (value, priv->section_column);
+      break;
+    case PROP_HEADER_FACTORY:
+      g_value_set_object (value, priv->header_factory);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -121,6 +193,15 @@ mx_list_view_set_property (GObject      *object,
       mx_list_view_set_factory ((MxListView*) object,
                                 (MxItemFactory*) g_value_get_object (value));
       break;
+    case PROP_SECTION_COLUMN:
+      mx_list_view_set_section_column ((MxListView*) object,
+                                       g_value_get_int (value));
+      break;
+    case PROP_HEADER_FACTORY:
+      mx_list_view_set_header_factory ((MxListView*) object,
+                                       (MxItemFactory*)
+                                       g_value_get_object (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -140,6 +221,21 @@ mx_list_view_dispose (GObject *object)
       priv->factory = NULL;
     }
 
+  if (priv->header_factory)
+    {
+      g_object_unref (priv->header_factory);
+      priv->header_factory = NULL;
+    }
+
+  if (priv->vadjustment)
+    {
+      g_signal_handlers_disconnect_by_func (priv->vadjustment,
+                                            mx_list_view_value_notify_cb,
+                                            object);
+      g_object_unref (priv->vadjustment);
+      priv->vadjustment = NULL;
+    }
+
   G_OBJECT_CLASS (mx_list_view_parent_class)->dispose (object);
 }
 
@@ -162,13 +258,881 @@ mx_list_view_finalize (GObject *object)
       priv->attributes = NULL;
     }
 
+  if (priv->header_attributes)
+    {
+      g_slist_foreach (priv->header_attributes, (GFunc) free_attribute, NULL);
+      g_slist_free (priv->header_attributes);
+      priv->header_attributes = NULL;
+    }
+
+  mx_list_view_clear_sections (MX_LIST_VIEW (object));
+  g_array_free (priv->sections, TRUE);
+
+  g_hash_table_destroy (priv->visible_items);
+  g_hash_table_destroy (priv->visible_headers);
+  g_queue_clear (&priv->item_pool);
+  g_queue_clear (&priv->header_pool);
+
   G_OBJECT_CLASS (mx_list_view_parent_class)->finalize (object);
 }
 
+/* sectioned mode */
+
+static void
+mx_list_view_clear_sections (MxListView *list_view)
+{
+  MxListViewPrivate *priv = list_view->priv;
+  guint i;
+
+  for (i = 0; i < priv->sections->len; i++)
+    g_free (g_array_index (priv->sections, MxListViewSection, i).key);
+
+  g_array_set_size (priv->sections, 0);
+}
+
+static void
+mx_list_view_release_actors (GHashTable *visible,
+                             GQueue     *pool)
+{
+  GHashTableIter iter;
+  gpointer actor;
+
+  g_hash_table_iter_init (&iter, visible);
+  while (g_hash_table_iter_next (&iter, NULL, &actor))
+    g_queue_push_tail (pool, actor);
+
+  g_hash_table_remove_all (visible);
+}
+
+/* Puts the visible actors back into the pools, to be filled in again with
+ * the rows they show at the next allocation */
+static void
+mx_list_view_release_visible (MxListView *list_view)
+{
+  MxListViewPrivate *priv = list_view->priv;
+
+  mx_list_view_release_actors (priv->visible_items, &priv->item_pool);
+  mx_list_view_release_actors (priv->visible_headers, &priv->header_pool);
+  priv->pinned_header = NULL;
+  priv->range.first_section = -1;
+
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (list_view));
+}
+
+/* Called whenever the model changes as a whole in sectioned mode. The
+ * section index is rebuilt lazily at the next size request.
+ */
+static void
+mx_list_view_invalidate_sections (MxListView *list_view)
+{
+  MxListViewPrivate *priv = list_view->priv;
+
+  mx_list_view_release_visible (list_view);
+
+  priv->sections_valid = FALSE;
+  priv->sizes_valid = FALSE;
+}
+
+/* Drop every child and pooled actor, used when switching modes */
+static void
+mx_list_view_reset_children (MxListView *list_view)
+{
+  MxListViewPrivate *priv = list_view->priv;
+
+  g_hash_table_remove_all (priv->visible_items);
+  g_hash_table_remove_all (priv->visible_headers);
+  g_queue_clear (&priv->item_pool);
+  g_queue_clear (&priv->header_pool);
+
+  clutter_actor_destroy_all_children (CLUTTER_ACTOR (list_view));
+  priv->pinned_header = NULL;
+  priv->range.first_section = -1;
+
+  mx_list_view_clear_sections (list_view);
+  priv->sections_valid = FALSE;
+  priv->sizes_valid = FALSE;
+}
+
+static gchar *
+mx_list_view_get_section_key (ClutterModelIter *iter,
+                              gint              column)
+{
+  GValue value = { 0, };
+  GValue string = { 0, };
+  gchar *key = NULL;
+
+  clutter_model_iter_get_value (iter, column, &value);
+
+  g_value_init (&string, G_TYPE_STRING);
+  if (g_value_transform (&value, &string))
+    key = g_value_dup_string (&string);
+
+  g_value_unset (&string);
+  g_value_unset (&value);
+
+  return key;
+}
+
+/* Groups the rows from @start up to @end, or to the last row if @end is
+ * -1, into sections that are appended to @sections */
+static void
+mx_list_view_scan_sections (MxListView *list_view,
+                            gint        start,
+                            gint        end,
+                            GArray     *sections)
+{
+  MxListViewPrivate *priv = list_view->priv;
+  ClutterModelIter *iter;
+  MxListViewSection *section = NULL;
+  gint row;
+
+  if (end >= 0 && end <= start)
+    return;
+
+  iter = clutter_model_get_iter_at_row (priv->model, start);
+  for (row = start;
+       iter && !clutter_model_iter_is_last (iter) && (end < 0 || row < end);
+       row++)
+    {
+      gchar *key = mx_list_view_get_section_key (iter, priv->section_column);
+
+      if (section && !g_strcmp0 (section->key, key))
+        {
+          section->n_rows++;
+          g_free (key);
+        }
+      else
+        {
+          MxListViewSection new_section;
+
+          new_section.first_row = row;
+          new_section.n_rows = 1;
+          new_section.key = key;
+          g_array_append_val (sections, new_section);
+        }
+
+      section = &g_array_index (sections, MxListViewSection,
+                                sections->len - 1);
+
+      clutter_model_iter_next (iter);
+    }
+
+  if (iter)
+    g_object_unref (iter);
+}
+
+static void
+mx_list_view_ensure_sections (MxListView *list_view)
+{
+  MxListViewPrivate *priv = list_view->priv;
+
+  if (priv->sections_valid)
+    return;
+
+  priv->sections_valid = TRUE;
+  mx_list_view_clear_sections (list_view);
+
+  if (!priv->model)
+    return;
+
+  if (priv->section_column >= (gint) clutter_model_get_n_columns (priv->model))
+    {
+      g_warning ("The section column %d is not a valid column in the model",
+                 priv->section_column);
+      return;
+    }
+
+  mx_list_view_scan_sections (list_view, 0, -1, priv->sections);
+}
+
+/* Find the section that contains @row, which must be one of the rows */
+static gint
+mx_list_view_find_row_section (MxListView *list_view,
+                               gint        row)
+{
+  GArray *sections = list_view->priv->sections;
+  gint lower, upper;
+
+  lower = 0;
+  upper = sections->len - 1;
+
+  while (lower < upper)
+    {
+      gint middle = (lower + upper + 1) / 2;
+
+      if (g_array_index (sections, MxListViewSection, middle).first_row <= row)
+        lower = middle;
+      else
+        upper = middle - 1;
+    }
+
+  return lower;
+}
+
+/* Called when @row has been added (@delta is 1), changed (0) or removed
+ * (-1) in sectioned mode. Only the sections on either side of the row are
+ * scanned again: the rows at the ends of those sections haven't changed,
+ * so they still start and end sections.
+ */
+static void
+mx_list_view_update_sections (MxListView *list_view,
+                              gint        row,
+                              gint        delta)
+{
+  MxListViewPrivate *priv = list_view->priv;
+  MxListViewSection *section;
+  GArray *sections;
+  gint first, last, start, end, n_rows, next;
+  guint i, old_len;
+
+  if (!priv->sections_valid || clutter_model_get_filter_set (priv->model))
+    {
+      mx_list_view_invalidate_sections (list_view);
+      return;
+    }
+
+  old_len = priv->sections->len;
+  if (old_len == 0)
+    {
+      first = 0;
+      last = -1;
+      start = 0;
+      end = 0;
+    }
+  else
+    {
+      section = &g_array_index (priv->sections, MxListViewSection,
+                                old_len - 1);
+      n_rows = section->first_row + section->n_rows;
+
+      /* the row before and the row after, before the change */
+      first = mx_list_view_find_row_section (list_view, MAX (row - 1, 0));
+      next = (delta > 0) ? row : row + 1;
+      last = (next < n_rows) ?
+        mx_list_view_find_row_section (list_view, next) : (gint) old_len - 1;
+
+      start = g_array_index (priv->sections, MxListViewSection,
+                             first).first_row;
+      section = &g_array_index (priv->sections, MxListViewSection, last);
+      end = section->first_row + section->n_rows;
+    }
+
+  sections = g_array_new (FALSE, FALSE, sizeof (MxListViewSection));
+  mx_list_view_scan_sections (list_view, start, end + delta, sections);
+
+  for (i = first; (gint) i <= last; i++)
+    g_free (g_array_index (priv->sections, MxListViewSection, i).key);
+  g_array_remove_range (priv->sections, first, last - first + 1);
+  g_array_insert_vals (priv->sections, first, sections->data, sections->len);
+
+  for (i = first + sections->len; i < priv->sections->len; i++)
+    g_array_index (priv->sections, MxListViewSection, i).first_row += delta;
+
+  g_array_free (sections, TRUE);
+
+  /* the sizes are measured on the first section */
+  if (old_len == 0 || priv->sections->len == 0)
+    priv->sizes_valid = FALSE;
+
+  mx_list_view_release_visible (list_view);
+}
+
+static void
+mx_list_view_set_attributes (MxListView *list_view,
+                             GObject    *object,
+                             GSList     *attributes,
+                             gint        row)
+{
+  ClutterModelIter *iter;
+  GSList *p;
+
+  iter = clutter_model_get_iter_at_row (list_view->priv->model, row);
+  if (!iter)
+    return;
+
+  g_object_freeze_notify (object);
+  for (p = attributes; p; p = p->next)
+    {
+      GValue value = { 0, };
+      AttributeData *attr = p->data;
+
+      clutter_model_iter_get_value (iter, attr->col, &value);
+      g_object_set_property (object, attr->name, &value);
+      g_value_unset (&value);
+    }
+  g_object_thaw_notify (object);
+
+  g_object_unref (iter);
+}
+
+/* Take an item actor from the pool, or create a new one, and fill it in
+ * with the data from @row.
+ */
+static ClutterActor *
+mx_list_view_acquire_item (MxListView *list_view,
+                           gint        row)
+{
+  MxListViewPrivate *priv = list_view->priv;
+  ClutterActor *item;
+
+  item = g_queue_pop_head (&priv->item_pool);
+  if (!item)
+    {
+      if (priv->item_type)
+        item = g_object_new (priv->item_type, NULL);
+      else if (priv->factory)
+        item = mx_item_factory_create (priv->factory);
+      else
+        return NULL;
+
+      /* Keep items below the headers, so that the pinned header is
+       * painted on top of the items scrolling underneath it.
+       */
+      clutter_actor_insert_child_below (CLUTTER_ACTOR (list_view), item, NULL);
+    }
+
+  mx_list_view_set_attributes (list_view, G_OBJECT (item),
+                               priv->attributes, row);
+
+  return item;
+}
+
+static ClutterActor *
+mx_list_view_acquire_header (MxListView *list_view,
+                             gint        section_index)
+{
+  MxListViewPrivate *priv = list_view->priv;
+  MxListViewSection *section;
+  ClutterActor *header;
+
+  section = &g_array_index (priv->sections, MxListViewSection, section_index);
+
+  header = g_queue_pop_head (&priv->header_pool);
+  if (!header)
+    {
+      if (priv->header_factory)
+        header = mx_item_factory_create (priv->header_factory);
+      else
+        header = mx_label_new ();
+
+      clutter_actor_add_child (CLUTTER_ACTOR (list_view), header);
+    }
+
+  if (priv->header_attributes)
+    mx_list_view_set_attributes (list_view, G_OBJECT (header),
+                                 priv->header_attributes, section->first_row);
+  else if (MX_IS_LABEL (header))
+    mx_label_set_text (MX_LABEL (header), section->key ? section->key : "");
+
+  return header;
+}
+
+/* Measure one item and one header; every item and every header is assumed
+ * to have the same height, which is what makes it possible to position any
+ * row without creating actors for the rows before it.
+ */
+static void
+mx_list_view_ensure_sizes (MxListView *list_view,
+                           gfloat      for_width)
+{
+  MxListViewPrivate *priv = list_view->priv;
+  ClutterActor *actor;
+  gfloat min_width, natural_width;
+
+  if (priv->sizes_valid && priv->sizes_for_width == for_width)
+    return;
+
+  priv->sizes_valid = TRUE;
+  priv->sizes_for_width = for_width;
+  priv->item_height = 0;
+  priv->header_height = 0;
+  priv->min_width = 0;
+  priv->natural_width = 0;
+
+  if (priv->sections->len == 0 || (!priv->item_type && !priv->factory))
+    return;
+
+  actor = mx_list_view_acquire_item (list_view, 0);
+  clutter_actor_get_preferred_width (actor, -1, &min_width, &natural_width);
+  clutter_actor_get_preferred_height (actor, for_width, NULL,
+                                      &priv->item_height);
+  priv->min_width = min_width;
+  priv->natural_width = natural_width;
+  g_queue_push_head (&priv->item_pool, actor);
+
+  actor = mx_list_view_acquire_header (list_view, 0);
+  clutter_actor_get_preferred_width (actor, -1, &min_width, &natural_width);
+  clutter_actor_get_preferred_height (actor, for_width, NULL,
+                                      &priv->header_height);
+  priv->min_width = MAX (priv->min_width, min_width);
+  priv->natural_width = MAX (priv->natural_width, natural_width);
+  g_queue_push_head (&priv->header_pool, actor);
+}
+
+static gboolean
+mx_list_view_is_sectioned (MxListView *list_view)
+{
+  return (list_view->priv->section_column >= 0);
+}
+
+static gdouble
+mx_list_view_get_section_offset (MxListView *list_view,
+                                 gint        section_index,
+                                 gfloat      spacing)
+{
+  MxListViewPrivate *priv = list_view->priv;
+  MxListViewSection *section;
+
+  section = &g_array_index (priv->sections, MxListViewSection, section_index);
+
+  return section_index * (gdouble) (priv->header_height + spacing) +
+         section->first_row * (gdouble) (priv->item_height + spacing);
+}
+
+static gdouble
+mx_list_view_get_content_height (MxListView *list_view,
+                                 gfloat      spacing)
+{
+  MxListViewPrivate *priv = list_view->priv;
+  MxListViewSection *section;
+  gint n_rows;
+
+  if (priv->sections->len == 0)
+    return 0;
+
+  section = &g_array_index (priv->sections, MxListViewSection,
+                            priv->sections->len - 1);
+  n_rows = section->first_row + section->n_rows;
+
+  return priv->sections->len * (gdouble) (priv->header_height + spacing) +
+         n_rows * (gdouble) (priv->item_height + spacing) - spacing;
+}
+
+/* Find the last section that starts at or before @y */
+static gint
+mx_list_view_find_section (MxListView *list_view,
+                           gdouble     y,
+                           gfloat      spacing)
+{
+  gint lower, upper;
+
+  lower = 0;
+  upper = list_view->priv->sections->len - 1;
+
+  while (lower < upper)
+    {
+      gint middle = (lower + upper + 1) / 2;
+
+      if (mx_list_view_get_section_offset (list_view, middle, spacing) <= y)
+        lower = middle;
+      else
+        upper = middle - 1;
+    }
+
+  return lower;
+}
+
+/* Find the sections and rows that are at least partly inside of the
+ * visible range, which is in content coordinates */
+static void
+mx_list_view_get_range (MxListView      *list_view,
+                        gdouble          top,
+                        gdouble          bottom,
+                        gfloat           spacing,
+                        MxListViewRange *range)
+{
+  MxListViewPrivate *priv = list_view->priv;
+  gfloat item_stride, header_stride;
+  gint s;
+
+  item_stride = priv->item_height + spacing;
+  header_stride = priv->header_height + spacing;
+
+  range->first_section = (priv->sections->len && item_stride > 0) ?
+    mx_list_view_find_section (list_view, MAX (top, 0), spacing) :
+    (gint) priv->sections->len;
+  range->last_section = range->first_section - 1;
+  range->first_row = -1;
+  range->last_row = -1;
+
+  for (s = range->first_section; s < (gint) priv->sections->len; s++)
+    {
+      MxListViewSection *section;
+      gdouble y;
+      gint row;
+
+      y = mx_list_view_get_section_offset (list_view, s, spacing);
+      if (s != range->first_section && y >= bottom)
+        break;
+
+      section = &g_array_index (priv->sections, MxListViewSection, s);
+      range->last_section = s;
+
+      y += header_stride;
+      row = (top > y) ? (gint) ((top - y) / item_stride) : 0;
+
+      for (; row < section->n_rows; row++)
+        {
+          if (y + row * item_stride >= bottom)
+            break;
+
+          if (range->first_row < 0)
+            range->first_row = section->first_row + row;
+          range->last_row = section->first_row + row;
+        }
+    }
+}
+
+/* The header of the first visible section is pinned to the top of the
+ * view, until the next section's header pushes it up */
+static gdouble
+mx_list_view_get_pinned_header_y (MxListView *list_view,
+                                  gint        section_index,
+                                  gdouble     top,
+                                  gfloat      spacing)
+{
+  MxListViewPrivate *priv = list_view->priv;
+  gdouble y;
+
+  y = MAX (top, mx_list_view_get_section_offset (list_view, section_index,
+                                                 spacing));
+
+  if (section_index + 1 < (gint) priv->sections->len)
+    y = MIN (y, mx_list_view_get_section_offset (list_view, section_index + 1,
+                                                 spacing)
+                - (priv->header_height + spacing));
+
+  return y;
+}
+
+static void
+mx_list_view_value_notify_cb (MxAdjustment *adjustment,
+                              GParamSpec   *pspec,
+                              MxListView   *list_view)
+{
+  MxListViewPrivate *priv = list_view->priv;
+  MxListViewRange range;
+  ClutterActorBox box;
+  MxPadding padding;
+  gfloat spacing;
+  gdouble top, bottom, header_y;
+
+  /* MxBoxLayout scrolls the children with a transform, so the view only
+   * needs laying out again when the set of visible rows changes */
+  if (priv->range.first_section < 0 || !priv->sections_valid ||
+      !priv->sizes_valid)
+    return;
+
+  mx_widget_get_padding (MX_WIDGET (list_view), &padding);
+  clutter_actor_get_allocation_box (CLUTTER_ACTOR (list_view), &box);
+  spacing = mx_box_layout_get_spacing (MX_BOX_LAYOUT (list_view));
+
+  top = mx_adjustment_get_value (adjustment) - padding.top;
+  bottom = top + (box.y2 - box.y1);
+
+  mx_list_view_get_range (list_view, top, bottom, spacing, &range);
+  if (memcmp (&range, &priv->range, sizeof (MxListViewRange)))
+    {
+      priv->range.first_section = -1;
+      clutter_actor_queue_relayout (CLUTTER_ACTOR (list_view));
+      return;
+    }
+
+  if (!priv->pinned_header)
+    return;
+
+  /* MxBoxLayout culls the children by their allocation, so the pinned
+   * header is only moved with its translation while its allocation is
+   * still inside of the view */
+  if (priv->pinned_header_y + priv->header_height <= top ||
+      priv->pinned_header_y >= bottom)
+    {
+      priv->range.first_section = -1;
+      clutter_actor_queue_relayout (CLUTTER_ACTOR (list_view));
+      return;
+    }
+
+  header_y = mx_list_view_get_pinned_header_y (list_view, range.first_section,
+                                               top, spacing);
+  clutter_actor_set_translation (priv->pinned_header, 0,
+                                 (gint) header_y
+                                 - (gint) priv->pinned_header_y, 0);
+}
+
+static void
+mx_list_view_ensure_vadjustment (MxListView *list_view)
+{
+  MxListViewPrivate *priv = list_view->priv;
+  MxAdjustment *vadjustment;
+
+  mx_scrollable_get_adjustments (MX_SCROLLABLE (list_view), NULL,
+                                 &vadjustment);
+
+  if (vadjustment == priv->vadjustment)
+    return;
+
+  if (priv->vadjustment)
+    {
+      g_signal_handlers_disconnect_by_func (priv->vadjustment,
+                                            mx_list_view_value_notify_cb,
+                                            list_view);
+      g_object_unref (priv->vadjustment);
+    }
+
+  priv->vadjustment = g_object_ref (vadjustment);
+
+  /* The visible rows and the pinned header depend on the scroll offset */
+  g_signal_connect (priv->vadjustment, "notify::value",
+                    G_CALLBACK (mx_list_view_value_notify_cb), list_view);
+}
+
+static ClutterActor *
+mx_list_view_place_actor (MxListView             *list_view,
+                          GHashTable             *old_visible,
+                          GHashTable             *visible,
+                          gboolean                is_header,
+                          gint                    index,
+                          ClutterActorBox        *box,
+                          ClutterAllocationFlags  flags)
+{
+  ClutterActor *actor;
+  gpointer key = GINT_TO_POINTER (index);
+
+  actor = g_hash_table_lookup (old_visible, key);
+  if (actor)
+    g_hash_table_remove (old_visible, key);
+  else if (is_header)
+    actor = mx_list_view_acquire_header (list_view, index);
+  else
+    actor = mx_list_view_acquire_item (list_view, index);
+
+  if (!actor)
+    return NULL;
+
+  g_hash_table_insert (visible, key, actor);
+  clutter_actor_allocate (actor, box, flags);
+
+  return actor;
+}
+
+static void
+mx_list_view_allocate_pool (GQueue                 *pool,
+                            ClutterAllocationFlags  flags)
+{
+  ClutterActorBox empty = { 0, };
+  GList *l;
+
+  /* Pooled actors get an empty allocation, which MxBoxLayout's paint and
+   * pick skip, so there's no need to hide them (and queue a relayout).
+   */
+  for (l = pool->head; l; l = l->next)
+    clutter_actor_allocate (CLUTTER_ACTOR (l->data), &empty, flags);
+}
+
+static void
+mx_list_view_sectioned_allocate (MxListView             *list_view,
+                                 const ClutterActorBox  *box,
+                                 ClutterAllocationFlags  flags)
+{
+  MxListViewPrivate *priv = list_view->priv;
+  GHashTable *old_items, *old_headers;
+  ClutterActorBox child_box;
+  MxPadding padding;
+  gfloat width, height, spacing, item_stride, header_stride;
+  gdouble content_height, top, bottom;
+  gint s;
+
+  mx_widget_get_padding (MX_WIDGET (list_view), &padding);
+  width = MAX (0, box->x2 - box->x1 - padding.left - padding.right);
+  height = box->y2 - box->y1;
+  spacing = mx_box_layout_get_spacing (MX_BOX_LAYOUT (list_view));
+
+  mx_list_view_ensure_sections (list_view);
+  mx_list_view_ensure_sizes (list_view, width);
+
+  item_stride = priv->item_height + spacing;
+  header_stride = priv->header_height + spacing;
+  content_height = mx_list_view_get_content_height (list_view, spacing);
+
+  /* updating the adjustment can clamp its value, which mustn't be
+   * compared against the previous layout */
+  priv->range.first_section = -1;
+
+  mx_list_view_ensure_vadjustment (list_view);
+  g_object_set (G_OBJECT (priv->vadjustment),
+                "lower", 0.0,
+                "upper", content_height + padding.top + padding.bottom,
+                "page-size", (gdouble) height,
+                "step-increment", (gdouble) MAX (item_stride, 1),
+                "page-increment", (gdouble) height,
+                NULL);
+
+  /* The visible range, in content coordinates */
+  top = mx_adjustment_get_value (priv->vadjustment) - padding.top;
+  bottom = top + height;
+
+  mx_list_view_get_range (list_view, top, bottom, spacing, &priv->range);
+  priv->pinned_header = NULL;
+
+  old_items = priv->visible_items;
+  old_headers = priv->visible_headers;
+  priv->visible_items = g_hash_table_new (NULL, NULL);
+  priv->visible_headers = g_hash_table_new (NULL, NULL);
+
+  child_box.x1 = padding.left;
+  child_box.x2 = padding.left + width;
+
+  for (s = priv->range.first_section; s <= priv->range.last_section; s++)
+    {
+      MxListViewSection *section;
+      ClutterActor *header;
+      gdouble y, header_y;
+      gint row, last_row;
+
+      y = mx_list_view_get_section_offset (list_view, s, spacing);
+      section = &g_array_index (priv->sections, MxListViewSection, s);
+
+      if (s == priv->range.first_section)
+        header_y = mx_list_view_get_pinned_header_y (list_view, s, top,
+                                                     spacing);
+      else
+        header_y = y;
+
+      child_box.y1 = (gint) (padding.top + header_y);
+      child_box.y2 = child_box.y1 + priv->header_height;
+      header = mx_list_view_place_actor (list_view, old_headers,
+                                         priv->visible_headers, TRUE, s,
+                                         &child_box, flags);
+      clutter_actor_set_translation (header, 0, 0, 0);
+
+      if (s == priv->range.first_section)
+        {
+          priv->pinned_header = header;
+          priv->pinned_header_y = header_y;
+        }
+
+      if (priv->range.first_row < 0)
+        continue;
+
+      y += header_stride;
+      row = MAX (priv->range.first_row, section->first_row);
+      last_row = MIN (priv->range.last_row,
+                      section->first_row + section->n_rows - 1);
+
+      for (; row <= last_row; row++)
+        {
+          gdouble row_y = y + (row - section->first_row) * item_stride;
+
+          child_box.y1 = (gint) (padding.top + row_y);
+          child_box.y2 = child_box.y1 + priv->item_height;
+          mx_list_view_place_actor (list_view, old_items, priv->visible_items,
+                                    FALSE, row, &child_box, flags);
+        }
+    }
+
+  /* Anything that scrolled out of view goes back to the pools */
+  mx_list_view_release_actors (old_items, &priv->item_pool);
+  mx_list_view_release_actors (old_headers, &priv->header_pool);
+  g_hash_table_destroy (old_items);
+  g_hash_table_destroy (old_headers);
+
+  mx_list_view_allocate_pool (&priv->item_pool, flags);
+  mx_list_view_allocate_pool (&priv->header_pool, flags);
+}
+
+/* clutter actor implementations */
+
+static void
+mx_list_view_get_preferred_width (ClutterActor *actor,
+                                  gfloat        for_height,
+                                  gfloat       *min_width_p,
+                                  gfloat       *natural_width_p)
+{
+  MxListView *list_view = MX_LIST_VIEW (actor);
+  MxListViewPrivate *priv = list_view->priv;
+  MxPadding padding;
+
+  if (!mx_list_view_is_sectioned (list_view))
+    {
+      CLUTTER_ACTOR_CLASS (mx_list_view_parent_class)->
+        get_preferred_width (actor, for_height, min_width_p, natural_width_p);
+      return;
+    }
+
+  mx_widget_get_padding (MX_WIDGET (actor), &padding);
+
+  mx_list_view_ensure_sections (list_view);
+  if (!priv->sizes_valid)
+    mx_list_view_ensure_sizes (list_view, -1);
+
+  if (min_width_p)
+    *min_width_p = priv->min_width + padding.left + padding.right;
+  if (natural_width_p)
+    *natural_width_p = priv->natural_width + padding.left + padding.right;
+}
+
+static void
+mx_list_view_get_preferred_height (ClutterActor *actor,
+                                   gfloat        for_width,
+                                   gfloat       *min_height_p,
+                                   gfloat       *natural_height_p)
+{
+  MxListView *list_view = MX_LIST_VIEW (actor);
+  MxPadding padding;
+  gfloat spacing, height;
+
+  if (!mx_list_view_is_sectioned (list_view))
+    {
+      CLUTTER_ACTOR_CLASS (mx_list_view_parent_class)->
+        get_preferred_height (actor, for_width, min_height_p, natural_height_p);
+      return;
+    }
+
+  mx_widget_get_padding (MX_WIDGET (actor), &padding);
+  spacing = mx_box_layout_get_spacing (MX_BOX_LAYOUT (actor));
+
+  if (for_width >= 0)
+    for_width = MAX (0, for_width - padding.left - padding.right);
+
+  mx_list_view_ensure_sections (list_view);
+  mx_list_view_ensure_sizes (list_view, for_width);
+
+  height = mx_list_view_get_content_height (list_view, spacing) +
+           padding.top + padding.bottom;
+
+  if (min_height_p)
+    *min_height_p = height;
+  if (natural_height_p)
+    *natural_height_p = height;
+}
+
+static void
+mx_list_view_allocate (ClutterActor           *actor,
+                       const ClutterActorBox  *box,
+                       ClutterAllocationFlags  flags)
+{
+  MxListView *list_view = MX_LIST_VIEW (actor);
+  ClutterActorClass *widget_class;
+
+  if (!mx_list_view_is_sectioned (list_view))
+    {
+      CLUTTER_ACTOR_CLASS (mx_list_view_parent_class)->
+        allocate (actor, box, flags);
+      return;
+    }
+
+  /* Skip MxBoxLayout's allocation, it would lay out every child in turn */
+  widget_class = g_type_class_peek (MX_TYPE_WIDGET);
+  widget_class->allocate (actor, box, flags);
+
+  mx_list_view_sectioned_allocate (list_view, box, flags);
+}
+
 static void
 mx_list_view_class_init (MxListViewClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
   GParamSpec *pspec;
 
   g_type_class_add_private (klass, sizeof (MxListViewPrivate));
@@ -178,6 +1142,10 @@ mx_list_view_class_init (MxListViewClass *klass)
   object_class->dispose = mx_list_view_dispose;
   object_class->finalize = mx_list_view_finalize;
 
+  actor_class->get_preferred_width = mx_list_view_get_preferred_width;
+  actor_class->get_preferred_height = mx_list_view_get_preferred_height;
+  actor_class->allocate = mx_list_view_allocate;
+
   pspec = g_param_spec_object ("model",
                                "model",
                                "The model for the item view",
@@ -203,14 +1171,54 @@ mx_list_view_class_init (MxListViewClass *klass)
                                G_TYPE_OBJECT /*MX_TYPE_ITEM_FACTORY*/,
                                MX_PARAM_READWRITE);
   g_object_class_install_property (object_class, PROP_FACTORY, pspec);
+
+  /**
+   * MxListView:section-column:
+   *
+   * The model column used to group rows into sections, or -1 to disable
+   * sectioned mode.
+   *
+   * Since: 2.0
+   */
+  pspec = g_param_spec_int ("section-column",
+                            "Section column",
+                            "The model column used to group rows into "
+                            "sections, or -1",
+                            -1, G_MAXINT, -1,
+                            MX_PARAM_READWRITE);
+  g_object_class_install_property (object_class, PROP_SECTION_COLUMN, pspec);
+
+  /**
+   * MxListView:header-factory:
+   *
+   * The #MxItemFactory used for creating section headers. If this is not
+   * set, #MxLabel headers are created.
+   *
+   * Since: 2.0
+   */
+  pspec = g_param_spec_object ("header-factory",
+                               "Header factory",
+                               "The MxItemFactory used for creating "
+                               "section headers.",
+                               G_TYPE_OBJECT /*MX_TYPE_ITEM_FACTORY*/,
+                               MX_PARAM_READWRITE);
+  g_object_class_install_property (object_class, PROP_HEADER_FACTORY, pspec);
 }
 
 static void
 mx_list_view_init (MxListView *list_view)
 {
-  list_view->priv = LIST_VIEW_PRIVATE (list_view);
+  MxListViewPrivate *priv = list_view->priv = LIST_VIEW_PRIVATE (list_view);
 
   mx_box_layout_set_orientation (MX_BOX_LAYOUT (list_view), MX_ORIENTATION_VERTICAL);
+
+  priv->section_column = -1;
+  priv->sections = g_array_new (FALSE, FALSE, sizeof (MxListViewSection));
+  priv->range.first_section = -1;
+  priv->visible_items = g_hash_table_new (NULL, NULL);
+  priv->visible_headers = g_hash_table_new (NULL, NULL);
+  g_queue_init (&priv->item_pool);
+  g_queue_init (&priv->header_pool);
 }
 
 
@@ -245,6 +1253,12 @@ model_changed_cb (ClutterModel *model,
         }
     }
 
+  if (priv->section_column >= 0)
+    {
+      mx_list_view_invalidate_sections (list_view);
+      return;
+    }
+
   children = clutter_actor_get_children (CLUTTER_ACTOR (list_view));
   child_n = g_list_length (children);
 
@@ -320,11 +1334,39 @@ model_changed_cb (ClutterModel *model,
     g_object_unref (iter);
 }
 
+static void
+row_added_cb (ClutterModel     *model,
+              ClutterModelIter *iter,
+              MxListView       *list_view)
+{
+  MxListViewPrivate *priv = list_view->priv;
+
+  if (priv->section_column >= 0)
+    {
+      if (!priv->is_frozen)
+        mx_list_view_update_sections (list_view,
+                                      clutter_model_iter_get_row (iter), 1);
+      return;
+    }
+
+  model_changed_cb (model, list_view);
+}
+
 static void
 row_changed_cb (ClutterModel     *model,
                 ClutterModelIter *iter,
                 MxListView       *list_view)
 {
+  MxListViewPrivate *priv = list_view->priv;
+
+  if (priv->section_column >= 0)
+    {
+      if (!priv->is_frozen)
+        mx_list_view_update_sections (list_view,
+                                      clutter_model_iter_get_row (iter), 0);
+      return;
+    }
+
   model_changed_cb (model, list_view);
 }
 
@@ -340,6 +1382,13 @@ row_removed_cb (ClutterModel     *model,
   if (list_view->priv->is_frozen)
     return;
 
+  if (list_view->priv->section_column >= 0)
+    {
+      mx_list_view_update_sections (list_view,
+                                    clutter_model_iter_get_row (iter), -1);
+      return;
+    }
+
   children = clutter_actor_get_children (CLUTTER_ACTOR (list_view));
   l = g_list_nth (children, clutter_model_iter_get_row (iter));
   child = (ClutterActor *) l->data;
@@ -396,6 +1445,13 @@ mx_list_view_set_item_type (MxListView *list_view,
 
   list_view->priv->item_type = item_type;
 
+  /* Drop the pooled items of the previous type */
+  if (list_view->priv->section_column >= 0)
+    {
+      mx_list_view_reset_children (list_view);
+      clutter_actor_queue_relayout (CLUTTER_ACTOR (list_view));
+    }
+
   /* update the view */
   model_changed_cb (list_view->priv->model, list_view);
 }
@@ -439,6 +1495,9 @@ mx_list_view_set_model (MxListView   *list_view,
       g_signal_handlers_disconnect_by_func (priv->model,
                                             (GCallback) model_changed_cb,
                                             list_view);
+      g_signal_handlers_disconnect_by_func (priv->model,
+                                            (GCallback) row_added_cb,
+                                            list_view);
       g_signal_handlers_disconnect_by_func (priv->model,
                                             (GCallback) row_changed_cb,
                                             list_view);
@@ -448,6 +1507,13 @@ mx_list_view_set_model (MxListView   *list_view,
       g_object_unref (priv->model);
 
       priv->model = NULL;
+
+      /* A virtualised view can't outlive its model */
+      if (priv->section_column >= 0)
+        {
+          mx_list_view_reset_children (list_view);
+          clutter_actor_queue_relayout (CLUTTER_ACTOR (list_view));
+        }
     }
 
   if (model)
@@ -463,7 +1529,7 @@ mx_list_view_set_model (MxListView   *list_view,
 
       priv->row_added = g_signal_connect (priv->model,
                                           "row-added",
-                                          G_CALLBACK (row_changed_cb),
+                                          G_CALLBACK (row_added_cb),
                                           list_view);
 
       priv->row_changed = g_signal_connect (priv->model,
@@ -596,6 +1662,13 @@ mx_list_view_set_factory (MxListView    *list_view,
   if (factory)
     priv->factory = g_object_ref (factory);
 
+  /* Drop the items made by the previous factory */
+  if (priv->section_column >= 0)
+    {
+      mx_list_view_reset_children (list_view);
+      clutter_actor_queue_relayout (CLUTTER_ACTOR (list_view));
+    }
+
   g_object_notify (G_OBJECT (list_view), "factory");
 }
 
@@ -613,3 +1686,154 @@ mx_list_view_get_factory (MxListView *list_view)
   g_return_val_if_fail (MX_IS_LIST_VIEW (list_view), NULL);
   return list_view->priv->factory;
 }
+
+/**
+ * mx_list_view_set_section_column:
+ * @list_view: An #MxListView
+ * @column: A column in the model, or -1
+ *
+ * Groups consecutive rows that have the same value in @column into sections,
+ * each introduced by a header actor, and switches the view to a virtualised
+ * mode where actors are only created for the visible rows. Set @column to -1
+ * to return to creating an actor for every row.
+ *
+ * Since: 2.0
+ */
+void
+mx_list_view_set_section_column (MxListView *list_view,
+                                 gint        column)
+{
+  MxListViewPrivate *priv;
+
+  g_return_if_fail (MX_IS_LIST_VIEW (list_view));
+  g_return_if_fail (column >= -1);
+
+  priv = list_view->priv;
+
+  if (priv->section_column == column)
+    return;
+
+  mx_list_view_reset_children (list_view);
+  priv->section_column = column;
+
+  if (column < 0)
+    model_changed_cb (priv->model, list_view);
+  else
+    clutter_actor_queue_relayout (CLUTTER_ACTOR (list_view));
+
+  g_object_notify (G_OBJECT (list_view), "section-column");
+}
+
+/**
+ * mx_list_view_get_section_column:
+ * @list_view: An #MxListView
+ *
+ * Gets the model column used to group rows into sections.
+ *
+ * Returns: the section column, or -1 if sections are disabled
+ *
+ * Since: 2.0
+ */
+gint
+mx_list_view_get_section_column (MxListView *list_view)
+{
+  g_return_val_if_fail (MX_IS_LIST_VIEW (list_view), -1);
+
+  return list_view->priv->section_column;
+}
+
+/**
+ * mx_list_view_set_header_factory:
+ * @list_view: An #MxListView
+ * @factory: (allow-none): A #MxItemFactory
+ *
+ * Sets @factory to be the factory used for creating section headers. If no
+ * factory is set, an #MxLabel showing the value of the section column is
+ * used.
+ *
+ * Since: 2.0
+ */
+void
+mx_list_view_set_header_factory (MxListView    *list_view,
+                                 MxItemFactory *factory)
+{
+  MxListViewPrivate *priv;
+
+  g_return_if_fail (MX_IS_LIST_VIEW (list_view));
+  g_return_if_fail (!factory || MX_IS_ITEM_FACTORY (factory));
+
+  priv = list_view->priv;
+
+  if (priv->header_factory == factory)
+    return;
+
+  if (priv->header_factory)
+    {
+      g_object_unref (priv->header_factory);
+      priv->header_factory = NULL;
+    }
+
+  if (factory)
+    priv->header_factory = g_object_ref (factory);
+
+  /* Drop the headers made by the previous factory */
+  if (priv->section_column >= 0)
+    {
+      mx_list_view_reset_children (list_view);
+      clutter_actor_queue_relayout (CLUTTER_ACTOR (list_view));
+    }
+
+  g_object_notify (G_OBJECT (list_view), "header-factory");
+}
+
+/**
+ * mx_list_view_get_header_factory:
+ * @list_view: An #MxListView
+ *
+ * Gets the #MxItemFactory used for creating section headers.
+ *
+ * Returns: (transfer none): A #MxItemFactory.
+ *
+ * Since: 2.0
+ */
+MxItemFactory *
+mx_list_view_get_header_factory (MxListView *list_view)
+{
+  g_return_val_if_fail (MX_IS_LIST_VIEW (list_view), NULL);
+  return list_view->priv->header_factory;
+}
+
+/**
+ * mx_list_view_add_header_attribute:
+ * @list_view: An #MxListView
+ * @attribute: Name of the attribute
+ * @column: Column number
+ *
+ * Adds an attribute mapping between the current model and the section
+ * headers. Header attributes are read from the first row of each section.
+ *
+ * Since: 2.0
+ */
+void
+mx_list_view_add_header_attribute (MxListView  *list_view,
+                                   const gchar *attribute,
+                                   gint         column)
+{
+  MxListViewPrivate *priv;
+  AttributeData *prop;
+
+  g_return_if_fail (MX_IS_LIST_VIEW (list_view));
+  g_return_if_fail (attribute != NULL);
+  g_return_if_fail (column >= 0);
+
+  priv = list_view->priv;
+
+  prop = g_new (AttributeData, 1);
+  prop->name = g_strdup (attribute);
+  prop->col = column;
+
+  priv->header_attributes = g_slist_prepend (priv->header_attributes, prop);
+
+  if (priv->section_column >= 0)
+    mx_list_view_invalidate_sections (list_view);
+}
@@ -105,6 +105,16 @@ void          mx_list_view_set_factory   (MxListView    *list_view,
                                           MxItemFactory *factory);
 MxItemFactory *mx_list_view_get_factory  (MxListView    *list_view);
 
+void          mx_list_view_set_section_column   (MxListView    *list_view,
+                                                 gint           column);
+gint          mx_list_view_get_section_column   (MxListView    *list_view);
+void          mx_list_view_set_header_factory   (MxListView    *list_view,
+                                                 MxItemFactory *factory);
+MxItemFactory *mx_list_view_get_header_factory  (MxListView    *list_view);
+void          mx_list_view_add_header_attribute (MxListView    *list_view,
+                                                 const gchar   *attribute,
+                                                 gint           column);
+
 G_END_DECLS
 
 #endif /* _MX_LIST_VIEW_H */
@@ -0,0 +1,137 @@
+/*
+ * mx-paint-cache-effect.c: Effect that retains the painting of an actor
+ *
+ * Copyright 2012 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/*
+ * This class is private to MX
+ *
+ * The actor is rendered into an offscreen texture, which is painted again
+ * on the following frames for as long as nothing in the actor's subtree
+ * queues a redraw; ClutterOffscreenEffect only re-renders the actor when it
+ * has been marked dirty or its transformation has changed.
+ *
+ * All the caches share a texture memory budget. When creating a texture
+ * would exceed it, the effect gives up and the actor is painted directly
+ * until its size changes again.
+ */
+
+#include "mx-paint-cache-effect.h"
+#include "mx-private.h"
+
+G_DEFINE_TYPE (MxPaintCacheEffect, _mx_paint_cache_effect,
+               CLUTTER_TYPE_OFFSCREEN_EFFECT)
+
+static gsize mx_paint_cache_total_size = 0;
+
+static void
+mx_paint_cache_effect_release (MxPaintCacheEffect *self)
+{
+  mx_paint_cache_total_size -= self->size;
+  self->size = 0;
+}
+
+static CoglHandle
+mx_paint_cache_effect_create_texture (ClutterOffscreenEffect *effect,
+                                      gfloat                  width,
+                                      gfloat                  height)
+{
+  MxPaintCacheEffect *self = MX_PAINT_CACHE_EFFECT (effect);
+  CoglHandle texture;
+  gsize size;
+
+  /* the previous texture, if any, is being replaced */
+  mx_paint_cache_effect_release (self);
+
+  size = (gsize) width * (gsize) height * 4;
+
+  /* this size has already been refused, don't try again on every frame */
+  if (size == self->refused_size)
+    return COGL_INVALID_HANDLE;
+
+  if (mx_paint_cache_total_size + size > MX_PAINT_CACHE_BUDGET)
+    {
+      MX_NOTE (PAINT_CACHE, "Budget exceeded, not caching %s (%p)",
+               G_OBJECT_TYPE_NAME (clutter_actor_meta_get_actor (
+                                     CLUTTER_ACTOR_META (effect))),
+               clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect)));
+      self->refused_size = size;
+      return COGL_INVALID_HANDLE;
+    }
+
+  self->refused_size = 0;
+
+  texture = CLUTTER_OFFSCREEN_EFFECT_CLASS (_mx_paint_cache_effect_parent_class)->
+    create_texture (effect, width, height);
+
+  if (texture != COGL_INVALID_HANDLE)
+    {
+      self->size = size;
+      mx_paint_cache_total_size += size;
+    }
+
+  return texture;
+}
+
+static void
+mx_paint_cache_effect_set_actor (ClutterActorMeta *meta,
+                                 ClutterActor     *actor)
+{
+  MxPaintCacheEffect *self = MX_PAINT_CACHE_EFFECT (meta);
+
+  /* the offscreen buffer is dropped when the actor changes */
+  mx_paint_cache_effect_release (self);
+  self->refused_size = 0;
+
+  CLUTTER_ACTOR_META_CLASS (_mx_paint_cache_effect_parent_class)->
+    set_actor (meta, actor);
+}
+
+static void
+mx_paint_cache_effect_dispose (GObject *object)
+{
+  mx_paint_cache_effect_release (MX_PAINT_CACHE_EFFECT (object));
+
+  G_OBJECT_CLASS (_mx_paint_cache_effect_parent_class)->dispose (object);
+}
+
+static void
+_mx_paint_cache_effect_class_init (MxPaintCacheEffectClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  ClutterActorMetaClass *meta_class = CLUTTER_ACTOR_META_CLASS (klass);
+  ClutterOffscreenEffectClass *offscreen_class =
+    CLUTTER_OFFSCREEN_EFFECT_CLASS (klass);
+
+  object_class->dispose = mx_paint_cache_effect_dispose;
+
+  meta_class->set_actor = mx_paint_cache_effect_set_actor;
+
+  offscreen_class->create_texture = mx_paint_cache_effect_create_texture;
+}
+
+static void
+_mx_paint_cache_effect_init (MxPaintCacheEffect *self)
+{
+}
+
+ClutterEffect *
+_mx_paint_cache_effect_new (void)
+{
+  return g_object_new (MX_TYPE_PAINT_CACHE_EFFECT, NULL);
+}
@@ -0,0 +1,79 @@
+/*
+ * mx-paint-cache-effect.h: Effect that retains the painting of an actor
+ *
+ * Copyright 2012 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/*
+ * This class is private to MX
+ */
+
+#include <glib-object.h>
+#include <clutter/clutter.h>
+
+G_BEGIN_DECLS
+
+#ifndef _MX_PAINT_CACHE_EFFECT_H
+#define _MX_PAINT_CACHE_EFFECT_H
+
+#define MX_TYPE_PAINT_CACHE_EFFECT _mx_paint_cache_effect_get_type()
+
+#define MX_PAINT_CACHE_EFFECT(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST ((obj), \
+                               MX_TYPE_PAINT_CACHE_EFFECT, MxPaintCacheEffect))
+
+#define MX_PAINT_CACHE_EFFECT_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST ((klass), \
+                            MX_TYPE_PAINT_CACHE_EFFECT, MxPaintCacheEffectClass))
+
+#define MX_IS_PAINT_CACHE_EFFECT(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE ((obj), \
+                               MX_TYPE_PAINT_CACHE_EFFECT))
+
+#define MX_IS_PAINT_CACHE_EFFECT_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE ((klass), \
+                            MX_TYPE_PAINT_CACHE_EFFECT))
+
+#define MX_PAINT_CACHE_EFFECT_GET_CLASS(obj) \
+  (G_TYPE_INSTANCE_GET_CLASS ((obj), \
+                              MX_TYPE_PAINT_CACHE_EFFECT, MxPaintCacheEffectClass))
+
+/* The maximum amount of texture memory used by all paint caches together */
+#define MX_PAINT_CACHE_BUDGET (32 * 1024 * 1024)
+
+typedef struct
+{
+  ClutterOffscreenEffect parent;
+
+  gsize                  size;
+
+  /* size of the last texture refused for being over budget */
+  gsize                  refused_size;
+} MxPaintCacheEffect;
+
+typedef struct
+{
+  ClutterOffscreenEffectClass parent_class;
+} MxPaintCacheEffectClass;
+
+GType           _mx_paint_cache_effect_get_type (void) G_GNUC_CONST;
+
+ClutterEffect * _mx_paint_cache_effect_new      (void);
+
+G_END_DECLS
+
+#endif /* _MX_PAINT_CACHE_EFFECT_H */
@@ -0,0 +1,313 @@
+/*
+ * mx-piece-table.c: Text buffer for editing large amounts of text
+ *
+ * Copyright 2012 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/*
+ * This is private to MX
+ *
+ * The text is described by a list of pieces, each of them a range of either
+ * the original text, which is never modified, or of a buffer that inserted
+ * text is only ever appended to. Edits split and remove pieces rather than
+ * moving the text around, so their cost depends on the number of edits
+ * rather than on the size of the text.
+ *
+ * All the offsets are in bytes.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "mx-piece-table.h"
+
+typedef struct
+{
+  gboolean added;
+  gsize    start;
+  gsize    length;
+} MxPiece;
+
+struct _MxPieceTable
+{
+  gchar   *original;
+  GString *added;
+
+  GArray  *pieces;
+  gsize    length;
+};
+
+static const gchar *
+mx_piece_table_get_data (MxPieceTable *table,
+                         MxPiece      *piece)
+{
+  return (piece->added ? table->added->str : table->original) + piece->start;
+}
+
+/* Makes sure a piece starts at @offset and returns its index, which is the
+ * number of pieces when @offset is the end of the text */
+static guint
+mx_piece_table_split (MxPieceTable *table,
+                      gsize         offset)
+{
+  guint i;
+
+  for (i = 0; i < table->pieces->len; i++)
+    {
+      MxPiece *piece = &g_array_index (table->pieces, MxPiece, i);
+      MxPiece tail;
+
+      if (offset == 0)
+        return i;
+
+      if (offset < piece->length)
+        {
+          tail = *piece;
+          tail.start += offset;
+          tail.length -= offset;
+          piece->length = offset;
+
+          g_array_insert_val (table->pieces, i + 1, tail);
+
+          return i + 1;
+        }
+
+      offset -= piece->length;
+    }
+
+  return table->pieces->len;
+}
+
+MxPieceTable *
+_mx_piece_table_new (const gchar *text,
+                     gssize       length)
+{
+  MxPieceTable *table;
+  MxPiece piece;
+
+  if (length < 0)
+    length = text ? strlen (text) : 0;
+
+  table = g_slice_new0 (MxPieceTable);
+
+  table->original = g_strndup (text, length);
+  table->added = g_string_new (NULL);
+  table->pieces = g_array_new (FALSE, FALSE, sizeof (MxPiece));
+  table->length = length;
+
+  if (length)
+    {
+      piece.added = FALSE;
+      piece.start = 0;
+      piece.length = length;
+
+      g_array_append_val (table->pieces, piece);
+    }
+
+  return table;
+}
+
+void
+_mx_piece_table_free (MxPieceTable *table)
+{
+  g_free (table->original);
+  g_string_free (table->added, TRUE);
+  g_array_free (table->pieces, TRUE);
+
+  g_slice_free (MxPieceTable, table);
+}
+
+gsize
+_mx_piece_table_get_length (MxPieceTable *table)
+{
+  return table->length;
+}
+
+/* The number of pieces the text is split into, for the tests */
+guint
+_mx_piece_table_get_n_pieces (MxPieceTable *table)
+{
+  return table->pieces->len;
+}
+
+void
+_mx_piece_table_insert (MxPieceTable *table,
+                        gsize         offset,
+                        const gchar  *text,
+                        gssize        length)
+{
+  MxPiece piece;
+  guint index;
+
+  if (length < 0)
+    length = strlen (text);
+
+  if (length == 0)
+    return;
+
+  offset = MIN (offset, table->length);
+  index = mx_piece_table_split (table, offset);
+
+  piece.added = TRUE;
+  piece.start = table->added->len;
+  piece.length = length;
+
+  g_string_append_len (table->added, text, length);
+  table->length += length;
+
+  /* typing appends to the piece that was inserted last */
+  if (index > 0)
+    {
+      MxPiece *previous = &g_array_index (table->pieces, MxPiece, index - 1);
+
+      if (previous->added && previous->start + previous->length == piece.start)
+        {
+          previous->length += length;
+          return;
+        }
+    }
+
+  g_array_insert_val (table->pieces, index, piece);
+}
+
+void
+_mx_piece_table_delete (MxPieceTable *table,
+                        gsize         offset,
+                        gsize         length)
+{
+  guint first, last;
+
+  offset = MIN (offset, table->length);
+  length = MIN (length, table->length - offset);
+
+  if (length == 0)
+    return;
+
+  first = mx_piece_table_split (table, offset);
+  last = mx_piece_table_split (table, offset + length);
+
+  g_array_remove_range (table->pieces, first, last - first);
+  table->length -= length;
+}
+
+/* Appends the text between @start and @end to @string */
+void
+_mx_piece_table_get_text (MxPieceTable *table,
+                          gsize         start,
+                          gsize         end,
+                          GString      *string)
+{
+  gsize piece_start = 0;
+  guint i;
+
+  end = MIN (end, table->length);
+
+  for (i = 0; i < table->pieces->len && piece_start < end; i++)
+    {
+      MxPiece *piece = &g_array_index (table->pieces, MxPiece, i);
+      gsize piece_end = piece_start + piece->length;
+
+      if (piece_end > start)
+        {
+          gsize from = MAX (start, piece_start) - piece_start;
+          gsize to = MIN (end, piece_end) - piece_start;
+
+          g_string_append_len (string,
+                               mx_piece_table_get_data (table, piece) + from,
+                               to - from);
+        }
+
+      piece_start = piece_end;
+    }
+}
+
+/* Moves @offset back to the start of the UTF-8 character it points into */
+gsize
+_mx_piece_table_align (MxPieceTable *table,
+                       gsize         offset)
+{
+  gsize piece_start = 0;
+  guint i;
+
+  if (offset >= table->length)
+    return table->length;
+
+  for (i = 0; i < table->pieces->len; i++)
+    {
+      MxPiece *piece = &g_array_index (table->pieces, MxPiece, i);
+      const gchar *data;
+
+      if (offset >= piece_start + piece->length)
+        {
+          piece_start += piece->length;
+          continue;
+        }
+
+      /* pieces only ever start on character boundaries */
+      data = mx_piece_table_get_data (table, piece);
+      while (offset > piece_start &&
+             (data[offset - piece_start] & 0xc0) == 0x80)
+        offset--;
+
+      break;
+    }
+
+  return offset;
+}
+
+/* Returns the offset of the character @n_chars characters after the one at
+ * @offset, or the length of the text if there aren't as many */
+gsize
+_mx_piece_table_skip_chars (MxPieceTable *table,
+                            gsize         offset,
+                            gsize         n_chars)
+{
+  gsize piece_start = 0;
+  guint i;
+
+  for (i = 0; i < table->pieces->len; i++)
+    {
+      MxPiece *piece = &g_array_index (table->pieces, MxPiece, i);
+      const gchar *data;
+
+      if (offset >= piece_start + piece->length)
+        {
+          piece_start += piece->length;
+          continue;
+        }
+
+      /* count the bytes that start characters */
+      data = mx_piece_table_get_data (table, piece);
+      for (; offset < piece_start + piece->length; offset++)
+        {
+          if ((data[offset - piece_start] & 0xc0) == 0x80)
+            continue;
+
+          if (n_chars == 0)
+            return offset;
+
+          n_chars--;
+        }
+
+      piece_start += piece->length;
+    }
+
+  return table->length;
+}
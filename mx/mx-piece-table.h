@@ -0,0 +1,62 @@
+/*
+ * mx-piece-table.h: Text buffer for editing large amounts of text
+ *
+ * Copyright 2012 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/*
+ * This is private to MX
+ */
+
+#ifndef _MX_PIECE_TABLE_H
+#define _MX_PIECE_TABLE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _MxPieceTable MxPieceTable;
+
+MxPieceTable *_mx_piece_table_new        (const gchar  *text,
+                                          gssize        length);
+void          _mx_piece_table_free       (MxPieceTable *table);
+
+gsize         _mx_piece_table_get_length (MxPieceTable *table);
+
+void          _mx_piece_table_insert     (MxPieceTable *table,
+                                          gsize         offset,
+                                          const gchar  *text,
+                                          gssize        length);
+void          _mx_piece_table_delete     (MxPieceTable *table,
+                                          gsize         offset,
+                                          gsize         length);
+
+void          _mx_piece_table_get_text   (MxPieceTable *table,
+                                          gsize         start,
+                                          gsize         end,
+                                          GString      *string);
+gsize         _mx_piece_table_align      (MxPieceTable *table,
+                                          gsize         offset);
+gsize         _mx_piece_table_skip_chars (MxPieceTable *table,
+                                          gsize         offset,
+                                          gsize         n_chars);
+
+guint         _mx_piece_table_get_n_pieces (MxPieceTable *table);
+
+G_END_DECLS
+
+#endif /* _MX_PIECE_TABLE_H */
@@ -28,7 +28,11 @@ static GDebugKey debug_keys[] =
     {"layout", MX_DEBUG_LAYOUT},
     {"inspector", MX_DEBUG_INSPECTOR},
     {"focus", MX_DEBUG_FOCUS},
-    {"css", MX_DEBUG_CSS}
+    {"css", MX_DEBUG_CSS},
+    {"style-cache", MX_DEBUG_STYLE_CACHE},
+    {"style-gets", MX_DEBUG_STYLE_GETS},
+    {"scroll", MX_DEBUG_SCROLL},
+    {"paint-cache", MX_DEBUG_PAINT_CACHE}
 };
 
 
@@ -51,6 +55,162 @@ _mx_debug (gint check)
   return debug & check;
 }
 
+/* The debug counters are kept per frame. Frames are bracketed by repaint
+ * functions, which are installed the first time a counter needs them.
+ */
+static gboolean  mx_debug_frame_in_progress = FALSE;
+static GHookList mx_debug_frame_end_hooks = { 0, };
+
+static gboolean
+mx_debug_frame_start_cb (gpointer data)
+{
+  mx_debug_frame_in_progress = TRUE;
+
+  return TRUE;
+}
+
+static gboolean
+mx_debug_frame_end_cb (gpointer data)
+{
+  mx_debug_frame_in_progress = FALSE;
+
+  g_hook_list_invoke (&mx_debug_frame_end_hooks, FALSE);
+
+  return TRUE;
+}
+
+static void
+mx_debug_frame_ensure_funcs (void)
+{
+  if (G_LIKELY (mx_debug_frame_end_hooks.is_setup))
+    return;
+
+  g_hook_list_init (&mx_debug_frame_end_hooks, sizeof (GHook));
+
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_PRE_PAINT,
+                                         mx_debug_frame_start_cb,
+                                         NULL, NULL);
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         mx_debug_frame_end_cb,
+                                         NULL, NULL);
+}
+
+/* Whether Clutter is laying out and painting a frame */
+gboolean
+_mx_debug_in_frame (void)
+{
+  mx_debug_frame_ensure_funcs ();
+
+  return mx_debug_frame_in_progress;
+}
+
+/* Calls @func with @data once each frame has been painted */
+void
+_mx_debug_add_frame_end_func (GHookFunc func,
+                              gpointer  data)
+{
+  GHook *hook;
+
+  mx_debug_frame_ensure_funcs ();
+
+  hook = g_hook_alloc (&mx_debug_frame_end_hooks);
+  hook->func = func;
+  hook->data = data;
+  g_hook_append (&mx_debug_frame_end_hooks, hook);
+}
+
+/* Counters for MX_DEBUG=scroll. Scrolling only changes the transform of a
+ * scrollable container, so while a frame in which its scroll offset changed
+ * is laid out and painted, nothing in the parent of the container, i.e. the
+ * scroll view and its scroll bars, should be measured or allocated. The
+ * relayouts are counted for each scrolled container.
+ */
+static GHashTable *scroll_stats_actors = NULL;
+static guint scroll_stats_frames = 0;
+static guint scroll_stats_total_relayouts = 0;
+
+static void
+scroll_stats_actor_weak_notify (gpointer  data,
+                                GObject  *where_the_object_was)
+{
+  g_hash_table_remove (scroll_stats_actors, where_the_object_was);
+}
+
+static void
+scroll_stats_frame_end_cb (gpointer data)
+{
+  GHashTableIter iter;
+  gpointer actor, relayouts;
+
+  if (!g_hash_table_size (scroll_stats_actors))
+    return;
+
+  scroll_stats_frames++;
+
+  g_hash_table_iter_init (&iter, scroll_stats_actors);
+  while (g_hash_table_iter_next (&iter, &actor, &relayouts))
+    {
+      scroll_stats_total_relayouts += GPOINTER_TO_UINT (relayouts);
+
+      MX_NOTE (SCROLL, "scroll frame %u: %s (%p) %u relayouts, %u in %u frames",
+               scroll_stats_frames, G_OBJECT_TYPE_NAME (actor), actor,
+               GPOINTER_TO_UINT (relayouts), scroll_stats_total_relayouts,
+               scroll_stats_frames);
+
+      g_object_weak_unref (actor, scroll_stats_actor_weak_notify, NULL);
+      g_hash_table_iter_remove (&iter);
+    }
+}
+
+void
+_mx_scroll_stats_scrolled (ClutterActor *actor)
+{
+  if (G_LIKELY (!_mx_debug (MX_DEBUG_SCROLL)))
+    return;
+
+  if (G_UNLIKELY (!scroll_stats_actors))
+    {
+      scroll_stats_actors = g_hash_table_new (NULL, NULL);
+      _mx_debug_add_frame_end_func (scroll_stats_frame_end_cb, NULL);
+    }
+
+  if (g_hash_table_lookup_extended (scroll_stats_actors, actor, NULL, NULL))
+    return;
+
+  g_hash_table_insert (scroll_stats_actors, actor, GUINT_TO_POINTER (0));
+  g_object_weak_ref (G_OBJECT (actor), scroll_stats_actor_weak_notify, NULL);
+}
+
+void
+_mx_scroll_stats_relayout (ClutterActor *actor)
+{
+  GHashTableIter iter;
+  gpointer scrolled, relayouts;
+
+  if (G_LIKELY (!_mx_debug (MX_DEBUG_SCROLL)) ||
+      !scroll_stats_actors ||
+      !g_hash_table_size (scroll_stats_actors) ||
+      !_mx_debug_in_frame ())
+    return;
+
+  g_hash_table_iter_init (&iter, scroll_stats_actors);
+  while (g_hash_table_iter_next (&iter, &scrolled, &relayouts))
+    {
+      ClutterActor *parent = clutter_actor_get_parent (scrolled);
+
+      if (!clutter_actor_contains (parent ? parent : scrolled, actor))
+        continue;
+
+      g_hash_table_iter_replace (&iter,
+                                 GUINT_TO_POINTER (GPOINTER_TO_UINT (relayouts)
+                                                   + 1));
+
+      MX_NOTE (SCROLL, "%s (%p) measured or allocated while %s (%p) scrolled",
+               G_OBJECT_TYPE_NAME (actor), actor,
+               G_OBJECT_TYPE_NAME (scrolled), scrolled);
+    }
+}
+
 const gchar *
 _mx_enum_to_string (GType type,
                     gint  value)
@@ -101,24 +261,9 @@ _mx_paint_texture_with_opacity (CoglHandle texture,
                                 gfloat     width,
                                 gfloat     height)
 {
-  CoglHandle material;
-  static CoglHandle template_material;
-
-  /* setup the template material */
-  if (!template_material)
-    template_material = cogl_material_new ();
-
-  /* create the material and apply opacity */
-  material = cogl_material_copy (template_material);
-  cogl_material_set_color4ub (material, opacity, opacity, opacity, opacity);
-
-  /* add the texture */
-  cogl_material_set_layer (material, 0, texture);
-
-  /* set the source */
-  cogl_set_source (material);
+  /* use the shared per-texture material, so paints of the same texture
+   * can be batched */
+  cogl_set_source (_mx_texture_frame_get_material (texture, opacity));
 
   cogl_rectangle (x, y, x + width, y + height);
-
-  cogl_handle_unref (material);
 }
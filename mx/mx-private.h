@@ -58,6 +58,28 @@ struct _MxTableChild
   guint y_expand : 1;
   guint x_fill : 1;
   guint y_fill : 1;
+
+  /* cached size requests and the cells they were last counted in, used by
+   * MxTable to only re-solve the rows and columns that changed */
+  guint width_valid : 1;
+  guint height_valid : 1;
+  guint col_cache_valid : 1;
+  guint row_cache_valid : 1;
+  guint cached_x_expand : 1;
+  guint cached_y_expand : 1;
+  guint cached_col_visible : 1;
+  guint cached_row_visible : 1;
+
+  gint cached_col;
+  gint cached_col_span;
+  gint cached_row;
+  gint cached_row_span;
+
+  gfloat min_width;
+  gfloat pref_width;
+  gfloat height_for_width;
+  gfloat min_height;
+  gfloat pref_height;
 };
 
 typedef enum
@@ -75,10 +97,24 @@ ClutterActor *_mx_widget_get_dnd_clone (MxWidget *widget);
 
 void _mx_box_layout_start_animation (MxBoxLayout *box);
 
+/* used by MxFocusManager to record the focused child of a container */
+void _mx_box_layout_set_last_focus (MxBoxLayout *box,
+                                    MxFocusable *focusable);
+void _mx_grid_set_last_focus       (MxGrid      *grid,
+                                    MxFocusable *focusable);
+void _mx_table_set_last_focus      (MxTable     *table,
+                                    MxFocusable *focusable);
+
 /* used by MxTableChild to update row/column count */
 void _mx_table_update_row_col (MxTable      *table,
                                MxTableChild *meta);
 
+void _mx_label_measure_children (ClutterActor *container);
+
+CoglHandle _mx_icon_theme_lookup_cached (MxIconTheme *theme,
+                                         const gchar *icon_name,
+                                         gint         size);
+
 CoglHandle _mx_window_get_icon_cogl_texture (MxWindow *window);
 
 ClutterActor * _mx_window_get_resize_grip (MxWindow *window);
@@ -108,6 +144,10 @@ void _mx_paint_texture_with_opacity (CoglHandle texture,
 
 gboolean _mx_settings_get_touch_mode (MxSettings *settings);
 
+CoglHandle _mx_texture_frame_get_material (CoglHandle texture,
+                                           guint8     opacity);
+void       _mx_texture_frame_release_material (CoglHandle texture);
+
 
 typedef enum
 {
@@ -115,11 +155,21 @@ typedef enum
   MX_DEBUG_INSPECTOR   = 1 << 1,
   MX_DEBUG_FOCUS       = 1 << 2,
   MX_DEBUG_CSS         = 1 << 3,
-  MX_DEBUG_STYLE_CACHE = 1 << 4
+  MX_DEBUG_STYLE_CACHE = 1 << 4,
+  MX_DEBUG_STYLE_GETS  = 1 << 5,
+  MX_DEBUG_SCROLL      = 1 << 6,
+  MX_DEBUG_PAINT_CACHE = 1 << 7
 } MxDebugTopic;
 
 gboolean _mx_debug (gint debug);
 
+gboolean _mx_debug_in_frame           (void);
+void     _mx_debug_add_frame_end_func (GHookFunc  func,
+                                       gpointer   data);
+
+void _mx_scroll_stats_scrolled (ClutterActor *actor);
+void _mx_scroll_stats_relayout (ClutterActor *actor);
+
 #ifdef G_HAVE_ISO_VARARGS
 
 #define MX_NOTE(topic,...)                         G_STMT_START { \
@@ -73,6 +73,15 @@ struct _MxScrollBarPrivate
   gfloat        move_y;
 
   guint         handle_min_size;
+  guint         handle_max_size;
+
+  /* The adjustment the handle was last allocated for, where it was
+   * allocated and how far it has moved since with the value */
+  gdouble       handle_lower;
+  gdouble       handle_upper;
+  gdouble       handle_page_size;
+  gfloat        handle_position;
+  gfloat        handle_offset;
 
   /* Trough-click handling. */
   enum { NONE, UP, DOWN }  paging_direction;
@@ -301,6 +310,93 @@ mx_scroll_bar_get_preferred_height (ClutterActor *actor,
 
 }
 
+/* Works out the box of the handle for @value, within the current
+ * allocation of the scroll bar and the steppers */
+static void
+mx_scroll_bar_get_handle_box (MxScrollBar     *bar,
+                              gdouble          value,
+                              ClutterActorBox *handle_box)
+{
+  MxScrollBarPrivate *priv = bar->priv;
+  gfloat handle_size, position, avail_size, handle_pos;
+  gfloat x, y, width, height, stepper_size;
+  gdouble lower, upper, page_size, increment;
+  ClutterActorBox box, bw_box, fw_box;
+  guint min_size, max_size;
+  MxPadding padding;
+
+  clutter_actor_get_allocation_box (CLUTTER_ACTOR (bar), &box);
+  clutter_actor_get_allocation_box (priv->bw_stepper, &bw_box);
+  clutter_actor_get_allocation_box (priv->fw_stepper, &fw_box);
+  mx_widget_get_padding (MX_WIDGET (bar), &padding);
+
+  x = padding.left;
+  y = padding.top;
+  width = (box.x2 - box.x1) - padding.left - padding.right;
+  height = (box.y2 - box.y1) - padding.top - padding.bottom;
+
+  mx_adjustment_get_values (priv->adjustment,
+                            NULL,
+                            &lower,
+                            &upper,
+                            NULL,
+                            NULL,
+                            &page_size);
+
+  if ((upper == lower)
+      || (page_size >= (upper - lower)))
+    increment = 1.0;
+  else
+    increment = page_size / (upper - lower);
+
+  min_size = priv->handle_min_size;
+  max_size = priv->handle_max_size;
+
+  if (upper - lower - page_size <= 0)
+    position = 0;
+  else
+    position = (value - lower) / (upper - lower - page_size);
+
+  if (priv->orientation == MX_ORIENTATION_VERTICAL)
+    {
+      stepper_size = width;
+      avail_size = height - stepper_size * 2;
+      handle_size = increment * avail_size;
+      handle_size = CLAMP (handle_size, min_size, max_size);
+
+      handle_box->x1 = x;
+      handle_pos = bw_box.y2 + position * (avail_size - handle_size);
+      handle_box->y1 = CLAMP (handle_pos,
+                              bw_box.y2, fw_box.y1 - min_size);
+
+      handle_box->x2 = handle_box->x1 + width;
+      handle_box->y2 = CLAMP (handle_pos + handle_size,
+                              bw_box.y2 + min_size, fw_box.y1);
+    }
+  else
+    {
+      stepper_size = height;
+      avail_size = width - stepper_size * 2;
+      handle_size = increment * avail_size;
+      handle_size = CLAMP (handle_size, min_size, max_size);
+
+      handle_pos = bw_box.x2 + position * (avail_size - handle_size);
+      handle_box->x1 = CLAMP (handle_pos,
+                              bw_box.x2, fw_box.x1 - min_size);
+      handle_box->y1 = y;
+
+      handle_box->x2 = CLAMP (handle_pos + handle_size,
+                              bw_box.x2 + min_size, fw_box.x1);
+      handle_box->y2 = handle_box->y1 + height;
+    }
+
+  /* snap to pixel */
+  handle_box->x1 = (int) handle_box->x1;
+  handle_box->y1 = (int) handle_box->y1;
+  handle_box->x2 = (int) handle_box->x2;
+  handle_box->y2 = (int) handle_box->y2;
+}
+
 static void
 mx_scroll_bar_allocate (ClutterActor          *actor,
                         const ClutterActorBox *box,
@@ -311,6 +407,8 @@ mx_scroll_bar_allocate (ClutterActor          *actor,
   ClutterActorBox bw_box, fw_box, trough_box;
   gfloat x, y, width, height, stepper_size;
 
+  _mx_scroll_stats_relayout (actor);
+
   /* Chain up */
   CLUTTER_ACTOR_CLASS (mx_scroll_bar_parent_class)->allocate (actor, box,
                                                               flags);
@@ -375,81 +473,32 @@ mx_scroll_bar_allocate (ClutterActor          *actor,
       clutter_actor_allocate (priv->trough, &trough_box, flags);
     }
 
-
   if (priv->adjustment)
     {
-      gfloat handle_size, position, avail_size, handle_pos;
-      gdouble value, lower, upper, page_size, increment;
-      ClutterActorBox handle_box = { 0, };
-      guint min_size, max_size;
+      ClutterActorBox handle_box;
+      gdouble value;
 
       mx_adjustment_get_values (priv->adjustment,
                                 &value,
-                                &lower,
-                                &upper,
+                                &priv->handle_lower,
+                                &priv->handle_upper,
                                 NULL,
                                 NULL,
-                                &page_size);
-
-      value = mx_adjustment_get_value (priv->adjustment);
-
-      if ((upper == lower)
-          || (page_size >= (upper - lower)))
-        increment = 1.0;
-      else
-        increment = page_size / (upper - lower);
-
-      min_size = priv->handle_min_size;
+                                &priv->handle_page_size);
 
-      mx_stylable_get (MX_STYLABLE (actor),
-                       "mx-max-size", &max_size,
-                       NULL);
-
-      if (upper - lower - page_size <= 0)
-        position = 0;
-      else
-        position = (value - lower) / (upper - lower - page_size);
+      mx_scroll_bar_get_handle_box (MX_SCROLL_BAR (actor), value, &handle_box);
+      clutter_actor_allocate (priv->handle, &handle_box, flags);
 
       if (priv->orientation == MX_ORIENTATION_VERTICAL)
-        {
-          avail_size = height - stepper_size * 2;
-          handle_size = increment * avail_size;
-          handle_size = CLAMP (handle_size, min_size, max_size);
-
-          handle_box.x1 = x;
-          handle_pos = bw_box.y2 + position * (avail_size - handle_size);
-          handle_box.y1 = CLAMP (handle_pos,
-                                 bw_box.y2, fw_box.y1 - min_size);
-
-          handle_box.x2 = handle_box.x1 + width;
-          handle_box.y2 = CLAMP (handle_pos + handle_size,
-                                 bw_box.y2 + min_size, fw_box.y1);
-        }
+        priv->handle_position = handle_box.y1;
       else
+        priv->handle_position = handle_box.x1;
+
+      if (priv->handle_offset != 0)
         {
-          avail_size = width - stepper_size * 2;
-          handle_size = increment * avail_size;
-          handle_size = CLAMP (handle_size, min_size, max_size);
-
-          handle_pos = bw_box.x2 + position * (avail_size - handle_size);
-          handle_box.x1 = CLAMP (handle_pos,
-                                 bw_box.x2, fw_box.x1 - min_size);
-          handle_box.y1 = y;
-
-          handle_box.x2 = CLAMP (handle_pos + handle_size,
-                                 bw_box.x2 + min_size, fw_box.x1);
-          handle_box.y2 = handle_box.y1 + height;
+          priv->handle_offset = 0;
+          clutter_actor_set_translation (priv->handle, 0, 0, 0);
         }
-
-      /* snap to pixel */
-      handle_box.x1 = (int) handle_box.x1;
-      handle_box.y1 = (int) handle_box.y1;
-      handle_box.x2 = (int) handle_box.x2;
-      handle_box.y2 = (int) handle_box.y2;
-
-      clutter_actor_allocate (priv->handle,
-                              &handle_box,
-                              flags);
     }
 }
 
@@ -457,15 +506,18 @@ static void
 mx_scroll_bar_style_changed (MxWidget *widget, MxStyleChangedFlags flags)
 {
   MxScrollBarPrivate *priv = MX_SCROLL_BAR (widget)->priv;
-  guint handle_min_size;
+  guint handle_min_size, handle_max_size;
 
   mx_stylable_get (MX_STYLABLE (widget),
                    "mx-min-size", &handle_min_size,
+                   "mx-max-size", &handle_max_size,
                    NULL);
 
-  if (handle_min_size != priv->handle_min_size)
+  if (handle_min_size != priv->handle_min_size ||
+      handle_max_size != priv->handle_max_size)
     {
       priv->handle_min_size = handle_min_size;
+      priv->handle_max_size = handle_max_size;
       clutter_actor_queue_relayout (CLUTTER_ACTOR (widget));
     }
 }
@@ -821,10 +873,7 @@ trough_paging_cb (MxScrollBar *self)
                             &value, NULL, NULL,
                             NULL, &page_increment, NULL);
 
-  if (self->priv->orientation == MX_ORIENTATION_VERTICAL)
-    handle_pos = clutter_actor_get_y (self->priv->handle);
-  else
-    handle_pos = clutter_actor_get_x (self->priv->handle);
+  handle_pos = self->priv->handle_position + self->priv->handle_offset;
 
   clutter_actor_transform_stage_point (CLUTTER_ACTOR (self->priv->trough),
                                        self->priv->move_x,
@@ -1024,6 +1073,8 @@ mx_scroll_bar_init (MxScrollBar *self)
 {
   self->priv = MX_SCROLL_BAR_GET_PRIVATE (self);
 
+  self->priv->handle_max_size = G_MAXINT16;
+
   self->priv->bw_stepper = mx_button_new ();
   mx_stylable_set_style_class (MX_STYLABLE (self->priv->bw_stepper),
                                "backward-stepper");
@@ -1104,6 +1155,50 @@ mx_scroll_bar_new_with_adjustment (MxAdjustment *adjustment)
                        NULL);
 }
 
+static void
+mx_scroll_bar_adjustment_changed_cb (MxScrollBar *bar)
+{
+  MxScrollBarPrivate *priv = bar->priv;
+  ClutterActor *actor = CLUTTER_ACTOR (bar);
+  gdouble value, lower, upper, page_size;
+  ClutterActorBox handle_box;
+
+  mx_adjustment_get_values (priv->adjustment,
+                            &value,
+                            &lower,
+                            &upper,
+                            NULL,
+                            NULL,
+                            &page_size);
+
+  /* When only the value changed, the handle keeps its size and is moved
+   * with its translation. This avoids queueing a relayout of the scroll
+   * bar and all of its parents every time the value changes while
+   * scrolling. "changed" is emitted at most once per frame, before layout,
+   * and covers the value changing too. */
+  if (!clutter_actor_has_allocation (actor) ||
+      lower != priv->handle_lower ||
+      upper != priv->handle_upper ||
+      page_size != priv->handle_page_size)
+    {
+      clutter_actor_queue_relayout (actor);
+      return;
+    }
+
+  mx_scroll_bar_get_handle_box (bar, value, &handle_box);
+
+  if (priv->orientation == MX_ORIENTATION_VERTICAL)
+    {
+      priv->handle_offset = handle_box.y1 - priv->handle_position;
+      clutter_actor_set_translation (priv->handle, 0, priv->handle_offset, 0);
+    }
+  else
+    {
+      priv->handle_offset = handle_box.x1 - priv->handle_position;
+      clutter_actor_set_translation (priv->handle, priv->handle_offset, 0, 0);
+    }
+}
+
 void
 mx_scroll_bar_set_adjustment (MxScrollBar  *bar,
                               MxAdjustment *adjustment)
@@ -1116,10 +1211,7 @@ mx_scroll_bar_set_adjustment (MxScrollBar  *bar,
   if (priv->adjustment)
     {
       g_signal_handlers_disconnect_by_func (priv->adjustment,
-                                            clutter_actor_queue_relayout,
-                                            bar);
-      g_signal_handlers_disconnect_by_func (priv->adjustment,
-                                            clutter_actor_queue_relayout,
+                                            mx_scroll_bar_adjustment_changed_cb,
                                             bar);
       g_object_unref (priv->adjustment);
       priv->adjustment = NULL;
@@ -1129,11 +1221,8 @@ mx_scroll_bar_set_adjustment (MxScrollBar  *bar,
     {
       priv->adjustment = g_object_ref (adjustment);
 
-      g_signal_connect_swapped (priv->adjustment, "notify::value",
-                                G_CALLBACK (clutter_actor_queue_relayout),
-                                bar);
       g_signal_connect_swapped (priv->adjustment, "changed",
-                                G_CALLBACK (clutter_actor_queue_relayout),
+                                G_CALLBACK (mx_scroll_bar_adjustment_changed_cb),
                                 bar);
 
       clutter_actor_queue_relayout (CLUTTER_ACTOR (bar));
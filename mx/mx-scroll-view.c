@@ -76,6 +76,8 @@ struct _MxScrollViewPrivate
   guint         scrollbar_width;
   guint         scrollbar_height;
 
+  ClutterColor  background_color;
+
   MxScrollPolicy scroll_policy;
   MxScrollPolicy scroll_visibility;
 };
@@ -186,19 +188,15 @@ mx_scroll_view_paint (ClutterActor *actor)
   gfloat w, h;
   MxAdjustment *vadjustment = NULL, *hadjustment = NULL;
   MxScrollViewPrivate *priv = MX_SCROLL_VIEW (actor)->priv;
-  ClutterColor *color;
 
   guint8 r, g, b;
   const gint shadow = 15;
 
   CLUTTER_ACTOR_CLASS (mx_scroll_view_parent_class)->paint (actor);
 
-  mx_stylable_get (MX_STYLABLE (actor), "background-color", &color, NULL);
-
-  r = color->red;
-  g = color->green;
-  b = color->blue;
-  clutter_color_free (color);
+  r = priv->background_color.red;
+  g = priv->background_color.green;
+  b = priv->background_color.blue;
 
   /* If there is a child to paint, clip it */
   if (priv->child)
@@ -488,6 +486,8 @@ mx_scroll_view_allocate (ClutterActor          *actor,
 
   MxScrollViewPrivate *priv = MX_SCROLL_VIEW (actor)->priv;
 
+  _mx_scroll_stats_relayout (actor);
+
   CLUTTER_ACTOR_CLASS (mx_scroll_view_parent_class)->
     allocate (actor, box, flags);
 
@@ -543,12 +543,21 @@ mx_scroll_view_style_changed (MxWidget *widget, MxStyleChangedFlags flags)
 {
   MxScrollViewPrivate *priv = MX_SCROLL_VIEW (widget)->priv;
   gint scrollbar_width, scrollbar_height;
+  ClutterColor *background_color = NULL;
 
   mx_stylable_get (MX_STYLABLE (widget),
                    "x-mx-scrollbar-width", &scrollbar_width,
                    "x-mx-scrollbar-height", &scrollbar_height,
+                   "background-color", &background_color,
                    NULL);
 
+  /* kept for the shadows, so paint doesn't need a style lookup */
+  if (background_color)
+    {
+      priv->background_color = *background_color;
+      clutter_color_free (background_color);
+    }
+
   if (scrollbar_width != priv->scrollbar_width ||
       scrollbar_height != priv->scrollbar_height)
     {
@@ -792,6 +801,7 @@ child_adjustment_changed_cb (MxAdjustment *adjustment,
   gdouble lower, upper, page_size;
   MxScrollPolicy policy;
   ClutterActor *actor;
+  gboolean visible;
 
   if (adjustment ==
       mx_scroll_bar_get_adjustment (MX_SCROLL_BAR (priv->vscroll)))
@@ -811,15 +821,17 @@ child_adjustment_changed_cb (MxAdjustment *adjustment,
                             NULL, NULL,
                             &page_size);
 
-  if (((upper - lower) > page_size) &&
-      ((priv->scroll_visibility == MX_SCROLL_POLICY_BOTH) ||
-       (priv->scroll_visibility == policy)))
+  visible = (((upper - lower) > page_size) &&
+             ((priv->scroll_visibility == MX_SCROLL_POLICY_BOTH) ||
+              (priv->scroll_visibility == policy)));
+
+  /* "changed" is also emitted whenever the value changes, so only request
+   * a resize when the scroll-bar is shown or hidden, which queues the
+   * relayout, to keep scrolling free of relayouts */
+  if (visible && !CLUTTER_ACTOR_IS_VISIBLE (actor))
     clutter_actor_show (actor);
-  else
+  else if (!visible && CLUTTER_ACTOR_IS_VISIBLE (actor))
     clutter_actor_hide (actor);
-
-  /* Request a resize */
-  clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
 }
 
 static void
@@ -25,6 +25,16 @@
 
 #include "mx-scrollable.h"
 #include "mx-private.h"
+#include "mx-marshal.h"
+
+enum
+{
+  VIEWPORT_PREDICTED,
+
+  LAST_SIGNAL
+};
+
+static guint scrollable_signals[LAST_SIGNAL] = { 0, };
 
 static void
 mx_scrollable_base_init (gpointer g_iface)
@@ -48,6 +58,34 @@ mx_scrollable_base_init (gpointer g_iface)
                                    MX_PARAM_READWRITE);
       g_object_interface_install_property (g_iface, pspec);
 
+      /**
+       * MxScrollable::viewport-predicted:
+       * @scrollable: the object that received the signal
+       * @x: the value the horizontal adjustment is expected to settle at
+       * @y: the value the vertical adjustment is expected to settle at
+       * @velocity_x: the horizontal scrolling velocity, in units per second
+       * @velocity_y: the vertical scrolling velocity, in units per second
+       *
+       * Emitted when the scrolling of @scrollable is animated towards a
+       * known position, such as when a kinetic scroll view is flung, and
+       * again with a velocity of zero once it comes to rest. Content along
+       * the way can be prepared before it becomes visible.
+       *
+       * Since: 2.0
+       */
+      scrollable_signals[VIEWPORT_PREDICTED] =
+        g_signal_new (g_intern_static_string ("viewport-predicted"),
+                      G_TYPE_FROM_INTERFACE (g_iface),
+                      G_SIGNAL_RUN_LAST,
+                      G_STRUCT_OFFSET (MxScrollableIface, viewport_predicted),
+                      NULL, NULL,
+                      _mx_marshal_VOID__DOUBLE_DOUBLE_DOUBLE_DOUBLE,
+                      G_TYPE_NONE, 4,
+                      G_TYPE_DOUBLE,
+                      G_TYPE_DOUBLE,
+                      G_TYPE_DOUBLE,
+                      G_TYPE_DOUBLE);
+
       initialized = TRUE;
     }
 }
@@ -97,3 +135,30 @@ mx_scrollable_get_adjustments (MxScrollable  *scrollable,
                                                          hadjustment,
                                                          vadjustment);
 }
+
+/**
+ * mx_scrollable_predict_viewport:
+ * @scrollable: A #MxScrollable
+ * @x: the value the horizontal adjustment is expected to settle at
+ * @y: the value the vertical adjustment is expected to settle at
+ * @velocity_x: the horizontal scrolling velocity, in units per second
+ * @velocity_y: the vertical scrolling velocity, in units per second
+ *
+ * Emits the #MxScrollable::viewport-predicted signal on @scrollable. This
+ * is meant to be called by actors that animate the adjustments of
+ * @scrollable, when they know where the animation is going to stop.
+ *
+ * Since: 2.0
+ */
+void
+mx_scrollable_predict_viewport (MxScrollable *scrollable,
+                                gdouble       x,
+                                gdouble       y,
+                                gdouble       velocity_x,
+                                gdouble       velocity_y)
+{
+  g_return_if_fail (MX_IS_SCROLLABLE (scrollable));
+
+  g_signal_emit (scrollable, scrollable_signals[VIEWPORT_PREDICTED], 0,
+                 x, y, velocity_x, velocity_y);
+}
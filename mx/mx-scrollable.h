@@ -49,6 +49,15 @@ G_BEGIN_DECLS
 typedef struct _MxScrollable MxScrollable; /* Dummy object */
 typedef struct _MxScrollableIface MxScrollableIface;
 
+/**
+ * MxScrollableIface:
+ * @set_adjustments: virtual function to set the adjustments
+ * @get_adjustments: virtual function to get the adjustments
+ * @viewport_predicted: class handler for the
+ *   #MxScrollable::viewport-predicted signal
+ *
+ * Interface for scrollable actors.
+ */
 struct _MxScrollableIface
 {
   /*< private >*/
@@ -61,6 +70,13 @@ struct _MxScrollableIface
   void (* get_adjustments) (MxScrollable  *scrollable,
                             MxAdjustment **hadjustment,
                             MxAdjustment **vadjustment);
+
+  /* signals */
+  void (* viewport_predicted) (MxScrollable *scrollable,
+                               gdouble       x,
+                               gdouble       y,
+                               gdouble       velocity_x,
+                               gdouble       velocity_y);
 };
 
 GType mx_scrollable_get_type (void) G_GNUC_CONST;
@@ -72,6 +88,12 @@ void mx_scrollable_get_adjustments (MxScrollable  *scrollable,
                                     MxAdjustment **hadjustment,
                                     MxAdjustment **vadjustment);
 
+void mx_scrollable_predict_viewport (MxScrollable *scrollable,
+                                     gdouble       x,
+                                     gdouble       y,
+                                     gdouble       velocity_x,
+                                     gdouble       velocity_y);
+
 G_END_DECLS
 
 #endif /* __MX_SCROLLABLE_H__ */
@@ -26,12 +26,21 @@
  *
  * The #MxSpinner is a widget to use to indicate that something is being
  * processed, usually a task of indeterminate length.
+ *
+ * The frames of the animation are taken from the image given by the
+ * "-mx-spinner-image" style property. They are laid out row by row, in
+ * "-mx-spinner-columns" columns (all of them on a single row by default).
+ * The frames are shown for the same time, so that the whole animation lasts
+ * "-mx-spinner-animation-duration" milliseconds, unless
+ * "-mx-spinner-frame-durations" gives a space separated list of durations
+ * for each frame. The animation is paused while the spinner isn't visible.
  */
 
 #include "mx-spinner.h"
 #include "mx-marshal.h"
 #include "mx-private.h"
 #include "mx-stylable.h"
+#include "mx-sprite-animation.h"
 
 static void mx_stylable_iface_init (MxStylableIface *iface);
 
@@ -60,11 +69,8 @@ struct _MxSpinnerPrivate
 {
   CoglHandle  texture;
   CoglHandle  material;
-  guint       frames;
-  guint       anim_duration;
 
-  guint       current_frame;
-  guint       update_id;
+  MxSpriteAnimation *animation;
 
   guint       animating : 1;
 };
@@ -115,10 +121,10 @@ mx_spinner_dispose (GObject *object)
 {
   MxSpinnerPrivate *priv = MX_SPINNER (object)->priv;
 
-  if (priv->update_id)
+  if (priv->animation)
     {
-      g_source_remove (priv->update_id);
-      priv->update_id = 0;
+      _mx_sprite_animation_free (priv->animation);
+      priv->animation = NULL;
     }
 
   if (priv->material)
@@ -151,8 +157,10 @@ mx_spinner_get_preferred_width (ClutterActor *actor,
 
   if (priv->material != COGL_INVALID_HANDLE)
     {
-      width = cogl_texture_get_width (priv->texture) / priv->frames;
-      height = cogl_texture_get_height (priv->texture);
+      width = cogl_texture_get_width (priv->texture) /
+        _mx_sprite_animation_get_columns (priv->animation);
+      height = cogl_texture_get_height (priv->texture) /
+        _mx_sprite_animation_get_rows (priv->animation);
       min_width = width;
 
       if (for_height >= 0 && for_height < height)
@@ -188,13 +196,14 @@ mx_spinner_get_preferred_height (ClutterActor *actor,
 
   if (priv->material != COGL_INVALID_HANDLE)
     {
-      height = cogl_texture_get_height (priv->texture);
-      width = cogl_texture_get_width (priv->texture);
+      height = cogl_texture_get_height (priv->texture) /
+        _mx_sprite_animation_get_rows (priv->animation);
+      width = cogl_texture_get_width (priv->texture) /
+        _mx_sprite_animation_get_columns (priv->animation);
       min_height = height;
 
       if (for_width >= 0 && for_width < width)
         {
-          width = cogl_texture_get_width (priv->texture) / priv->frames;
           for_width = MAX (0, for_width - padding.left - padding.right);
 
           height = (guint)((gfloat)height * (for_width / (gfloat)width));
@@ -217,6 +226,7 @@ mx_spinner_paint (ClutterActor *actor)
   guint8 opacity;
   MxPadding padding;
   gfloat width, height;
+  gfloat coords[4];
   MxSpinnerPrivate *priv = MX_SPINNER (actor)->priv;
 
   /* Chain up for background */
@@ -231,17 +241,16 @@ mx_spinner_paint (ClutterActor *actor)
 
   cogl_material_set_color4ub (priv->material,
                               opacity, opacity, opacity, opacity);
+  _mx_sprite_animation_get_coords (priv->animation, coords);
+  _mx_sprite_animation_painted (priv->animation);
+
   cogl_set_source (priv->material);
   cogl_rectangle_with_texture_coords (padding.left,
                                       padding.top,
                                       width - padding.right,
                                       height - padding.bottom,
-                                      priv->current_frame /
-                                      (gfloat)priv->frames,
-                                      0,
-                                      (priv->current_frame + 1) /
-                                      (gfloat)priv->frames,
-                                      1);
+                                      coords[0], coords[1],
+                                      coords[2], coords[3]);
 }
 
 static void
@@ -266,11 +275,28 @@ mx_stylable_iface_init (MxStylableIface *iface)
       pspec = g_param_spec_uint ("x-mx-spinner-frames",
                                  "Spinner frames",
                                  "Number of frames contained in the spinner "
-                                 "image, horizontally.",
+                                 "image.",
                                   1, G_MAXUINT, 1,
                                   MX_PARAM_READWRITE);
       mx_stylable_iface_install_property (iface, MX_TYPE_SPINNER, pspec);
 
+      pspec = g_param_spec_uint ("x-mx-spinner-columns",
+                                 "Spinner columns",
+                                 "Number of frames on each row of the "
+                                 "spinner image, or 0 to have all the "
+                                 "frames on a single row.",
+                                  0, G_MAXUINT, 0,
+                                  MX_PARAM_READWRITE);
+      mx_stylable_iface_install_property (iface, MX_TYPE_SPINNER, pspec);
+
+      pspec = g_param_spec_string ("x-mx-spinner-frame-durations",
+                                   "Spinner frame durations",
+                                   "Space separated list of the durations "
+                                   "of each frame, in milliseconds.",
+                                   NULL,
+                                   MX_PARAM_READWRITE);
+      mx_stylable_iface_install_property (iface, MX_TYPE_SPINNER, pspec);
+
       pspec = g_param_spec_uint ("x-mx-spinner-animation-duration",
                                  "Spinner animation duration",
                                  "Duration of the entire spinner animation, "
@@ -325,46 +351,10 @@ mx_spinner_class_init (MxSpinnerClass *klass)
                   G_TYPE_NONE, 0);
 }
 
-static gboolean
-mx_spinner_timeout_cb (MxSpinner *spinner)
-{
-  MxSpinnerPrivate *priv = spinner->priv;
-
-  /* We may be destroyed during the signal emission, so
-   * queue the redraw here instead of below.
-   */
-  clutter_actor_queue_redraw (CLUTTER_ACTOR (spinner));
-
-  if (++priv->current_frame == priv->frames)
-    {
-      priv->current_frame = 0;
-      g_signal_emit (spinner, signals[LOOPED], 0);
-    }
-
-  return TRUE;
-}
-
 static void
-mx_spinner_update_timeout (MxSpinner *spinner)
+mx_spinner_looped_cb (MxSpinner *spinner)
 {
-  MxSpinnerPrivate *priv = spinner->priv;
-
-  if (priv->update_id)
-    {
-      g_source_remove (priv->update_id);
-      priv->update_id = 0;
-    }
-
-  if (priv->animating && priv->frames && priv->material)
-    priv->update_id = clutter_threads_add_timeout_full (CLUTTER_PRIORITY_REDRAW,
-                                                        MAX (1, priv->anim_duration /
-                                                             priv->frames),
-                                                        (GSourceFunc)
-                                                        mx_spinner_timeout_cb,
-                                                        spinner,
-                                                        NULL);
-  else
-    priv->current_frame = 0;
+  g_signal_emit (spinner, signals[LOOPED], 0);
 }
 
 static void
@@ -372,7 +362,9 @@ mx_spinner_style_changed_cb (MxStylable          *stylable,
                              MxStyleChangedFlags  flags)
 {
   MxBorderImage *image;
-  guint frames, anim_duration;
+  guint frames, columns, anim_duration;
+  gchar *durations_string;
+  GArray *durations;
 
   MxSpinner *spinner = MX_SPINNER (stylable);
   MxSpinnerPrivate *priv = spinner->priv;
@@ -380,7 +372,9 @@ mx_spinner_style_changed_cb (MxStylable          *stylable,
   mx_stylable_get (stylable,
                    "x-mx-spinner-image", &image,
                    "x-mx-spinner-frames", &frames,
+                   "x-mx-spinner-columns", &columns,
                    "x-mx-spinner-animation-duration", &anim_duration,
+                   "x-mx-spinner-frame-durations", &durations_string,
                    NULL);
 
   if (priv->material)
@@ -389,9 +383,51 @@ mx_spinner_style_changed_cb (MxStylable          *stylable,
       priv->material = NULL;
     }
 
-  priv->anim_duration = anim_duration;
-  priv->frames = frames;
-  priv->current_frame = 0;
+  durations = g_array_new (FALSE, FALSE, sizeof (guint));
+  if (durations_string)
+    {
+      gchar **strv = g_strsplit (durations_string, " ", 0);
+      gint i;
+
+      for (i = 0; strv[i]; i++)
+        {
+          gchar *end;
+          guint64 value;
+          guint duration;
+
+          /* skip the empty strings left by repeated spaces */
+          if (!*strv[i])
+            continue;
+
+          /* g_ascii_strtoull() silently negates a leading minus */
+          value = g_ascii_strtoull (strv[i], &end, 10);
+          if (*strv[i] == '-' || end == strv[i] || *end != '\0' ||
+              value == 0 || value > G_MAXUINT)
+            {
+              g_warning ("Invalid frame duration \"%s\" in "
+                         "x-mx-spinner-frame-durations", strv[i]);
+              continue;
+            }
+
+          duration = value;
+          g_array_append_val (durations, duration);
+        }
+
+      g_strfreev (strv);
+      g_free (durations_string);
+    }
+
+  if (durations->len == 0)
+    {
+      guint duration = MAX (1, anim_duration / MAX (1, frames));
+      g_array_append_val (durations, duration);
+    }
+
+  _mx_sprite_animation_set_layout (priv->animation, frames, columns);
+  _mx_sprite_animation_set_durations (priv->animation,
+                                      (guint *) durations->data,
+                                      durations->len);
+  g_array_free (durations, TRUE);
 
   if (image)
     {
@@ -407,7 +443,8 @@ mx_spinner_style_changed_cb (MxStylable          *stylable,
         }
     }
 
-  mx_spinner_update_timeout (spinner);
+  _mx_sprite_animation_set_playing (priv->animation,
+                                    priv->animating && priv->material);
 
   clutter_actor_queue_relayout (CLUTTER_ACTOR (stylable));
 }
@@ -417,9 +454,11 @@ mx_spinner_init (MxSpinner *self)
 {
   MxSpinnerPrivate *priv = self->priv = SPINNER_PRIVATE (self);
 
-  priv->anim_duration = 500;
-  priv->frames = 1;
   priv->animating = TRUE;
+  priv->animation =
+    _mx_sprite_animation_new (CLUTTER_ACTOR (self),
+                              (MxSpriteAnimationFunc) mx_spinner_looped_cb,
+                              self);
 
   g_signal_connect (self, "style-changed",
                     G_CALLBACK (mx_spinner_style_changed_cb), NULL);
@@ -478,7 +517,8 @@ mx_spinner_set_animating (MxSpinner *spinner, gboolean animating)
   if (priv->animating != animating)
     {
       priv->animating = animating;
-      mx_spinner_update_timeout (spinner);
+      _mx_sprite_animation_set_playing (priv->animation,
+                                        animating && priv->material);
       g_object_notify (G_OBJECT (spinner), "animating");
     }
 }
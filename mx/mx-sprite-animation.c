@@ -0,0 +1,304 @@
+/*
+ * mx-sprite-animation.c: Frame clock driven playback of sprite sheets
+ *
+ * Copyright 2012 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/*
+ * This is private to MX
+ *
+ * Steps through the frames of a sprite sheet laid out as a grid, row by
+ * row, each frame being shown for its own duration. The frames are advanced
+ * from a looping #ClutterTimeline, so they follow the master clock rather
+ * than a main loop timeout.
+ *
+ * The timeline is paused while the actor is unmapped. It is also paused
+ * when the actor wasn't painted after a frame change was queued, which
+ * happens when it is culled because it lies entirely outside of the clip;
+ * the owner reports paints with _mx_sprite_animation_painted(), which
+ * resumes the playback once the actor becomes visible again.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "mx-sprite-animation.h"
+
+#define MX_SPRITE_ANIMATION_DEFAULT_DURATION 100
+
+struct _MxSpriteAnimation
+{
+  ClutterActor          *actor;
+  ClutterTimeline       *timeline;
+
+  MxSpriteAnimationFunc  looped;
+  gpointer               user_data;
+
+  guint                  n_frames;
+  guint                  columns;
+
+  guint                 *durations;
+  guint                  n_durations;
+
+  /* the time at which each frame ends, from the start of the loop */
+  guint                 *frame_ends;
+
+  guint                  current_frame;
+  guint                  last_elapsed;
+
+  guint                  playing : 1;
+  guint                  painted : 1;
+  guint                  clipped : 1;
+};
+
+static void
+mx_sprite_animation_update_timeline (MxSpriteAnimation *animation)
+{
+  gboolean run;
+
+  if (!animation->playing)
+    {
+      clutter_timeline_stop (animation->timeline);
+      animation->last_elapsed = 0;
+
+      if (animation->current_frame != 0)
+        {
+          animation->current_frame = 0;
+          clutter_actor_queue_redraw (animation->actor);
+        }
+
+      return;
+    }
+
+  run = (animation->n_frames > 1 &&
+         !animation->clipped &&
+         CLUTTER_ACTOR_IS_MAPPED (animation->actor));
+
+  if (run && !clutter_timeline_is_playing (animation->timeline))
+    {
+      animation->painted = TRUE;
+      clutter_timeline_start (animation->timeline);
+    }
+  else if (!run && clutter_timeline_is_playing (animation->timeline))
+    clutter_timeline_pause (animation->timeline);
+}
+
+static void
+mx_sprite_animation_new_frame_cb (ClutterTimeline   *timeline,
+                                  gint               elapsed_msecs,
+                                  MxSpriteAnimation *animation)
+{
+  guint elapsed, frame;
+  gboolean looped;
+
+  elapsed = clutter_timeline_get_elapsed_time (timeline);
+  looped = (elapsed < animation->last_elapsed);
+  animation->last_elapsed = elapsed;
+
+  for (frame = 0; frame < animation->n_frames - 1; frame++)
+    if (elapsed < animation->frame_ends[frame])
+      break;
+
+  if (frame == animation->current_frame && !looped)
+    return;
+
+  /* the previous frame was never painted, so the actor is hidden */
+  if (!animation->painted)
+    {
+      animation->clipped = TRUE;
+      clutter_timeline_pause (timeline);
+      return;
+    }
+
+  animation->current_frame = frame;
+  animation->painted = FALSE;
+  clutter_actor_queue_redraw (animation->actor);
+
+  if (looped && animation->looped)
+    animation->looped (animation->user_data);
+}
+
+static void
+mx_sprite_animation_notify_mapped_cb (MxSpriteAnimation *animation)
+{
+  animation->clipped = FALSE;
+  mx_sprite_animation_update_timeline (animation);
+}
+
+static void
+mx_sprite_animation_update_frames (MxSpriteAnimation *animation)
+{
+  guint i, end = 0;
+
+  g_free (animation->frame_ends);
+  animation->frame_ends = g_new (guint, MAX (1, animation->n_frames));
+
+  for (i = 0; i < animation->n_frames; i++)
+    {
+      if (animation->n_durations)
+        end += MAX (1, animation->durations[i % animation->n_durations]);
+      else
+        end += MX_SPRITE_ANIMATION_DEFAULT_DURATION;
+
+      animation->frame_ends[i] = end;
+    }
+
+  if (animation->current_frame >= animation->n_frames)
+    animation->current_frame = 0;
+
+  clutter_timeline_set_duration (animation->timeline, MAX (1, end));
+  clutter_actor_queue_redraw (animation->actor);
+
+  mx_sprite_animation_update_timeline (animation);
+}
+
+MxSpriteAnimation *
+_mx_sprite_animation_new (ClutterActor          *actor,
+                          MxSpriteAnimationFunc  looped,
+                          gpointer               user_data)
+{
+  MxSpriteAnimation *animation;
+
+  animation = g_slice_new0 (MxSpriteAnimation);
+
+  animation->actor = actor;
+  animation->looped = looped;
+  animation->user_data = user_data;
+  animation->n_frames = 1;
+  animation->columns = 1;
+
+  animation->timeline = clutter_timeline_new (1);
+  clutter_timeline_set_repeat_count (animation->timeline, -1);
+  g_signal_connect (animation->timeline, "new-frame",
+                    G_CALLBACK (mx_sprite_animation_new_frame_cb), animation);
+
+  g_signal_connect_swapped (actor, "notify::mapped",
+                            G_CALLBACK (mx_sprite_animation_notify_mapped_cb),
+                            animation);
+
+  mx_sprite_animation_update_frames (animation);
+
+  return animation;
+}
+
+void
+_mx_sprite_animation_free (MxSpriteAnimation *animation)
+{
+  g_signal_handlers_disconnect_by_func (animation->actor,
+                                        mx_sprite_animation_notify_mapped_cb,
+                                        animation);
+
+  clutter_timeline_stop (animation->timeline);
+  g_object_unref (animation->timeline);
+
+  g_free (animation->durations);
+  g_free (animation->frame_ends);
+
+  g_slice_free (MxSpriteAnimation, animation);
+}
+
+void
+_mx_sprite_animation_set_layout (MxSpriteAnimation *animation,
+                                 guint              n_frames,
+                                 guint              columns)
+{
+  n_frames = MAX (1, n_frames);
+  columns = (columns == 0) ? n_frames : MIN (columns, n_frames);
+
+  if (animation->n_frames == n_frames && animation->columns == columns)
+    return;
+
+  animation->n_frames = n_frames;
+  animation->columns = columns;
+
+  mx_sprite_animation_update_frames (animation);
+}
+
+/* Sets the time each frame is shown for, in milliseconds. When there are
+ * fewer durations than frames, they are repeated. */
+void
+_mx_sprite_animation_set_durations (MxSpriteAnimation *animation,
+                                    const guint       *durations,
+                                    guint              n_durations)
+{
+  g_free (animation->durations);
+
+#if GLIB_CHECK_VERSION (2, 68, 0)
+  animation->durations = g_memdup2 (durations, n_durations * sizeof (guint));
+#else
+  animation->durations = g_memdup (durations, n_durations * sizeof (guint));
+#endif
+  animation->n_durations = durations ? n_durations : 0;
+
+  mx_sprite_animation_update_frames (animation);
+}
+
+void
+_mx_sprite_animation_set_playing (MxSpriteAnimation *animation,
+                                  gboolean           playing)
+{
+  if (animation->playing == playing)
+    return;
+
+  animation->playing = playing;
+  animation->clipped = FALSE;
+
+  mx_sprite_animation_update_timeline (animation);
+}
+
+guint
+_mx_sprite_animation_get_columns (MxSpriteAnimation *animation)
+{
+  return animation->columns;
+}
+
+guint
+_mx_sprite_animation_get_rows (MxSpriteAnimation *animation)
+{
+  return (animation->n_frames + animation->columns - 1) / animation->columns;
+}
+
+/* Stores the texture coordinates of the current frame in @coords, as
+ * tx1, ty1, tx2, ty2 */
+void
+_mx_sprite_animation_get_coords (MxSpriteAnimation *animation,
+                                 gfloat            *coords)
+{
+  guint column, row, rows;
+
+  rows = _mx_sprite_animation_get_rows (animation);
+  column = animation->current_frame % animation->columns;
+  row = animation->current_frame / animation->columns;
+
+  coords[0] = column / (gfloat) animation->columns;
+  coords[1] = row / (gfloat) rows;
+  coords[2] = (column + 1) / (gfloat) animation->columns;
+  coords[3] = (row + 1) / (gfloat) rows;
+}
+
+void
+_mx_sprite_animation_painted (MxSpriteAnimation *animation)
+{
+  animation->painted = TRUE;
+
+  if (animation->clipped)
+    {
+      animation->clipped = FALSE;
+      mx_sprite_animation_update_timeline (animation);
+    }
+}
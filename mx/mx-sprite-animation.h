@@ -0,0 +1,60 @@
+/*
+ * mx-sprite-animation.h: Frame clock driven playback of sprite sheets
+ *
+ * Copyright 2012 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/*
+ * This is private to MX
+ */
+
+#include <glib.h>
+#include <clutter/clutter.h>
+
+G_BEGIN_DECLS
+
+#ifndef _MX_SPRITE_ANIMATION_H
+#define _MX_SPRITE_ANIMATION_H
+
+typedef struct _MxSpriteAnimation MxSpriteAnimation;
+
+typedef void (*MxSpriteAnimationFunc) (gpointer user_data);
+
+MxSpriteAnimation *_mx_sprite_animation_new        (ClutterActor          *actor,
+                                                    MxSpriteAnimationFunc  looped,
+                                                    gpointer               user_data);
+void               _mx_sprite_animation_free       (MxSpriteAnimation     *animation);
+
+void               _mx_sprite_animation_set_layout (MxSpriteAnimation     *animation,
+                                                    guint                  n_frames,
+                                                    guint                  columns);
+void            _mx_sprite_animation_set_durations (MxSpriteAnimation     *animation,
+                                                    const guint           *durations,
+                                                    guint                  n_durations);
+void               _mx_sprite_animation_set_playing (MxSpriteAnimation    *animation,
+                                                     gboolean              playing);
+
+guint              _mx_sprite_animation_get_columns (MxSpriteAnimation    *animation);
+guint              _mx_sprite_animation_get_rows    (MxSpriteAnimation    *animation);
+void               _mx_sprite_animation_get_coords  (MxSpriteAnimation    *animation,
+                                                     gfloat               *coords);
+
+void               _mx_sprite_animation_painted     (MxSpriteAnimation    *animation);
+
+G_END_DECLS
+
+#endif /* _MX_SPRITE_ANIMATION_H */
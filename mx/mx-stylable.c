@@ -49,6 +49,7 @@
 
 
 #include <cogl-pango/cogl-pango.h>
+#include <pango/pangocairo.h>
 
 enum
 {
@@ -70,6 +71,10 @@ static GQuark quark_style              = 0;
 
 static guint stylable_signals[LAST_SIGNAL] = { 0, };
 
+/* MX_DEBUG=style-gets bookkeeping */
+static guint mx_stylable_style_changed_depth = 0;
+static guint mx_stylable_frame_gets = 0;
+
 static void mx_stylable_property_changed_notify (MxStylable *stylable);
 
 static void
@@ -542,6 +547,42 @@ mx_stylable_get_style_property (MxStylable  *stylable,
   mx_stylable_get_property_internal (stylable, pspec, value);
 }
 
+static void
+mx_stylable_frame_end_cb (gpointer data)
+{
+  if (mx_stylable_frame_gets)
+    MX_NOTE (STYLE_GETS, "%u mx_stylable_get() calls during the last frame",
+             mx_stylable_frame_gets);
+
+  mx_stylable_frame_gets = 0;
+}
+
+/* Count the style lookups made while Clutter lays out and paints a frame.
+ * Widgets are expected to capture the values they need when their style
+ * changes, so lookups during a frame (outside of a style-changed emission)
+ * are reported to help catch regressions.
+ */
+static void
+mx_stylable_count_get (MxStylable  *stylable,
+                       const gchar *first_property_name)
+{
+  static gboolean installed = FALSE;
+
+  if (G_UNLIKELY (!installed))
+    {
+      _mx_debug_add_frame_end_func (mx_stylable_frame_end_cb, NULL);
+      installed = TRUE;
+    }
+
+  if (!_mx_debug_in_frame () || mx_stylable_style_changed_depth)
+    return;
+
+  mx_stylable_frame_gets++;
+
+  MX_NOTE (STYLE_GETS, "%s (%p) looked up \"%s\" during a frame",
+           G_OBJECT_TYPE_NAME (stylable), stylable, first_property_name);
+}
+
 /**
  * mx_stylable_get:
  * @stylable: a #MxStylable
@@ -586,6 +627,9 @@ mx_stylable_get (MxStylable  *stylable,
   g_return_if_fail (MX_IS_STYLABLE (stylable));
   g_return_if_fail (first_property_name != NULL);
 
+  if (G_UNLIKELY (_mx_debug (MX_DEBUG_STYLE_GETS)))
+    mx_stylable_count_get (stylable, first_property_name);
+
   style = mx_stylable_get_style (stylable);
 
   va_start (args, first_property_name);
@@ -1081,7 +1125,9 @@ mx_stylable_style_changed_internal (MxStylable          *stylable,
        */
       flags |= MX_STYLE_CHANGED_INVALIDATE_CACHE;
 
+      mx_stylable_style_changed_depth++;
       g_signal_emit (stylable, stylable_signals[STYLE_CHANGED], 0, flags);
+      mx_stylable_style_changed_depth--;
     }
 
   /* propagate the style-changed signal to children, since their style may
@@ -1155,35 +1201,219 @@ mx_stylable_disconnect_change_notifiers (MxStylable *stylable)
                                         NULL);
 }
 
+/* The text shadow is rendered once, as an alpha mask, into a texture that
+ * is reused until the layout or the blur radius changes. The colour and
+ * offset of the shadow are applied when painting, so changing them doesn't
+ * need the shadow to be rendered again.
+ */
+typedef struct
+{
+  MxTextShadow  shadow;
+
+  PangoLayout  *layout;
+  CoglHandle    material;
+  gfloat        x;
+  gfloat        y;
+  gfloat        width;
+  gfloat        height;
+} MxTextShadowCache;
+
+static void
+stylable_text_shadow_cache_clear (MxTextShadowCache *cache)
+{
+  if (cache->layout)
+    {
+      g_object_unref (cache->layout);
+      cache->layout = NULL;
+    }
+
+  if (cache->material)
+    {
+      cogl_handle_unref (cache->material);
+      cache->material = NULL;
+    }
+}
+
 static void
-stylable_destroy_text_shadow (MxTextShadow *text_shadow)
+stylable_destroy_text_shadow (MxTextShadowCache *cache)
 {
-  g_boxed_free (MX_TYPE_TEXT_SHADOW, text_shadow);
+  stylable_text_shadow_cache_clear (cache);
+  g_slice_free (MxTextShadowCache, cache);
 }
 
+/* One horizontal and one vertical box blur pass over an A8 buffer, treating
+ * the pixels outside of the buffer as transparent.
+ */
 static void
-stylable_text_shadow_paint (ClutterText  *text,
-                            MxTextShadow *text_shadow)
+stylable_text_shadow_box_blur (guchar *data,
+                               guchar *scratch,
+                               gint    width,
+                               gint    height,
+                               gint    stride,
+                               gint    radius)
+{
+  gint x, y, sum, size = radius * 2 + 1;
+
+  for (y = 0; y < height; y++)
+    {
+      guchar *row = data + y * stride;
+
+      for (x = 0, sum = 0; x < width + radius; x++)
+        {
+          if (x < width)
+            sum += row[x];
+          if (x >= size)
+            sum -= row[x - size];
+          if (x >= radius)
+            scratch[x - radius] = sum / size;
+        }
+
+      memcpy (row, scratch, width);
+    }
+
+  for (x = 0; x < width; x++)
+    {
+      for (y = 0, sum = 0; y < height + radius; y++)
+        {
+          if (y < height)
+            sum += data[y * stride + x];
+          if (y >= size)
+            sum -= data[(y - size) * stride + x];
+          if (y >= radius)
+            scratch[y - radius] = sum / size;
+        }
+
+      for (y = 0; y < height; y++)
+        data[y * stride + x] = scratch[y];
+    }
+}
+
+static void
+stylable_text_shadow_render (MxTextShadowCache *cache,
+                             PangoLayout       *layout)
+{
+  PangoRectangle ink;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  CoglHandle texture;
+  gint width, height, stride, padding, radius;
+
+  stylable_text_shadow_cache_clear (cache);
+  cache->layout = g_object_ref (layout);
+
+  pango_layout_get_pixel_extents (layout, &ink, NULL);
+  if (ink.width <= 0 || ink.height <= 0)
+    return;
+
+  /* three box blurs approximate a gaussian with a standard deviation of
+   * half the blur radius, which is how CSS defines the blur.
+   */
+  radius = MAX (0, (gint) (cache->shadow.blur / 2));
+  padding = radius * 3;
+
+  width = ink.width + padding * 2;
+  height = ink.height + padding * 2;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_A8, width, height);
+  cr = cairo_create (surface);
+  cairo_translate (cr, padding - ink.x, padding - ink.y);
+  pango_cairo_show_layout (cr, layout);
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+
+  stride = cairo_image_surface_get_stride (surface);
+
+  if (radius > 0)
+    {
+      guchar *data = cairo_image_surface_get_data (surface);
+      guchar *scratch = g_malloc (MAX (width, height));
+      gint i;
+
+      for (i = 0; i < 3; i++)
+        stylable_text_shadow_box_blur (data, scratch, width, height, stride,
+                                       radius);
+
+      g_free (scratch);
+    }
+
+  texture = cogl_texture_new_from_data (width, height,
+                                        COGL_TEXTURE_NO_SLICING,
+                                        COGL_PIXEL_FORMAT_A_8,
+                                        COGL_PIXEL_FORMAT_A_8,
+                                        stride,
+                                        cairo_image_surface_get_data (surface));
+  cairo_surface_destroy (surface);
+
+  if (texture == COGL_INVALID_HANDLE)
+    return;
+
+  cache->material = cogl_material_new ();
+  cogl_material_set_layer (cache->material, 0, texture);
+  cogl_material_set_layer_combine (cache->material, 0,
+                                   "RGBA = MODULATE (PRIMARY, TEXTURE[A])",
+                                   NULL);
+  cogl_handle_unref (texture);
+
+  cache->x = ink.x - padding;
+  cache->y = ink.y - padding;
+  cache->width = width;
+  cache->height = height;
+}
+
+static void
+stylable_text_shadow_paint (ClutterText       *text,
+                            MxTextShadowCache *cache)
 {
   PangoLayout *layout;
   CoglColor color;
-  ClutterActorBox box;
+  gfloat x, y;
 
-  cogl_color_init_from_4ub (&color,
-                            text_shadow->color.red,
-                            text_shadow->color.green,
-                            text_shadow->color.blue,
-                            text_shadow->color.alpha);
-
-  /* pango layout */
+  /* pango layout; ClutterText creates a new layout whenever its contents
+   * or its size change, so the layout identifies the rendered shadow.
+   */
   layout = clutter_text_get_layout (text);
+  if (!layout)
+    return;
+
+  if (layout != cache->layout)
+    stylable_text_shadow_render (cache, layout);
+
+  if (!cache->material)
+    return;
 
+  cogl_color_init_from_4ub (&color,
+                            cache->shadow.color.red,
+                            cache->shadow.color.green,
+                            cache->shadow.color.blue,
+                            cache->shadow.color.alpha *
+                            clutter_actor_get_paint_opacity (CLUTTER_ACTOR (text))
+                            / 255);
+  cogl_color_premultiply (&color);
+  cogl_material_set_color (cache->material, &color);
 
   /* shadow position */
-  clutter_actor_get_allocation_box (CLUTTER_ACTOR (text), &box);
+  x = cache->x + cache->shadow.h_offset;
+  y = cache->y + cache->shadow.v_offset;
 
-  cogl_pango_render_layout (layout,text_shadow->h_offset,
-                            text_shadow->v_offset, &color, 0);
+  cogl_set_source (cache->material);
+  cogl_rectangle (x, y, x + cache->width, y + cache->height);
+}
+
+/* The font properties last applied to a ClutterText */
+typedef struct
+{
+  gchar        *font_family;
+  gchar        *font_name;
+  gint          font_size;
+  MxFontWeight  font_weight;
+} MxTextFontCache;
+
+static void
+stylable_text_font_cache_free (MxTextFontCache *cache)
+{
+  g_free (cache->font_family);
+  g_free (cache->font_name);
+  g_slice_free (MxTextFontCache, cache);
 }
 
 void
@@ -1198,15 +1428,21 @@ mx_stylable_apply_clutter_text_attributes (MxStylable  *stylable,
   PangoFontDescription *descr;
   gchar *descr_string;
   MxTextShadow *text_shadow;
-  MxTextShadow *old_text_shadow;
+  MxTextShadowCache *old_text_shadow;
   MxTextAlign text_align;
   PangoAlignment pango_align;
+  MxTextFontCache *font_cache;
+  ClutterColor old_color;
 
   static GQuark stylable_text_shadow_quark = 0;
+  static GQuark stylable_text_font_quark = 0;
 
   if (!stylable_text_shadow_quark)
    stylable_text_shadow_quark = g_quark_from_static_string ("stylable-text-shadow");
 
+  if (!stylable_text_font_quark)
+   stylable_text_font_quark = g_quark_from_static_string ("stylable-text-font");
+
 
   mx_stylable_get (stylable,
                    "color", &real_color,
@@ -1225,19 +1461,27 @@ mx_stylable_apply_clutter_text_attributes (MxStylable  *stylable,
     {
       if (!old_text_shadow)
         {
+          old_text_shadow = g_slice_new0 (MxTextShadowCache);
+          old_text_shadow->shadow = *text_shadow;
+
           g_signal_connect (text, "paint",
                             G_CALLBACK (stylable_text_shadow_paint),
-                            text_shadow);
+                            old_text_shadow);
 
           g_object_set_qdata_full (G_OBJECT (text), stylable_text_shadow_quark,
-                                   text_shadow,
+                                   old_text_shadow,
                                    (GDestroyNotify) stylable_destroy_text_shadow);
         }
       else
         {
-          *old_text_shadow = *text_shadow;
-          g_boxed_free (MX_TYPE_TEXT_SHADOW, text_shadow);
+          /* only a new blur radius needs the shadow rendering again */
+          if (old_text_shadow->shadow.blur != text_shadow->blur)
+            stylable_text_shadow_cache_clear (old_text_shadow);
+
+          old_text_shadow->shadow = *text_shadow;
         }
+
+      g_boxed_free (MX_TYPE_TEXT_SHADOW, text_shadow);
     }
   else
     {
@@ -1250,35 +1494,70 @@ mx_stylable_apply_clutter_text_attributes (MxStylable  *stylable,
         }
     }
 
-  /* Create a description, we will convert to a string and set on the
-   * ClutterText. When Clutter gets API to set the description directly this
-   * won't be necessary. */
-  descr = pango_font_description_new ();
+  /* Only build a new font description when the font properties differ
+   * from the ones last applied, and the ClutterText still has that font.
+   * Setting the font name invalidates the layout and queues a relayout.
+   */
+  font_cache = g_object_get_qdata (G_OBJECT (text), stylable_text_font_quark);
+  if (!font_cache)
+    {
+      font_cache = g_slice_new0 (MxTextFontCache);
+      g_object_set_qdata_full (G_OBJECT (text), stylable_text_font_quark,
+                               font_cache,
+                               (GDestroyNotify) stylable_text_font_cache_free);
+    }
+
+  if (!font_cache->font_name ||
+      font_cache->font_size != font_size ||
+      font_cache->font_weight != font_weight ||
+      g_strcmp0 (font_cache->font_family, font_name) ||
+      g_strcmp0 (font_cache->font_name, clutter_text_get_font_name (text)))
+    {
+      /* Create a description, we will convert to a string and set on the
+       * ClutterText. When Clutter gets API to set the description directly
+       * this won't be necessary. */
+      descr = pango_font_description_new ();
 
-  /* font name */
-  pango_font_description_set_family (descr, font_name);
-  g_free (font_name);
+      /* font name */
+      pango_font_description_set_family (descr, font_name);
 
-  /* font size */
-  pango_font_description_set_absolute_size (descr, font_size * PANGO_SCALE);
+      /* font size */
+      pango_font_description_set_absolute_size (descr,
+                                                font_size * PANGO_SCALE);
 
-  /* font weight */
-  switch (font_weight)
-    {
-  case MX_FONT_WEIGHT_BOLD:
-    weight = PANGO_WEIGHT_BOLD;
-    break;
-  case MX_FONT_WEIGHT_LIGHTER:
-    weight = PANGO_WEIGHT_LIGHT;
-    break;
-  case MX_FONT_WEIGHT_BOLDER:
-    weight = PANGO_WEIGHT_HEAVY;
-    break;
-  default:
-    weight = PANGO_WEIGHT_NORMAL;
-    break;
+      /* font weight */
+      switch (font_weight)
+        {
+        case MX_FONT_WEIGHT_BOLD:
+          weight = PANGO_WEIGHT_BOLD;
+          break;
+        case MX_FONT_WEIGHT_LIGHTER:
+          weight = PANGO_WEIGHT_LIGHT;
+          break;
+        case MX_FONT_WEIGHT_BOLDER:
+          weight = PANGO_WEIGHT_HEAVY;
+          break;
+        default:
+          weight = PANGO_WEIGHT_NORMAL;
+          break;
+        }
+      pango_font_description_set_weight (descr, weight);
+
+      descr_string = pango_font_description_to_string (descr);
+      pango_font_description_free (descr);
+
+      if (g_strcmp0 (descr_string, clutter_text_get_font_name (text)))
+        clutter_text_set_font_name (text, descr_string);
+
+      g_free (font_cache->font_family);
+      g_free (font_cache->font_name);
+      font_cache->font_family = font_name;
+      font_cache->font_name = descr_string;
+      font_cache->font_size = font_size;
+      font_cache->font_weight = font_weight;
     }
-  pango_font_description_set_weight (descr, weight);
+  else
+    g_free (font_name);
 
   switch (text_align)
     {
@@ -1293,18 +1572,19 @@ mx_stylable_apply_clutter_text_attributes (MxStylable  *stylable,
       pango_align = PANGO_ALIGN_CENTER;
       break;
     }
-  clutter_text_set_line_alignment (text, pango_align);
-  clutter_text_set_justify (text, (text_align == MX_TEXT_ALIGN_JUSTIFY));
 
-  descr_string = pango_font_description_to_string (descr);
-  clutter_text_set_font_name (text, descr_string);
-  g_free (descr_string);
-  pango_font_description_free (descr);
+  if (clutter_text_get_line_alignment (text) != pango_align)
+    clutter_text_set_line_alignment (text, pango_align);
+
+  if (clutter_text_get_justify (text) != (text_align == MX_TEXT_ALIGN_JUSTIFY))
+    clutter_text_set_justify (text, (text_align == MX_TEXT_ALIGN_JUSTIFY));
 
   /* font color */
   if (real_color)
     {
-      clutter_text_set_color (text, real_color);
+      clutter_text_get_color (text, &old_color);
+      if (!clutter_color_equal (&old_color, real_color))
+        clutter_text_set_color (text, real_color);
       clutter_color_free (real_color);
     }
 }
@@ -83,6 +83,7 @@ typedef struct
 {
   guint expand : 1;
   guint is_visible : 1;
+  guint dirty : 1;
 
   gfloat min_size;
   gfloat pref_size;
@@ -94,6 +95,8 @@ struct _MxTablePrivate
 {
   guint   ignore_css_col_spacing : 1;
   guint   ignore_css_row_spacing : 1;
+  guint   columns_solved : 1;
+  guint   rows_solved : 1;
   gint    col_spacing;
   gint    row_spacing;
 
@@ -109,6 +112,14 @@ struct _MxTablePrivate
   GArray *columns;
   GArray *rows;
 
+  /* the requests of the non-spanning children in each column and row,
+   * only recalculated for the columns and rows marked as dirty */
+  GArray *column_requests;
+  GArray *row_requests;
+
+  gint    columns_solved_for;
+  gint    rows_solved_for;
+
   MxFocusable *last_focus;
 };
 
@@ -149,6 +160,14 @@ mx_table_find_actor_at (MxTable *table,
   return NULL;
 }
 
+/* Used by MxFocusManager when it gives the focus to a child directly */
+void
+_mx_table_set_last_focus (MxTable     *table,
+                          MxFocusable *focusable)
+{
+  table->priv->last_focus = focusable;
+}
+
 static MxFocusable*
 mx_table_move_focus (MxFocusable      *focusable,
                      MxFocusDirection  direction,
@@ -428,6 +447,40 @@ mx_focusable_iface_init (MxFocusableIface *iface)
 /*
  * ClutterContainer Implementation
  */
+static void
+mx_table_child_queue_relayout_cb (ClutterActor *actor,
+                                  MxTable      *table)
+{
+  MxTableChild *meta;
+
+  meta = (MxTableChild *) clutter_container_get_child_meta (CLUTTER_CONTAINER (table),
+                                                            actor);
+
+  /* the child (or one of its descendants) has changed size, so its cached
+   * size requests can no longer be used */
+  if (meta)
+    {
+      meta->width_valid = FALSE;
+      meta->height_valid = FALSE;
+    }
+}
+
+static void
+mx_table_invalidate_requests (MxTable *table)
+{
+  MxTablePrivate *priv = table->priv;
+  guint i;
+
+  for (i = 0; i < priv->column_requests->len; i++)
+    g_array_index (priv->column_requests, DimensionData, i).dirty = TRUE;
+
+  for (i = 0; i < priv->row_requests->len; i++)
+    g_array_index (priv->row_requests, DimensionData, i).dirty = TRUE;
+
+  priv->columns_solved = FALSE;
+  priv->rows_solved = FALSE;
+}
+
 static void
 mx_table_actor_added (ClutterContainer *container,
                       ClutterActor     *actor)
@@ -439,6 +492,9 @@ mx_table_actor_added (ClutterContainer *container,
   /* default position of the actor is 0, 0 */
   _mx_table_update_row_col (MX_TABLE (container), meta);
 
+  g_signal_connect (actor, "queue-relayout",
+                    G_CALLBACK (mx_table_child_queue_relayout_cb), container);
+
   clutter_actor_queue_relayout (CLUTTER_ACTOR (container));
 }
 
@@ -455,6 +511,13 @@ mx_table_actor_removed (ClutterContainer *container,
   if ((ClutterActor *)priv->last_focus == actor)
     priv->last_focus = NULL;
 
+  g_signal_handlers_disconnect_by_func (actor,
+                                        mx_table_child_queue_relayout_cb,
+                                        container);
+
+  /* the cells the child occupied need to be re-solved */
+  mx_table_invalidate_requests (MX_TABLE (container));
+
   /* update row/column count */
   rows = 0;
   cols = 0;
@@ -574,43 +637,130 @@ mx_table_finalize (GObject *gobject)
 
   g_array_free (priv->columns, TRUE);
   g_array_free (priv->rows, TRUE);
+  g_array_free (priv->column_requests, TRUE);
+  g_array_free (priv->row_requests, TRUE);
 
   G_OBJECT_CLASS (mx_table_parent_class)->finalize (gobject);
 }
 
 static void
-mx_table_calculate_col_widths (MxTable *table,
-                               gint     for_width)
+mx_table_mark_dirty (GArray *requests,
+                     gint    index)
+{
+  if (index >= 0 && (guint) index < requests->len)
+    g_array_index (requests, DimensionData, index).dirty = TRUE;
+}
+
+static gboolean
+mx_table_resize_requests (GArray *requests,
+                          gint    size)
 {
   gint i;
+
+  if (requests->len == (guint) size)
+    return FALSE;
+
+  g_array_set_size (requests, size);
+  for (i = 0; i < size; i++)
+    g_array_index (requests, DimensionData, i).dirty = TRUE;
+
+  return TRUE;
+}
+
+/* Updates the cached width requests of the children and recalculates the
+ * requests of the dirty columns. Returns %TRUE if anything changed since the
+ * last call.
+ */
+static gboolean
+mx_table_update_column_requests (MxTable *table)
+{
   MxTablePrivate *priv = table->priv;
-  DimensionData *columns;
-  MxPadding padding;
+  DimensionData *requests;
   ClutterActorIter iter;
   ClutterActor *child;
+  gboolean changed;
+  gint i;
 
-  g_array_set_size (priv->columns, 0);
-  g_array_set_size (priv->columns, priv->n_cols);
-  columns = &g_array_index (priv->columns, DimensionData, 0);
+  /* measure any labels in parallel before requesting their sizes */
+  _mx_label_measure_children (CLUTTER_ACTOR (table));
 
+  changed = mx_table_resize_requests (priv->column_requests, priv->n_cols);
 
-  /* take off the padding values to calculate the allocatable width */
-  mx_widget_get_padding (MX_WIDGET (table), &padding);
+  /* PASS ONE: find the children that have changed and mark the columns they
+   * were and are now in as dirty */
+  clutter_actor_iter_init (&iter, CLUTTER_ACTOR (table));
+  while (clutter_actor_iter_next (&iter, &child))
+    {
+      MxTableChild *meta;
+      gboolean visible, child_changed;
 
-  for_width -= (int)(padding.left + padding.right);
+      meta = (MxTableChild *)
+        clutter_container_get_child_meta (CLUTTER_CONTAINER (table), child);
+
+      visible = CLUTTER_ACTOR_IS_VISIBLE (child) ? TRUE : FALSE;
+      child_changed = FALSE;
+
+      if (!meta->col_cache_valid ||
+          meta->cached_col != meta->col ||
+          meta->cached_col_span != meta->col_span ||
+          meta->cached_x_expand != meta->x_expand ||
+          meta->cached_col_visible != visible)
+        {
+          if (meta->col_cache_valid && meta->cached_col_visible &&
+              meta->cached_col_span == 1)
+            mx_table_mark_dirty (priv->column_requests, meta->cached_col);
+
+          meta->col_cache_valid = TRUE;
+          meta->cached_col = meta->col;
+          meta->cached_col_span = meta->col_span;
+          meta->cached_x_expand = meta->x_expand;
+          meta->cached_col_visible = visible;
+
+          child_changed = TRUE;
+        }
+
+      if (visible && !meta->width_valid)
+        {
+          clutter_actor_get_preferred_width (child, -1, &meta->min_width,
+                                             &meta->pref_width);
+          meta->width_valid = TRUE;
+
+          child_changed = TRUE;
+        }
+
+      if (child_changed)
+        {
+          changed = TRUE;
+
+          if (visible && meta->col_span == 1)
+            mx_table_mark_dirty (priv->column_requests, meta->col);
+        }
+    }
+
+  /* PASS TWO: recalculate the dirty columns from the cached requests */
+  requests = &g_array_index (priv->column_requests, DimensionData, 0);
+
+  /* columns may also have been invalidated by a child being removed */
+  for (i = 0; !changed && i < priv->n_cols; i++)
+    changed = requests[i].dirty;
+
+  if (!changed)
+    return FALSE;
 
-  /* Reset all the visible attributes for the columns */
-  priv->visible_cols = 0;
   for (i = 0; i < priv->n_cols; i++)
-    columns[i].is_visible = FALSE;
+    {
+      if (requests[i].dirty)
+        {
+          memset (&requests[i], 0, sizeof (DimensionData));
+          requests[i].dirty = TRUE;
+        }
+    }
 
-  /* STAGE ONE: calculate column widths for non-spanned children */
   clutter_actor_iter_init (&iter, CLUTTER_ACTOR (table));
   while (clutter_actor_iter_next (&iter, &child))
     {
       MxTableChild *meta;
       DimensionData *col;
-      gfloat c_min, c_pref;
 
       if (!CLUTTER_ACTOR_IS_VISIBLE (child))
         continue;
@@ -621,22 +771,59 @@ mx_table_calculate_col_widths (MxTable *table,
       if (meta->col_span > 1)
         continue;
 
-      col = &columns[meta->col];
+      col = &requests[meta->col];
 
-      /* If this child is visible, then its column is visible */
-      if (!col->is_visible)
-        {
-          col->is_visible = TRUE;
-          priv->visible_cols++;
-        }
+      if (!col->dirty)
+        continue;
 
-      clutter_actor_get_preferred_width (child, -1, &c_min, &c_pref);
+      /* If this child is visible, then its column is visible */
+      col->is_visible = TRUE;
 
-      col->min_size = MAX (col->min_size, c_min);
-      col->final_size = col->pref_size = MAX (col->pref_size, c_pref);
+      col->min_size = MAX (col->min_size, meta->min_width);
+      col->final_size = col->pref_size = MAX (col->pref_size, meta->pref_width);
       col->expand = MAX (col->expand, meta->x_expand);
     }
 
+  for (i = 0; i < priv->n_cols; i++)
+    requests[i].dirty = FALSE;
+
+  return TRUE;
+}
+
+static void
+mx_table_calculate_col_widths (MxTable *table,
+                               gint     for_width)
+{
+  gint i;
+  MxTablePrivate *priv = table->priv;
+  DimensionData *columns;
+  MxPadding padding;
+  ClutterActorIter iter;
+  ClutterActor *child;
+  gboolean changed;
+
+  /* STAGE ONE: calculate column widths for non-spanned children */
+  changed = mx_table_update_column_requests (table);
+
+  /* take off the padding values to calculate the allocatable width */
+  mx_widget_get_padding (MX_WIDGET (table), &padding);
+
+  for_width -= (int)(padding.left + padding.right);
+
+  /* nothing to do if the columns have already been solved for this width */
+  if (!changed && priv->columns_solved && priv->columns_solved_for == for_width)
+    return;
+
+  priv->columns_solved = TRUE;
+  priv->columns_solved_for = for_width;
+
+  g_array_set_size (priv->columns, priv->n_cols);
+  columns = &g_array_index (priv->columns, DimensionData, 0);
+
+  if (priv->n_cols > 0)
+    memcpy (columns, priv->column_requests->data,
+            priv->n_cols * sizeof (DimensionData));
+
   /* STAGE TWO: take spanning children into account */
   clutter_actor_iter_init (&iter, CLUTTER_ACTOR (table));
   while (clutter_actor_iter_next (&iter, &child))
@@ -659,7 +846,8 @@ mx_table_calculate_col_widths (MxTable *table,
       start_col = meta->col;
       end_col = meta->col + meta->col_span - 1;
 
-      clutter_actor_get_preferred_width (child, -1, &c_min, &c_pref);
+      c_min = meta->min_width;
+      c_pref = meta->pref_width;
 
 
       /* check there is enough room for this actor */
@@ -678,11 +866,7 @@ mx_table_calculate_col_widths (MxTable *table,
 
           /* If this child is visible, then the columns it spans
              are also visible */
-          if (!columns[i].is_visible)
-            {
-              columns[i].is_visible = TRUE;
-              priv->visible_cols++;
-            }
+          columns[i].is_visible = TRUE;
           columns[i].expand = MAX (columns[i].expand, meta->x_expand);
         }
       min_width += priv->col_spacing * (meta->col_span - 1);
@@ -749,6 +933,12 @@ mx_table_calculate_col_widths (MxTable *table,
 
     }
 
+  priv->visible_cols = 0;
+  for (i = 0; i < priv->n_cols; i++)
+    {
+      if (columns[i].is_visible)
+        priv->visible_cols++;
+    }
 
   /* calculate final widths */
   if (for_width >= 0)
@@ -861,40 +1051,103 @@ mx_table_calculate_col_widths (MxTable *table,
 
 }
 
-static void
-mx_table_calculate_row_heights (MxTable *table,
-                                gint     for_height)
+/* Updates the cached height requests of the children and recalculates the
+ * requests of the dirty rows. The height requests depend on the column
+ * widths, so this must be called after the columns have been solved.
+ */
+static gboolean
+mx_table_update_row_requests (MxTable *table)
 {
-  MxTablePrivate *priv = MX_TABLE (table)->priv;
-  gint i;
-  DimensionData *rows, *columns;
-  MxPadding padding;
+  MxTablePrivate *priv = table->priv;
+  DimensionData *requests, *columns;
   ClutterActorIter iter;
   ClutterActor *child;
+  gboolean changed;
+  gint i;
 
-  mx_widget_get_padding (MX_WIDGET (table), &padding);
+  changed = mx_table_resize_requests (priv->row_requests, priv->n_rows);
 
-  /* take padding off available height */
-  for_height -= (int)(padding.top + padding.bottom);
+  columns = &g_array_index (priv->columns, DimensionData, 0);
 
-  g_array_set_size (priv->rows, 0);
-  g_array_set_size (priv->rows, priv->n_rows);
-  rows = &g_array_index (priv->rows, DimensionData, 0);
+  /* PASS ONE: find the children that have changed, or whose column width
+   * has changed, and mark the rows they were and are now in as dirty */
+  clutter_actor_iter_init (&iter, CLUTTER_ACTOR (table));
+  while (clutter_actor_iter_next (&iter, &child))
+    {
+      MxTableChild *meta;
+      gboolean visible, child_changed;
 
-  columns = &g_array_index (priv->columns, DimensionData, 0);
+      meta = (MxTableChild *)
+        clutter_container_get_child_meta (CLUTTER_CONTAINER (table), child);
+
+      visible = CLUTTER_ACTOR_IS_VISIBLE (child) ? TRUE : FALSE;
+      child_changed = FALSE;
+
+      if (!meta->row_cache_valid ||
+          meta->cached_row != meta->row ||
+          meta->cached_row_span != meta->row_span ||
+          meta->cached_y_expand != meta->y_expand ||
+          meta->cached_row_visible != visible)
+        {
+          if (meta->row_cache_valid && meta->cached_row_visible &&
+              meta->cached_row_span == 1)
+            mx_table_mark_dirty (priv->row_requests, meta->cached_row);
+
+          meta->row_cache_valid = TRUE;
+          meta->cached_row = meta->row;
+          meta->cached_row_span = meta->row_span;
+          meta->cached_y_expand = meta->y_expand;
+          meta->cached_row_visible = visible;
+
+          child_changed = TRUE;
+        }
+
+      if (visible &&
+          (!meta->height_valid ||
+           meta->height_for_width != columns[meta->col].final_size))
+        {
+          meta->height_for_width = columns[meta->col].final_size;
+          clutter_actor_get_preferred_height (child, meta->height_for_width,
+                                              &meta->min_height,
+                                              &meta->pref_height);
+          meta->height_valid = TRUE;
+
+          child_changed = TRUE;
+        }
+
+      if (child_changed)
+        {
+          changed = TRUE;
+
+          if (visible && meta->row_span == 1)
+            mx_table_mark_dirty (priv->row_requests, meta->row);
+        }
+    }
+
+  /* PASS TWO: recalculate the dirty rows from the cached requests */
+  requests = &g_array_index (priv->row_requests, DimensionData, 0);
+
+  /* rows may also have been invalidated by a child being removed */
+  for (i = 0; !changed && i < priv->n_rows; i++)
+    changed = requests[i].dirty;
+
+  if (!changed)
+    return FALSE;
 
-  /* Reset the visible rows */
-  priv->visible_rows = 0;
   for (i = 0; i < priv->n_rows; i++)
-    rows[i].is_visible = FALSE;
+    {
+      if (requests[i].dirty)
+        {
+          memset (&requests[i], 0, sizeof (DimensionData));
+          requests[i].dirty = TRUE;
+        }
+    }
 
-  /* STAGE ONE: calculate row heights for non-spanned children */
   clutter_actor_iter_init (&iter, CLUTTER_ACTOR (table));
   while (clutter_actor_iter_next (&iter, &child))
     {
       MxTableChild *meta;
       DimensionData *row;
-      gfloat c_min, c_pref;
 
       if (!CLUTTER_ACTOR_IS_VISIBLE (child))
         continue;
@@ -905,24 +1158,58 @@ mx_table_calculate_row_heights (MxTable *table,
       if (meta->row_span > 1)
         continue;
 
-      row = &rows[meta->row];
+      row = &requests[meta->row];
 
-      /* If this child is visible, then its row is visible */
-      if (!row->is_visible)
-        {
-          row->is_visible = TRUE;
-          priv->visible_rows++;
-        }
+      if (!row->dirty)
+        continue;
 
-      clutter_actor_get_preferred_height (child, columns[meta->col].final_size,
-                                          &c_min, &c_pref);
+      /* If this child is visible, then its row is visible */
+      row->is_visible = TRUE;
 
-      row->min_size = MAX (row->min_size, c_min);
-      row->final_size = row->pref_size = MAX (row->pref_size, c_pref);
+      row->min_size = MAX (row->min_size, meta->min_height);
+      row->final_size = row->pref_size = MAX (row->pref_size, meta->pref_height);
       row->expand = MAX (row->expand, meta->y_expand);
     }
 
+  for (i = 0; i < priv->n_rows; i++)
+    requests[i].dirty = FALSE;
+
+  return TRUE;
+}
+
+static void
+mx_table_calculate_row_heights (MxTable *table,
+                                gint     for_height)
+{
+  MxTablePrivate *priv = MX_TABLE (table)->priv;
+  gint i;
+  DimensionData *rows;
+  MxPadding padding;
+  ClutterActorIter iter;
+  ClutterActor *child;
+  gboolean changed;
+
+  /* STAGE ONE: calculate row heights for non-spanned children */
+  changed = mx_table_update_row_requests (table);
+
+  mx_widget_get_padding (MX_WIDGET (table), &padding);
+
+  /* take padding off available height */
+  for_height -= (int)(padding.top + padding.bottom);
 
+  /* nothing to do if the rows have already been solved for this height */
+  if (!changed && priv->rows_solved && priv->rows_solved_for == for_height)
+    return;
+
+  priv->rows_solved = TRUE;
+  priv->rows_solved_for = for_height;
+
+  g_array_set_size (priv->rows, priv->n_rows);
+  rows = &g_array_index (priv->rows, DimensionData, 0);
+
+  if (priv->n_rows > 0)
+    memcpy (rows, priv->row_requests->data,
+            priv->n_rows * sizeof (DimensionData));
 
   /* STAGE TWO: take spanning children into account */
   clutter_actor_iter_init (&iter, CLUTTER_ACTOR (table));
@@ -946,8 +1233,8 @@ mx_table_calculate_row_heights (MxTable *table,
       start_row = meta->row;
       end_row = meta->row + meta->row_span - 1;
 
-      clutter_actor_get_preferred_height (child, columns[meta->col].final_size,
-                                         &c_min, &c_pref);
+      c_min = meta->min_height;
+      c_pref = meta->pref_height;
 
 
       /* check there is enough room for this actor */
@@ -965,11 +1252,7 @@ mx_table_calculate_row_heights (MxTable *table,
             }
 
           /* If this actor is visible, then all the rows is spans are visible */
-          if (!rows[i].is_visible)
-            {
-              rows[i].is_visible = TRUE;
-              priv->visible_rows++;
-            }
+          rows[i].is_visible = TRUE;
           rows[i].expand = MAX (rows[i].expand, meta->y_expand);
         }
       min_height += priv->row_spacing * (meta->row_span - 1);
@@ -1045,6 +1328,12 @@ mx_table_calculate_row_heights (MxTable *table,
 
     }
 
+  priv->visible_rows = 0;
+  for (i = 0; i < priv->n_rows; i++)
+    {
+      if (rows[i].is_visible)
+        priv->visible_rows++;
+    }
 
   /* calculate final heights */
   if (for_height >= 0)
@@ -1558,6 +1847,9 @@ mx_table_style_changed (MxWidget *widget,
 
   if (!priv->ignore_css_row_spacing)
     priv->row_spacing = row_spacing;
+
+  priv->columns_solved = FALSE;
+  priv->rows_solved = FALSE;
 }
 
 static void
@@ -1570,6 +1862,10 @@ mx_table_init (MxTable *table)
 
   table->priv->columns = g_array_new (FALSE, TRUE, sizeof (DimensionData));
   table->priv->rows = g_array_new (FALSE, TRUE, sizeof (DimensionData));
+  table->priv->column_requests = g_array_new (FALSE, TRUE,
+                                              sizeof (DimensionData));
+  table->priv->row_requests = g_array_new (FALSE, TRUE,
+                                           sizeof (DimensionData));
 
   g_signal_connect (table, "style-changed",
                     G_CALLBACK (mx_table_style_changed), NULL);
@@ -1625,6 +1921,8 @@ mx_table_set_column_spacing (MxTable *table,
       priv->col_spacing = spacing;
 
       priv->ignore_css_col_spacing = TRUE;
+      priv->columns_solved = FALSE;
+      priv->rows_solved = FALSE;
 
       clutter_actor_queue_relayout (CLUTTER_ACTOR (table));
 
@@ -1655,6 +1953,7 @@ mx_table_set_row_spacing (MxTable *table,
       priv->row_spacing = spacing;
 
       priv->ignore_css_row_spacing = TRUE;
+      priv->rows_solved = FALSE;
 
       clutter_actor_queue_relayout (CLUTTER_ACTOR (table));
 
@@ -38,11 +38,158 @@
 #include "mx-texture-frame.h"
 #include "mx-private.h"
 
-static CoglMaterial *template_material = NULL;
+/* Materials are cached per texture, so that every frame painted with the
+ * same texture uses the same material. Cogl's journal batches consecutive
+ * rectangles that share a material into a single draw call, so a screen of
+ * widgets with the same border image is drawn in a handful of calls, and
+ * nothing is allocated per paint.
+ *
+ * Opaque paints use a material whose colour never changes. Translucent
+ * paints share a second material that is recoloured when the opacity
+ * changes; modifying a material that is already in the journal flushes it,
+ * so this only costs batching while widgets are fading.
+ *
+ * The materials reference their texture, so the widgets that paint through
+ * the cache drop a texture's entries when they release it. Entries that have
+ * not been used for a while are also dropped, for textures painted with the
+ * public mx_texture_frame_paint_texture().
+ */
+#define MX_TEXTURE_FRAME_CACHE_SWEEP_FRAMES 300
+
+typedef struct
+{
+  CoglHandle opaque;
+  CoglHandle translucent;
+  guint8     translucent_opacity;
+  guint      last_used;
+} MxTextureFrameMaterials;
+
+static GHashTable *material_cache = NULL;
+static guint       material_cache_frame = 0;
+
+static void
+mx_texture_frame_materials_free (MxTextureFrameMaterials *materials)
+{
+  if (materials->opaque)
+    cogl_handle_unref (materials->opaque);
+
+  if (materials->translucent)
+    cogl_handle_unref (materials->translucent);
+
+  g_slice_free (MxTextureFrameMaterials, materials);
+}
+
+static gboolean
+mx_texture_frame_materials_unused (gpointer                 texture,
+                                   MxTextureFrameMaterials *materials,
+                                   gpointer                 data)
+{
+  return (material_cache_frame - materials->last_used >
+          MX_TEXTURE_FRAME_CACHE_SWEEP_FRAMES);
+}
+
+static gboolean
+mx_texture_frame_cache_sweep_cb (gpointer data)
+{
+  material_cache_frame++;
+
+  if (material_cache_frame % MX_TEXTURE_FRAME_CACHE_SWEEP_FRAMES == 0)
+    g_hash_table_foreach_remove (material_cache,
+                                 (GHRFunc) mx_texture_frame_materials_unused,
+                                 NULL);
+
+  return TRUE;
+}
+
+/*
+ * _mx_texture_frame_release_material:
+ * @texture: a texture
+ *
+ * Drops the cached materials of @texture, which hold a reference on it.
+ * This is called by the owners of textures painted through the cache when
+ * they let go of them; if the texture is still painted elsewhere, its
+ * materials are simply created again.
+ */
+void
+_mx_texture_frame_release_material (CoglHandle texture)
+{
+  if (material_cache)
+    g_hash_table_remove (material_cache, texture);
+}
+
+static CoglHandle
+mx_texture_frame_material_new (CoglHandle texture,
+                               guint8     opacity)
+{
+  CoglHandle material;
+
+  material = cogl_material_new ();
+  cogl_material_set_color4ub (material, opacity, opacity, opacity, opacity);
+  cogl_material_set_layer (material, 0, texture);
+
+  return material;
+}
+
+/*
+ * _mx_texture_frame_get_material:
+ * @texture: a texture
+ * @opacity: the paint opacity
+ *
+ * Gets a material that paints @texture at @opacity. The material is owned
+ * by the cache and is only valid until the next call.
+ */
+CoglHandle
+_mx_texture_frame_get_material (CoglHandle texture,
+                                guint8     opacity)
+{
+  MxTextureFrameMaterials *materials;
+
+  if (G_UNLIKELY (!material_cache))
+    {
+      material_cache =
+        g_hash_table_new_full (NULL, NULL, NULL,
+                               (GDestroyNotify) mx_texture_frame_materials_free);
+
+      clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                             mx_texture_frame_cache_sweep_cb,
+                                             NULL, NULL);
+    }
+
+  materials = g_hash_table_lookup (material_cache, texture);
+  if (!materials)
+    {
+      materials = g_slice_new0 (MxTextureFrameMaterials);
+      g_hash_table_insert (material_cache, texture, materials);
+    }
+
+  materials->last_used = material_cache_frame;
+
+  if (opacity == 0xff)
+    {
+      if (!materials->opaque)
+        materials->opaque = mx_texture_frame_material_new (texture, opacity);
+
+      return materials->opaque;
+    }
+
+  if (!materials->translucent)
+    {
+      materials->translucent = mx_texture_frame_material_new (texture,
+                                                              opacity);
+      materials->translucent_opacity = opacity;
+    }
+  else if (materials->translucent_opacity != opacity)
+    {
+      cogl_material_set_color4ub (materials->translucent,
+                                  opacity, opacity, opacity, opacity);
+      materials->translucent_opacity = opacity;
+    }
+
+  return materials->translucent;
+}
 
 static void
-mx_texture_frame_paint_texture_internal (CoglHandle  material,
-                                         CoglHandle  texture,
+mx_texture_frame_paint_texture_internal (CoglHandle  texture,
                                          guint8      opacity,
                                          gfloat      top,
                                          gfloat      right,
@@ -55,14 +202,8 @@ mx_texture_frame_paint_texture_internal (CoglHandle  material,
   gfloat ex, ey;
   gfloat tx1, ty1, tx2, ty2;
 
-  /* apply opacity */
-  cogl_material_set_color4ub (material, opacity, opacity, opacity, opacity);
-
-  /* add the texture */
-  cogl_material_set_layer (material, 0, texture);
-
   /* set the source */
-  cogl_set_source (material);
+  cogl_set_source (_mx_texture_frame_get_material (texture, opacity));
 
   tex_width  = cogl_texture_get_width (texture);
   tex_height = cogl_texture_get_height (texture);
@@ -161,20 +302,9 @@ mx_texture_frame_paint_texture (CoglHandle  texture,
                                 gfloat      width,
                                 gfloat      height)
 {
-  CoglHandle material;
-
-  /* setup the template material */
-  if (!template_material)
-    template_material = cogl_material_new ();
-
-  /* create the material and apply opacity */
-  material = cogl_material_copy (template_material);
-
-  mx_texture_frame_paint_texture_internal (material, texture,
+  mx_texture_frame_paint_texture_internal (texture,
                                            opacity,
                                            top, right,
                                            bottom, left,
                                            width, height);
-
-  cogl_handle_unref (material);
 }
@@ -191,6 +191,7 @@ mx_tooltip_style_changed (MxWidget *self)
 
   if (priv->border_image_texture)
     {
+      _mx_texture_frame_release_material (priv->border_image_texture);
       cogl_handle_unref (priv->border_image_texture);
       priv->border_image_texture = NULL;
     }
@@ -437,6 +438,7 @@ mx_tooltip_dispose (GObject *object)
 
   if (priv->border_image_texture)
     {
+      _mx_texture_frame_release_material (priv->border_image_texture);
       cogl_handle_unref (priv->border_image_texture);
       priv->border_image_texture = NULL;
     }
@@ -0,0 +1,153 @@
+/*
+ * mx-velocity-tracker.c: Pointer velocity estimation
+ *
+ * Copyright 2012 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/*
+ * This is private to MX
+ *
+ * Keeps the last few pointer positions in a fixed size ring buffer, with
+ * timestamps from the monotonic clock, and estimates the velocity of the
+ * pointer with a weighted least-squares line fit over the recent samples.
+ * Unlike the slope between the first and last samples, a single noisy
+ * event only has a small influence on the result.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "mx-velocity-tracker.h"
+
+/* Only samples this recent, in microseconds, are used */
+#define MX_VELOCITY_TRACKER_HORIZON (100 * 1000)
+
+void
+_mx_velocity_tracker_reset (MxVelocityTracker *tracker)
+{
+  tracker->head = 0;
+  tracker->n_samples = 0;
+}
+
+/* @time is in microseconds, from g_get_monotonic_time() */
+void
+_mx_velocity_tracker_add (MxVelocityTracker *tracker,
+                          gfloat             x,
+                          gfloat             y,
+                          gint64             time)
+{
+  MxVelocitySample *sample;
+
+  tracker->head = (tracker->head + 1) % MX_VELOCITY_TRACKER_SIZE;
+  if (tracker->n_samples < MX_VELOCITY_TRACKER_SIZE)
+    tracker->n_samples++;
+
+  sample = &tracker->samples[tracker->head];
+  sample->x = x;
+  sample->y = y;
+  sample->time = time;
+}
+
+gboolean
+_mx_velocity_tracker_get_last (MxVelocityTracker *tracker,
+                               gfloat            *x,
+                               gfloat            *y)
+{
+  MxVelocitySample *sample;
+
+  if (!tracker->n_samples)
+    return FALSE;
+
+  sample = &tracker->samples[tracker->head];
+
+  if (x)
+    *x = sample->x;
+  if (y)
+    *y = sample->y;
+
+  return TRUE;
+}
+
+/* Stores the velocity at the time of the last sample, in units per
+ * second. Returns %FALSE if there weren't enough recent samples, in which
+ * case the velocity is 0. */
+gboolean
+_mx_velocity_tracker_get_velocity (MxVelocityTracker *tracker,
+                                   gfloat            *velocity_x,
+                                   gfloat            *velocity_y)
+{
+  gdouble sw, swt, swtt, swx, swy, swtx, swty, denominator;
+  gint64 now;
+  guint i, used;
+
+  if (velocity_x)
+    *velocity_x = 0;
+  if (velocity_y)
+    *velocity_y = 0;
+
+  if (tracker->n_samples < 2)
+    return FALSE;
+
+  now = tracker->samples[tracker->head].time;
+  sw = swt = swtt = swx = swy = swtx = swty = 0;
+  used = 0;
+
+  /* Fit x = a + v * t, going back from the newest sample. The weights
+   * favour the most recent samples, and times and positions are taken
+   * relative to the newest sample to keep the sums small. */
+  for (i = 0; i < tracker->n_samples; i++)
+    {
+      MxVelocitySample *sample;
+      gdouble t, w, x, y;
+      gint64 age;
+
+      sample = &tracker->samples[(tracker->head + MX_VELOCITY_TRACKER_SIZE - i)
+                                 % MX_VELOCITY_TRACKER_SIZE];
+      age = now - sample->time;
+
+      if (age > MX_VELOCITY_TRACKER_HORIZON || age < 0)
+        break;
+
+      t = -age / (gdouble) G_USEC_PER_SEC;
+      w = 1.0 - age / (2.0 * MX_VELOCITY_TRACKER_HORIZON);
+      x = sample->x - tracker->samples[tracker->head].x;
+      y = sample->y - tracker->samples[tracker->head].y;
+
+      sw += w;
+      swt += w * t;
+      swtt += w * t * t;
+      swx += w * x;
+      swy += w * y;
+      swtx += w * t * x;
+      swty += w * t * y;
+
+      used++;
+    }
+
+  denominator = sw * swtt - swt * swt;
+
+  if (used < 2 || denominator <= 0.0)
+    return FALSE;
+
+  if (velocity_x)
+    *velocity_x = (sw * swtx - swt * swx) / denominator;
+  if (velocity_y)
+    *velocity_y = (sw * swty - swt * swy) / denominator;
+
+  return TRUE;
+}
@@ -0,0 +1,62 @@
+/*
+ * mx-velocity-tracker.h: Pointer velocity estimation
+ *
+ * Copyright 2012 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/*
+ * This is private to MX
+ */
+
+#ifndef _MX_VELOCITY_TRACKER_H
+#define _MX_VELOCITY_TRACKER_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define MX_VELOCITY_TRACKER_SIZE 16
+
+typedef struct
+{
+  gfloat x;
+  gfloat y;
+  gint64 time;
+} MxVelocitySample;
+
+typedef struct
+{
+  MxVelocitySample samples[MX_VELOCITY_TRACKER_SIZE];
+  guint            head;
+  guint            n_samples;
+} MxVelocityTracker;
+
+void     _mx_velocity_tracker_reset        (MxVelocityTracker *tracker);
+void     _mx_velocity_tracker_add          (MxVelocityTracker *tracker,
+                                            gfloat             x,
+                                            gfloat             y,
+                                            gint64             time);
+gboolean _mx_velocity_tracker_get_last     (MxVelocityTracker *tracker,
+                                            gfloat            *x,
+                                            gfloat            *y);
+gboolean _mx_velocity_tracker_get_velocity (MxVelocityTracker *tracker,
+                                            gfloat            *velocity_x,
+                                            gfloat            *velocity_y);
+
+G_END_DECLS
+
+#endif /* _MX_VELOCITY_TRACKER_H */
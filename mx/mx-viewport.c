@@ -231,6 +231,8 @@ mx_viewport_allocate (ClutterActor          *self,
   gfloat width, height;
   ClutterActorBox childbox;
 
+  _mx_scroll_stats_relayout (self);
+
   /* Chain up. */
   CLUTTER_ACTOR_CLASS (mx_viewport_parent_class)-> allocate (self, box, flags);
 
@@ -356,6 +358,8 @@ mx_viewport_get_preferred_width (ClutterActor *actor,
   MxViewportPrivate *priv = ((MxViewport *) actor)->priv;
   MxPadding padding;
 
+  _mx_scroll_stats_relayout (actor);
+
   mx_widget_get_padding (MX_WIDGET (actor), &padding);
 
   if (min_width)
@@ -388,6 +392,8 @@ mx_viewport_get_preferred_height (ClutterActor *actor,
   MxViewportPrivate *priv = ((MxViewport *) actor)->priv;
   MxPadding padding;
 
+  _mx_scroll_stats_relayout (actor);
+
   mx_widget_get_padding (MX_WIDGET (actor), &padding);
 
   if (min_height)
@@ -712,6 +718,8 @@ mx_viewport_set_origin (MxViewport *viewport,
 
   g_object_thaw_notify (G_OBJECT (viewport));
 
+  /* the origin is only applied as a transform */
+  _mx_scroll_stats_scrolled (CLUTTER_ACTOR (viewport));
   clutter_actor_queue_redraw (CLUTTER_ACTOR (viewport));
 }
 
@@ -44,6 +44,8 @@
 #include "mx-tooltip.h"
 #include "mx-enum-types.h"
 #include "mx-settings.h"
+#include "mx-paint-cache-effect.h"
+#include "mx-background-painter.h"
 
 #include "mx-private.h"
 
@@ -68,6 +70,9 @@ struct _MxWidgetPrivate
   ClutterColor   *bg_color;
   gfloat          opacity;
 
+  /* set when the background has rounded corners, a border or a gradient */
+  MxBackgroundPainter *background;
+
   guint         is_disabled : 1;
   guint         parent_disabled : 1;
 
@@ -79,6 +84,12 @@ struct _MxWidgetPrivate
   guint         tooltip_timeout;
   guint         tooltip_delay;
 
+  ClutterEffect *paint_cache;
+  guint          cached_paint : 1;
+
+  /* x-mx-cached-paint set by css (-1 means not set) */
+  gint           css_cached_paint;
+
   guint         in_dispose;
 
   GHashTable   *sequences;
@@ -115,7 +126,10 @@ struct _MxWidgetPrivate
  *
  * - background-color
  * - background-image
+ * - border-color
  * - border-image
+ * - border-radius
+ * - border-width
  * - color
  * - display
  * - font-family
@@ -129,6 +143,7 @@ struct _MxWidgetPrivate
  * - text-shadow
  * - visibility
  * - width
+ * - -mx-background-gradient
  *
  * Actors in the Mx library should subclass #MxWidget if they plan
  * to obey to a certain #MxStyle.
@@ -149,6 +164,8 @@ enum
 
   PROP_TOOLTIP_DELAY,
 
+  PROP_CACHED_PAINT,
+
   LAST_PROP
 };
 
@@ -218,6 +235,10 @@ mx_widget_set_property (GObject      *gobject,
       mx_widget_set_tooltip_delay (actor, g_value_get_int (value));
       break;
 
+    case PROP_CACHED_PAINT:
+      mx_widget_set_cached_paint (actor, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -263,6 +284,10 @@ mx_widget_get_property (GObject    *gobject,
       g_value_set_int (value, mx_widget_get_tooltip_delay (actor));
       break;
 
+    case PROP_CACHED_PAINT:
+      g_value_set_boolean (value, mx_widget_get_cached_paint (actor));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -324,6 +349,7 @@ mx_widget_dispose (GObject *gobject)
 
   if (priv->border_image)
     {
+      _mx_texture_frame_release_material (priv->border_image);
       cogl_handle_unref (priv->border_image);
       priv->border_image = NULL;
     }
@@ -336,6 +362,7 @@ mx_widget_dispose (GObject *gobject)
 
   if (priv->background_image)
     {
+      _mx_texture_frame_release_material (priv->background_image);
       cogl_handle_unref (priv->background_image);
       priv->background_image = NULL;
     }
@@ -387,6 +414,12 @@ mx_widget_finalize (GObject *gobject)
 
   clutter_color_free (priv->bg_color);
 
+  if (priv->background)
+    {
+      _mx_background_painter_free (priv->background);
+      priv->background = NULL;
+    }
+
   G_OBJECT_CLASS (mx_widget_parent_class)->finalize (gobject);
 }
 
@@ -509,7 +542,9 @@ mx_widget_paint (ClutterActor *actor)
   height = allocation.y2 - allocation.y1;
 
   /* paint the background color first */
-  if (priv->bg_color && priv->bg_color->alpha != 0)
+  if (priv->background)
+    _mx_background_painter_paint (priv->background, width, height, alpha);
+  else if (priv->bg_color && priv->bg_color->alpha != 0)
     {
       guint tmp_alpha = alpha * priv->bg_color->alpha / 255;
 
@@ -556,6 +591,34 @@ mx_widget_pick (ClutterActor *self, const ClutterColor *color)
 
 }
 
+static void
+mx_widget_update_paint_cache (MxWidget *widget)
+{
+  MxWidgetPrivate *priv = widget->priv;
+  gboolean cached;
+
+  if (priv->css_cached_paint != -1)
+    cached = priv->css_cached_paint;
+  else
+    cached = priv->cached_paint;
+
+  if ((priv->paint_cache != NULL) == cached)
+    return;
+
+  if (cached)
+    {
+      priv->paint_cache = _mx_paint_cache_effect_new ();
+      clutter_actor_add_effect_with_name (CLUTTER_ACTOR (widget),
+                                          "mx-paint-cache",
+                                          priv->paint_cache);
+    }
+  else
+    {
+      clutter_actor_remove_effect (CLUTTER_ACTOR (widget), priv->paint_cache);
+      priv->paint_cache = NULL;
+    }
+}
+
 static void
 mx_widget_style_changed (MxStylable *self, MxStyleChangedFlags flags)
 {
@@ -567,10 +630,13 @@ mx_widget_style_changed (MxStylable *self, MxStyleChangedFlags flags)
   MxPadding *margin = NULL;
   gboolean relayout_needed = FALSE;
   gboolean has_changed = FALSE;
-  ClutterColor *color;
+  ClutterColor *color, *border_color = NULL;
+  gchar *gradient = NULL;
+  gfloat border_radius = 0, border_width = 0;
   gfloat opacity = -1;
   gboolean border_image_changed = FALSE, background_image_changed = FALSE;
   gfloat width = -1, height = -1;
+  gchar *cached_paint = NULL;
   MxDisplayStyle display;
   MxVisibilityStyle visibility;
 
@@ -578,7 +644,11 @@ mx_widget_style_changed (MxStylable *self, MxStyleChangedFlags flags)
   mx_stylable_get (self,
                    "background-color", &color,
                    "background-image", &background_image,
+                   "x-mx-background-gradient", &gradient,
                    "border-image", &border_image,
+                   "border-color", &border_color,
+                   "border-radius", &border_radius,
+                   "border-width", &border_width,
                    "padding", &padding,
                    "opacity", &opacity,
                    "margin", &margin,
@@ -586,6 +656,7 @@ mx_widget_style_changed (MxStylable *self, MxStyleChangedFlags flags)
                    "height", &height,
                    "display", &display,
                    "visibility", &visibility,
+                   "x-mx-cached-paint", &cached_paint,
                    NULL);
 
   if (color)
@@ -610,6 +681,32 @@ mx_widget_style_changed (MxStylable *self, MxStyleChangedFlags flags)
       has_changed = TRUE;
     }
 
+  /* rounded corners, borders and gradients are painted by a shader, plain
+   * colours are left to the rectangle batching in the paint function */
+  if (border_radius > 0 || border_width > 0 || gradient)
+    {
+      if (!priv->background)
+        priv->background = _mx_background_painter_new ();
+
+      if (_mx_background_painter_set_style (priv->background,
+                                            priv->bg_color,
+                                            gradient,
+                                            border_radius,
+                                            border_width,
+                                            border_color))
+        has_changed = TRUE;
+    }
+  else if (priv->background)
+    {
+      _mx_background_painter_free (priv->background);
+      priv->background = NULL;
+      has_changed = TRUE;
+    }
+
+  g_free (gradient);
+  if (border_color)
+    clutter_color_free (border_color);
+
   if ((opacity >= 0) && (priv->opacity != opacity))
     {
       priv->opacity = opacity;
@@ -683,6 +780,18 @@ mx_widget_style_changed (MxStylable *self, MxStyleChangedFlags flags)
   priv->css_width = width;
 
 
+  /* paint caching hint, overrides mx_widget_set_cached_paint() while set */
+  if (g_strcmp0 (cached_paint, "true") == 0)
+    priv->css_cached_paint = TRUE;
+  else if (g_strcmp0 (cached_paint, "false") == 0)
+    priv->css_cached_paint = FALSE;
+  else
+    priv->css_cached_paint = -1;
+  g_free (cached_paint);
+
+  mx_widget_update_paint_cache (MX_WIDGET (self));
+
+
   /* padding */
   if (padding)
     {
@@ -726,6 +835,7 @@ mx_widget_style_changed (MxStylable *self, MxStyleChangedFlags flags)
   /* remove the old border-image if it has changed */
   if (border_image_changed && priv->border_image)
     {
+      _mx_texture_frame_release_material (priv->border_image);
       cogl_handle_unref (priv->border_image);
 
       priv->border_image = NULL;
@@ -767,6 +877,7 @@ mx_widget_style_changed (MxStylable *self, MxStyleChangedFlags flags)
   /* remove the old background-image if it has changed */
   if (background_image_changed && priv->background_image)
     {
+      _mx_texture_frame_release_material (priv->background_image);
       cogl_handle_unref (priv->background_image);
 
       priv->background_image = NULL;
@@ -1258,6 +1369,24 @@ mx_widget_class_init (MxWidgetClass *klass)
   g_object_class_install_property (gobject_class, PROP_TOOLTIP_DELAY,
                                    widget_properties[PROP_TOOLTIP_DELAY]);
 
+  /**
+   * MxWidget:cached-paint:
+   *
+   * Whether the widget and its children should be rendered into a texture
+   * that is reused until something inside the widget queues a redraw.
+   *
+   * Since: 2.0
+   */
+  widget_properties[PROP_CACHED_PAINT] =
+    g_param_spec_boolean ("cached-paint",
+                          "Cached paint",
+                          "Whether to retain the painting of the widget"
+                          " in a texture between frames",
+                          FALSE,
+                          MX_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_CACHED_PAINT,
+                                   widget_properties[PROP_CACHED_PAINT]);
+
   /**
    * MxWidget::long-press:
    * @widget: the object that received the signal
@@ -1371,6 +1500,36 @@ mx_stylable_iface_init (MxStylableIface *iface)
                                         G_PARAM_READWRITE);
       mx_stylable_iface_install_property (iface, MX_TYPE_WIDGET, pspec);
 
+      pspec = g_param_spec_string ("x-mx-background-gradient",
+                                   "Background Gradient",
+                                   "Linear gradient used to fill the "
+                                   "background of an actor",
+                                   NULL,
+                                   G_PARAM_READWRITE);
+      mx_stylable_iface_install_property (iface, MX_TYPE_WIDGET, pspec);
+
+      pspec = clutter_param_spec_color ("border-color",
+                                        "Border Color",
+                                        "The color of the border of an actor",
+                                        &bg_color,
+                                        G_PARAM_READWRITE);
+      mx_stylable_iface_install_property (iface, MX_TYPE_WIDGET, pspec);
+
+      pspec = g_param_spec_float ("border-radius",
+                                  "Border Radius",
+                                  "Radius of the corners of the background "
+                                  "of an actor",
+                                  0.0, G_MAXFLOAT, 0.0,
+                                  G_PARAM_READWRITE);
+      mx_stylable_iface_install_property (iface, MX_TYPE_WIDGET, pspec);
+
+      pspec = g_param_spec_float ("border-width",
+                                  "Border Width",
+                                  "Width of the border of an actor",
+                                  0.0, G_MAXFLOAT, 0.0,
+                                  G_PARAM_READWRITE);
+      mx_stylable_iface_install_property (iface, MX_TYPE_WIDGET, pspec);
+
       pspec = clutter_param_spec_color ("color",
                                         "Text Color",
                                         "The color of the text of an actor",
@@ -1482,6 +1641,14 @@ mx_stylable_iface_init (MxStylableIface *iface)
                                  G_PARAM_READWRITE);
       mx_stylable_iface_install_property (iface, MX_TYPE_WIDGET, pspec);
 
+      pspec = g_param_spec_string ("x-mx-cached-paint",
+                                   "Cached Paint",
+                                   "Whether to cache the painting of an "
+                                   "actor (\"true\" or \"false\")",
+                                   NULL,
+                                   G_PARAM_READWRITE);
+      mx_stylable_iface_install_property (iface, MX_TYPE_WIDGET, pspec);
+
       /*
       pspec = g_param_spec_uint ("x-mx-transition-duration",
                                  "transition duration",
@@ -1517,6 +1684,7 @@ mx_widget_init (MxWidget *actor)
 
   actor->priv->css_width = -1;
   actor->priv->css_height = -1;
+  actor->priv->css_cached_paint = -1;
 
   actor->priv->old_opacity = -1;
   actor->priv->old_visible = -1;
@@ -1916,6 +2084,63 @@ mx_widget_get_tooltip_delay (MxWidget *widget)
   return widget->priv->tooltip_delay;
 }
 
+/**
+ * mx_widget_set_cached_paint:
+ * @widget: an #MxWidget
+ * @cached: %TRUE to cache the painting of @widget
+ *
+ * Sets whether @widget, including all of its children, is rendered into a
+ * texture that is painted again on the following frames for as long as
+ * nothing inside @widget queues a redraw. This is useful for complex
+ * subtrees that rarely change, such as a page of a panel that is being
+ * moved or faded as a whole.
+ *
+ * The texture memory used by cached widgets is bounded; when the budget is
+ * exhausted, widgets are painted normally.
+ *
+ * Styles can override this setting with the x-mx-cached-paint property,
+ * set to "true" or "false".
+ *
+ * Since: 2.0
+ */
+void
+mx_widget_set_cached_paint (MxWidget *widget,
+                            gboolean  cached)
+{
+  MxWidgetPrivate *priv;
+
+  g_return_if_fail (MX_IS_WIDGET (widget));
+
+  priv = widget->priv;
+
+  if (priv->cached_paint == cached)
+    return;
+
+  priv->cached_paint = cached;
+  mx_widget_update_paint_cache (widget);
+
+  g_object_notify_by_pspec (G_OBJECT (widget),
+                            widget_properties[PROP_CACHED_PAINT]);
+}
+
+/**
+ * mx_widget_get_cached_paint:
+ * @widget: an #MxWidget
+ *
+ * Get the value of the "cached-paint" property.
+ *
+ * Returns: %TRUE if the painting of @widget is cached
+ *
+ * Since: 2.0
+ */
+gboolean
+mx_widget_get_cached_paint (MxWidget *widget)
+{
+  g_return_val_if_fail (MX_IS_WIDGET (widget), FALSE);
+
+  return widget->priv->cached_paint;
+}
+
 /* Support translateable strings from JSON */
 static void
 widget_scriptable_set_custom_property (ClutterScriptable *scriptable,
@@ -122,6 +122,10 @@ void mx_widget_long_press_cancel (MxWidget           *widget);
 void   mx_widget_set_tooltip_delay (MxWidget *widget, guint delay);
 guint  mx_widget_get_tooltip_delay (MxWidget *widget);
 
+void     mx_widget_set_cached_paint (MxWidget *widget,
+                                     gboolean  cached);
+gboolean mx_widget_get_cached_paint (MxWidget *widget);
+
 /* Only to be used by sub-classes of MxWidget */
 ClutterColor *mx_widget_get_background_color (MxWidget  *actor);
 CoglHandle    mx_widget_get_background_texture (MxWidget *actor);
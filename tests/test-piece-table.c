@@ -0,0 +1,190 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright 2012 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/* Edits the piece table that holds the text of entries in large-text mode.
+ * Offsets are in bytes. */
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "mx/mx-piece-table.h"
+
+static void
+assert_text (MxPieceTable *table,
+             const gchar  *expected)
+{
+  GString *text = g_string_new (NULL);
+
+  _mx_piece_table_get_text (table, 0, G_MAXSIZE, text);
+  g_assert_cmpstr (text->str, ==, expected);
+  g_assert_cmpuint (_mx_piece_table_get_length (table), ==, strlen (expected));
+
+  g_string_free (text, TRUE);
+}
+
+static void
+test_split (void)
+{
+  MxPieceTable *table = _mx_piece_table_new ("hello world", -1);
+  GString *text;
+
+  /* inserting at the ends of the text doesn't split anything */
+  _mx_piece_table_insert (table, 0, "<", -1);
+  _mx_piece_table_insert (table, 12, ">", -1);
+  assert_text (table, "<hello world>");
+  g_assert_cmpuint (_mx_piece_table_get_n_pieces (table), ==, 3);
+
+  /* in the middle of a piece, it's split in two */
+  _mx_piece_table_insert (table, 6, ",", -1);
+  assert_text (table, "<hello, world>");
+  g_assert_cmpuint (_mx_piece_table_get_n_pieces (table), ==, 5);
+
+  /* on a boundary between pieces, nothing is split */
+  _mx_piece_table_insert (table, 1, "[", -1);
+  _mx_piece_table_insert (table, 7, "]", -1);
+  assert_text (table, "<[hello], world>");
+  g_assert_cmpuint (_mx_piece_table_get_n_pieces (table), ==, 7);
+
+  /* ranges that start and end inside of pieces */
+  text = g_string_new (NULL);
+  _mx_piece_table_get_text (table, 3, 11, text);
+  g_assert_cmpstr (text->str, ==, "ello], w");
+  g_string_free (text, TRUE);
+
+  _mx_piece_table_free (table);
+}
+
+static void
+test_delete (void)
+{
+  MxPieceTable *table = _mx_piece_table_new ("one three", -1);
+
+  _mx_piece_table_insert (table, 4, "two ", -1);
+  assert_text (table, "one two three");
+  g_assert_cmpuint (_mx_piece_table_get_n_pieces (table), ==, 3);
+
+  /* from the middle of the first piece to the middle of the last one */
+  _mx_piece_table_delete (table, 2, 7);
+  assert_text (table, "onhree");
+  g_assert_cmpuint (_mx_piece_table_get_n_pieces (table), ==, 2);
+
+  /* exactly one piece */
+  _mx_piece_table_delete (table, 0, 2);
+  assert_text (table, "hree");
+  g_assert_cmpuint (_mx_piece_table_get_n_pieces (table), ==, 1);
+
+  /* past the end of the text */
+  _mx_piece_table_delete (table, 1, 100);
+  assert_text (table, "h");
+
+  _mx_piece_table_delete (table, 0, 1);
+  assert_text (table, "");
+  g_assert_cmpuint (_mx_piece_table_get_n_pieces (table), ==, 0);
+
+  _mx_piece_table_free (table);
+}
+
+static void
+test_coalesce (void)
+{
+  MxPieceTable *table = _mx_piece_table_new ("ab", -1);
+
+  /* typing adds to the same piece */
+  _mx_piece_table_insert (table, 1, "x", -1);
+  _mx_piece_table_insert (table, 2, "y", -1);
+  _mx_piece_table_insert (table, 3, "z", -1);
+  assert_text (table, "axyzb");
+  g_assert_cmpuint (_mx_piece_table_get_n_pieces (table), ==, 3);
+
+  /* the next insertion elsewhere needs a piece of its own */
+  _mx_piece_table_insert (table, 0, "w", -1);
+  assert_text (table, "waxyzb");
+  g_assert_cmpuint (_mx_piece_table_get_n_pieces (table), ==, 4);
+
+  /* going back to where the last one ended still appends to it */
+  _mx_piece_table_insert (table, 1, "v", -1);
+  assert_text (table, "wvaxyzb");
+  g_assert_cmpuint (_mx_piece_table_get_n_pieces (table), ==, 4);
+
+  /* but not to the text added before it */
+  _mx_piece_table_insert (table, 5, "!", -1);
+  assert_text (table, "wvaxy!zb");
+  g_assert_cmpuint (_mx_piece_table_get_n_pieces (table), ==, 6);
+
+  _mx_piece_table_free (table);
+}
+
+static void
+test_align (void)
+{
+  /* characters of 1, 2, 3 and 4 bytes */
+  MxPieceTable *table = _mx_piece_table_new ("a\xc3\xa9\xe2\x82\xac", -1);
+  static const gsize expected[] = { 0, 1, 1, 3, 3, 3, 6, 6, 6, 6, 10 };
+  gsize i;
+
+  _mx_piece_table_insert (table, 6, "\xf0\x9f\x98\x80", -1);
+  g_assert_cmpuint (_mx_piece_table_get_length (table), ==, 10);
+
+  for (i = 0; i < G_N_ELEMENTS (expected); i++)
+    g_assert_cmpuint (_mx_piece_table_align (table, i), ==, expected[i]);
+
+  g_assert_cmpuint (_mx_piece_table_align (table, 100), ==, 10);
+
+  /* the characters on either side of a split stay whole */
+  _mx_piece_table_insert (table, 3, "\xc3\xa9", -1);
+  g_assert_cmpuint (_mx_piece_table_align (table, 4), ==, 3);
+  g_assert_cmpuint (_mx_piece_table_align (table, 6), ==, 5);
+  g_assert_cmpuint (_mx_piece_table_align (table, 7), ==, 5);
+
+  _mx_piece_table_free (table);
+}
+
+static void
+test_skip_chars (void)
+{
+  MxPieceTable *table = _mx_piece_table_new ("a\xe2\x82\xac", -1);
+
+  /* a piece of added text in the middle */
+  _mx_piece_table_insert (table, 1, "\xc3\xa9" "b", -1);
+  assert_text (table, "a\xc3\xa9" "b\xe2\x82\xac");
+
+  g_assert_cmpuint (_mx_piece_table_skip_chars (table, 0, 0), ==, 0);
+  g_assert_cmpuint (_mx_piece_table_skip_chars (table, 0, 1), ==, 1);
+  g_assert_cmpuint (_mx_piece_table_skip_chars (table, 0, 2), ==, 3);
+  g_assert_cmpuint (_mx_piece_table_skip_chars (table, 1, 2), ==, 4);
+  g_assert_cmpuint (_mx_piece_table_skip_chars (table, 3, 2), ==, 7);
+  g_assert_cmpuint (_mx_piece_table_skip_chars (table, 0, 10), ==, 7);
+
+  _mx_piece_table_free (table);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/piece-table/split", test_split);
+  g_test_add_func ("/piece-table/delete", test_delete);
+  g_test_add_func ("/piece-table/coalesce", test_coalesce);
+  g_test_add_func ("/piece-table/align", test_align);
+  g_test_add_func ("/piece-table/skip-chars", test_skip_chars);
+
+  return g_test_run ();
+}
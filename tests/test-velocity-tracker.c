@@ -0,0 +1,188 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright 2012 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/* Replays recorded pointer traces through the velocity tracker used for
+ * kinetic scrolling. Times are in microseconds, velocities in pixels per
+ * second. */
+
+#include <math.h>
+
+#include <glib.h>
+
+#include "mx/mx-velocity-tracker.h"
+
+typedef struct
+{
+  gfloat x;
+  gfloat y;
+  gint64 time;
+} TraceEvent;
+
+/* A steady drag at 1000px/s down and 500px/s left, at 125Hz */
+static const TraceEvent steady_trace[] = {
+  { 300, 100,      0 },
+  { 296, 108,   8000 },
+  { 292, 116,  16000 },
+  { 288, 124,  24000 },
+  { 284, 132,  32000 },
+  { 280, 140,  40000 },
+  { 276, 148,  48000 },
+  { 272, 156,  56000 },
+  { 268, 164,  64000 },
+  { 264, 172,  72000 },
+  { 260, 180,  80000 },
+};
+
+/* The same drag with a single event reported 24px off its path, just
+ * before the release */
+static const TraceEvent outlier_trace[] = {
+  { 300, 100,      0 },
+  { 296, 108,   8000 },
+  { 292, 116,  16000 },
+  { 288, 124,  24000 },
+  { 284, 132,  32000 },
+  { 280, 140,  40000 },
+  { 276, 148,  48000 },
+  { 272, 156,  56000 },
+  { 268, 164,  64000 },
+  { 264, 196,  72000 },
+  { 260, 180,  80000 },
+};
+
+/* A fast flick that stops, then a slow drag a while later */
+static const TraceEvent paused_trace[] = {
+  {   0,   0,      0 },
+  {   0,  40,   8000 },
+  {   0,  80,  16000 },
+  {   0, 120,  24000 },
+  {   0, 120, 224000 },
+  {   0, 121, 232000 },
+  {   0, 122, 240000 },
+  {   0, 123, 248000 },
+};
+
+static void
+replay (MxVelocityTracker *tracker,
+        const TraceEvent  *trace,
+        guint              n_events)
+{
+  guint i;
+
+  _mx_velocity_tracker_reset (tracker);
+
+  for (i = 0; i < n_events; i++)
+    _mx_velocity_tracker_add (tracker, trace[i].x, trace[i].y, trace[i].time);
+}
+
+static void
+test_steady (void)
+{
+  MxVelocityTracker tracker;
+  gfloat vx, vy, x, y;
+
+  replay (&tracker, steady_trace, G_N_ELEMENTS (steady_trace));
+
+  g_assert (_mx_velocity_tracker_get_last (&tracker, &x, &y));
+  g_assert_cmpfloat (x, ==, 260);
+  g_assert_cmpfloat (y, ==, 180);
+
+  g_assert (_mx_velocity_tracker_get_velocity (&tracker, &vx, &vy));
+  g_assert_cmpfloat (fabs (vx + 500), <, 1);
+  g_assert_cmpfloat (fabs (vy - 1000), <, 1);
+}
+
+static void
+test_outlier (void)
+{
+  MxVelocityTracker tracker;
+  gfloat vx, vy;
+
+  replay (&tracker, outlier_trace, G_N_ELEMENTS (outlier_trace));
+
+  /* The slope between the last two events would be -2000px/s; the fit
+   * must stay close to the real velocity */
+  g_assert (_mx_velocity_tracker_get_velocity (&tracker, &vx, &vy));
+  g_assert_cmpfloat (fabs (vx + 500), <, 1);
+  g_assert_cmpfloat (fabs (vy - 1000), <, 150);
+}
+
+static void
+test_paused (void)
+{
+  MxVelocityTracker tracker;
+  gfloat vx, vy;
+
+  /* Only the events of the slow drag are recent enough to be used */
+  replay (&tracker, paused_trace, G_N_ELEMENTS (paused_trace));
+
+  g_assert (_mx_velocity_tracker_get_velocity (&tracker, &vx, &vy));
+  g_assert_cmpfloat (fabs (vx), <, 1);
+  g_assert_cmpfloat (fabs (vy - 125), <, 1);
+}
+
+static void
+test_too_few (void)
+{
+  MxVelocityTracker tracker;
+  gfloat vx = 1, vy = 1;
+
+  _mx_velocity_tracker_reset (&tracker);
+  g_assert (!_mx_velocity_tracker_get_last (&tracker, NULL, NULL));
+  g_assert (!_mx_velocity_tracker_get_velocity (&tracker, &vx, &vy));
+
+  _mx_velocity_tracker_add (&tracker, 10, 10, 0);
+  g_assert (!_mx_velocity_tracker_get_velocity (&tracker, &vx, &vy));
+  g_assert_cmpfloat (vx, ==, 0);
+  g_assert_cmpfloat (vy, ==, 0);
+
+  /* The previous event is too old to be used */
+  _mx_velocity_tracker_add (&tracker, 20, 20, 500000);
+  g_assert (!_mx_velocity_tracker_get_velocity (&tracker, &vx, &vy));
+}
+
+static void
+test_wrap (void)
+{
+  MxVelocityTracker tracker;
+  gfloat vx, vy;
+  guint i;
+
+  /* More events than the tracker holds, at 2000px/s */
+  _mx_velocity_tracker_reset (&tracker);
+  for (i = 0; i < MX_VELOCITY_TRACKER_SIZE * 3; i++)
+    _mx_velocity_tracker_add (&tracker, i * 8, 0, i * 4000);
+
+  g_assert (_mx_velocity_tracker_get_velocity (&tracker, &vx, &vy));
+  g_assert_cmpfloat (fabs (vx - 2000), <, 1);
+  g_assert_cmpfloat (fabs (vy), <, 1);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/velocity-tracker/steady", test_steady);
+  g_test_add_func ("/velocity-tracker/outlier", test_outlier);
+  g_test_add_func ("/velocity-tracker/paused", test_paused);
+  g_test_add_func ("/velocity-tracker/too-few", test_too_few);
+  g_test_add_func ("/velocity-tracker/wrap", test_wrap);
+
+  return g_test_run ();
+}